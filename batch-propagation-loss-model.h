@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef BATCH_PROPAGATION_LOSS_MODEL_H
+#define BATCH_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *            Batch Propagation Loss Model
+ ********************************************************/
+
+/**
+ * Base class for propagation loss models that can evaluate a whole row of
+ * the loss matrix in one call. Receivers are registered once and addressed by
+ * a dense index, so that the receive powers of all the nodes for a
+ * transmission can be filled in a contiguous array in one CalcRxPowerRow call.
+ *
+ * CalcRxPowerRow is a benchmark-only API, used by evaluate_block_matrix_loss:
+ * the YANS and DMG channels live in the wifi module and still call CalcRxPower
+ * once per receiver. Since they do so for every receiver of the
+ * same transmitter in a row, the index of the last transmitter is cached and a
+ * pairwise lookup costs a single hash lookup for the receiver.
+ */
+class BatchPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  BatchPropagationLossModel ();
+  virtual ~BatchPropagationLossModel ();
+
+  /**
+   * Register a node with the model. Registering the same mobility model twice
+   * returns the index assigned the first time.
+   * \param mobility The mobility model of the node.
+   * \return The dense index of the node inside the model.
+   */
+  uint32_t AddReceiver (Ptr<MobilityModel> mobility);
+  /**
+   * \return The number of registered nodes, i.e. the length of a loss row.
+   */
+  uint32_t GetNReceivers (void) const;
+  /**
+   * \param index The dense index of a registered node.
+   * \return The mobility model registered at this index.
+   */
+  Ptr<MobilityModel> GetReceiver (uint32_t index) const;
+  /**
+   * Look up the dense index of a node.
+   * \param mobility The mobility model of the node.
+   * \param index The dense index of the node if found.
+   * \return True if the node has been registered with the model.
+   */
+  bool GetReceiverIndex (Ptr<MobilityModel> mobility, uint32_t &index) const;
+  /**
+   * Same as GetReceiverIndex, but remembers the last node found. To be used
+   * for the transmitter in DoCalcRxPower.
+   * \param mobility The mobility model of the transmitter.
+   * \param index The dense index of the node if found.
+   * \return True if the node has been registered with the model.
+   */
+  bool GetTransmitterIndex (Ptr<MobilityModel> mobility, uint32_t &index) const;
+  /**
+   * Compute the receive power of every registered node for a transmission
+   * from the given node. Entry i of the output array corresponds to
+   * GetReceiver (i); the entry of the transmitter itself is filled as well
+   * and should be skipped by the caller. Models chained through SetNext are
+   * applied on top of the batch result.
+   * \param tx The mobility model of the transmitter.
+   * \param txPowerDbm The transmit power in dBm.
+   * \param rxPowersDbm Output array holding at least GetNReceivers () entries.
+   */
+  void CalcRxPowerRow (Ptr<MobilityModel> tx, double txPowerDbm, double *rxPowersDbm);
+  /**
+   * Same as above, but resizes the output vector to GetNReceivers ().
+   */
+  void CalcRxPowerRow (Ptr<MobilityModel> tx, double txPowerDbm, std::vector<double> &rxPowersDbm);
+
+protected:
+  /* Redeclared here so that the batch path can fall back to pairwise evaluation */
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const = 0;
+  /**
+   * Fill a loss row for a registered transmitter.
+   * \param txIndex The dense index of the transmitter.
+   * \param txPowerDbm The transmit power in dBm.
+   * \param rxPowersDbm Output array holding at least GetNReceivers () entries.
+   */
+  virtual void DoCalcRxPowerRow (uint32_t txIndex, double txPowerDbm, double *rxPowersDbm) const = 0;
+  /**
+   * Notify subclasses that a new node has been registered so they can grow
+   * their storage.
+   * \param index The dense index assigned to the new node.
+   */
+  virtual void DoAddReceiver (uint32_t index);
+
+private:
+  typedef std::unordered_map<const MobilityModel *, uint32_t> ReceiverIndexMap;
+
+  std::vector<Ptr<MobilityModel> > m_receivers;   //!< Registered nodes ordered by their dense index.
+  ReceiverIndexMap m_receiverIndex;               //!< Map a mobility model to its dense index.
+  mutable const MobilityModel *m_lastTx;          //!< Last transmitter looked up.
+  mutable uint32_t m_lastTxIndex;                 //!< Dense index of the last transmitter looked up.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BatchPropagationLossModel);
+
+TypeId
+BatchPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BatchPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Propagation")
+  ;
+  return tid;
+}
+
+BatchPropagationLossModel::BatchPropagationLossModel ()
+  : m_lastTx (0),
+    m_lastTxIndex (0)
+{
+}
+
+BatchPropagationLossModel::~BatchPropagationLossModel ()
+{
+}
+
+uint32_t
+BatchPropagationLossModel::AddReceiver (Ptr<MobilityModel> mobility)
+{
+  NS_ASSERT (mobility != 0);
+  ReceiverIndexMap::const_iterator it = m_receiverIndex.find (PeekPointer (mobility));
+  if (it != m_receiverIndex.end ())
+    {
+      return it->second;
+    }
+  uint32_t index = m_receivers.size ();
+  m_receivers.push_back (mobility);
+  m_receiverIndex[PeekPointer (mobility)] = index;
+  DoAddReceiver (index);
+  return index;
+}
+
+uint32_t
+BatchPropagationLossModel::GetNReceivers (void) const
+{
+  return m_receivers.size ();
+}
+
+Ptr<MobilityModel>
+BatchPropagationLossModel::GetReceiver (uint32_t index) const
+{
+  NS_ASSERT (index < m_receivers.size ());
+  return m_receivers[index];
+}
+
+bool
+BatchPropagationLossModel::GetReceiverIndex (Ptr<MobilityModel> mobility, uint32_t &index) const
+{
+  ReceiverIndexMap::const_iterator it = m_receiverIndex.find (PeekPointer (mobility));
+  if (it == m_receiverIndex.end ())
+    {
+      return false;
+    }
+  index = it->second;
+  return true;
+}
+
+bool
+BatchPropagationLossModel::GetTransmitterIndex (Ptr<MobilityModel> mobility, uint32_t &index) const
+{
+  /* The registered models are held by m_receivers, so the cached pointer cannot be reused */
+  if (PeekPointer (mobility) == m_lastTx)
+    {
+      index = m_lastTxIndex;
+      return true;
+    }
+  if (!GetReceiverIndex (mobility, index))
+    {
+      return false;
+    }
+  m_lastTx = PeekPointer (mobility);
+  m_lastTxIndex = index;
+  return true;
+}
+
+void
+BatchPropagationLossModel::CalcRxPowerRow (Ptr<MobilityModel> tx, double txPowerDbm, double *rxPowersDbm)
+{
+  uint32_t txIndex;
+  if (GetTransmitterIndex (tx, txIndex))
+    {
+      DoCalcRxPowerRow (txIndex, txPowerDbm, rxPowersDbm);
+    }
+  else
+    {
+      /* Unknown transmitter: fall back to the pairwise path */
+      for (uint32_t i = 0; i < m_receivers.size (); i++)
+        {
+          rxPowersDbm[i] = DoCalcRxPower (txPowerDbm, tx, m_receivers[i]);
+        }
+    }
+  Ptr<PropagationLossModel> next = GetNext ();
+  if (next != 0)
+    {
+      for (uint32_t i = 0; i < m_receivers.size (); i++)
+        {
+          rxPowersDbm[i] = next->CalcRxPower (rxPowersDbm[i], tx, m_receivers[i]);
+        }
+    }
+}
+
+void
+BatchPropagationLossModel::CalcRxPowerRow (Ptr<MobilityModel> tx, double txPowerDbm, std::vector<double> &rxPowersDbm)
+{
+  rxPowersDbm.resize (m_receivers.size ());
+  if (!rxPowersDbm.empty ())
+    {
+      CalcRxPowerRow (tx, txPowerDbm, rxPowersDbm.data ());
+    }
+}
+
+void
+BatchPropagationLossModel::DoAddReceiver (uint32_t index)
+{
+}
+
+} // namespace ns3
+
+#endif // BATCH_PROPAGATION_LOSS_MODEL_H
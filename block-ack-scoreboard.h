@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef BLOCK_ACK_SCOREBOARD_H
+#define BLOCK_ACK_SCOREBOARD_H
+
+#include "ns3/abort.h"
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *             Bitmap BlockAck Scoreboard
+ ********************************************************/
+
+/**
+ * Scoreboard of a BlockAck agreement stored as a circular bitmap of 64-bit
+ * words. The bit of sequence number s lives at position s mod capacity, where
+ * the capacity is the window size rounded up to a power of two, so the base
+ * sequence number rotates over the words instead of shifting them. Window
+ * advance, gap detection and bitmap generation take O(window / 64) operations,
+ * which matters for EDMG agreements with windows of up to 1024 MPDUs.
+ *
+ * Invariant: the bits outside of the window are always zero.
+ */
+class BlockAckScoreboard
+{
+public:
+  static const uint16_t SEQNO_SPACE = 4096;     //!< Size of the sequence number space.
+
+  /**
+   * \param windowSize The size of the BlockAck window (1 to 2048 MPDUs).
+   * \param startingSequence The starting sequence number of the agreement.
+   */
+  BlockAckScoreboard (uint16_t windowSize = 64, uint16_t startingSequence = 0);
+
+  /**
+   * Clear the scoreboard and set the starting sequence number.
+   * \param startingSequence The new starting sequence number.
+   */
+  void Reset (uint16_t startingSequence);
+  /**
+   * \return The sequence number of the start of the window.
+   */
+  uint16_t GetWinStart (void) const;
+  /**
+   * \return The size of the window.
+   */
+  uint16_t GetWinSize (void) const;
+  /**
+   * \param seq The sequence number.
+   * \return True if the sequence number is within the window.
+   */
+  bool IsInWindow (uint16_t seq) const;
+  /**
+   * Record the reception (or the acknowledgment) of an MPDU. A sequence number
+   * ahead of the window moves the window so that it ends at this MPDU.
+   * \param seq The sequence number of the MPDU.
+   * \return False if the sequence number is older than the window.
+   */
+  bool Record (uint16_t seq);
+  /**
+   * \param seq The sequence number.
+   * \return True if the MPDU is within the window and has been recorded.
+   */
+  bool IsRecorded (uint16_t seq) const;
+  /**
+   * Move the start of the window forward, e.g. upon a BlockAckReq or when the
+   * originator discards MPDUs. The MPDUs left behind are forgotten.
+   * \param seq The new start of the window.
+   */
+  void AdvanceTo (uint16_t seq);
+  /**
+   * Move the start of the window past the MPDUs recorded in order, i.e. up to
+   * the first gap. This is the in-order release of the recipient.
+   * \return The number of MPDUs released.
+   */
+  uint16_t AdvanceOverRecorded (void);
+  /**
+   * Look for the first gap of the window.
+   * \param seq The sequence number of the first missing MPDU.
+   * \return False if all the MPDUs of the window have been recorded.
+   */
+  bool GetFirstMissing (uint16_t &seq) const;
+  /**
+   * \return The number of MPDUs recorded in the window.
+   */
+  uint16_t GetNRecorded (void) const;
+  /**
+   * \return True if an MPDU following a missing one has been recorded.
+   */
+  bool HasGaps (void) const;
+  /**
+   * Decide whether the originator has to send a BlockAckReq: this is the case
+   * when MPDUs are missing and the oldest one cannot be retransmitted anymore.
+   * \param oldestRetransmittable The oldest sequence number still buffered for retransmission.
+   * \return True if a BlockAckReq is needed to move the recipient window.
+   */
+  bool NeedBlockAckRequest (uint16_t oldestRetransmittable) const;
+  /**
+   * Copy the bitmap of the window (bit i for sequence number WinStart + i) as
+   * carried in a Compressed BlockAck frame.
+   * \param bitmap The output words, resized to ceil (window / 64).
+   */
+  void GetBitmap (std::vector<uint64_t> &bitmap) const;
+
+private:
+  uint16_t Distance (uint16_t from, uint16_t to) const;
+  /**
+   * Clear the bits of count sequence numbers starting from seq.
+   */
+  void ClearRange (uint16_t seq, uint16_t count);
+  /**
+   * Extract up to 64 bits starting from the circular bit position.
+   */
+  uint64_t ExtractWord (uint32_t position, uint32_t bits) const;
+
+  std::vector<uint64_t> m_bits;   //!< Circular bitmap.
+  uint32_t m_mask;                //!< Capacity - 1.
+  uint16_t m_winSize;             //!< Size of the window.
+  uint16_t m_winStart;            //!< Start of the window.
+
+};
+
+const uint16_t BlockAckScoreboard::SEQNO_SPACE;
+
+BlockAckScoreboard::BlockAckScoreboard (uint16_t windowSize, uint16_t startingSequence)
+  : m_winSize (windowSize)
+{
+  NS_ABORT_MSG_IF ((windowSize == 0) || (windowSize > SEQNO_SPACE / 2), "Invalid BlockAck window size " << windowSize);
+  uint32_t capacity = 64;
+  while (capacity < windowSize)
+    {
+      capacity *= 2;
+    }
+  m_mask = capacity - 1;
+  m_bits.assign (capacity / 64, 0);
+  Reset (startingSequence);
+}
+
+void
+BlockAckScoreboard::Reset (uint16_t startingSequence)
+{
+  std::fill (m_bits.begin (), m_bits.end (), 0);
+  m_winStart = startingSequence % SEQNO_SPACE;
+}
+
+uint16_t
+BlockAckScoreboard::GetWinStart (void) const
+{
+  return m_winStart;
+}
+
+uint16_t
+BlockAckScoreboard::GetWinSize (void) const
+{
+  return m_winSize;
+}
+
+uint16_t
+BlockAckScoreboard::Distance (uint16_t from, uint16_t to) const
+{
+  return (to - from) & (SEQNO_SPACE - 1);
+}
+
+bool
+BlockAckScoreboard::IsInWindow (uint16_t seq) const
+{
+  return Distance (m_winStart, seq) < m_winSize;
+}
+
+bool
+BlockAckScoreboard::Record (uint16_t seq)
+{
+  uint16_t distance = Distance (m_winStart, seq);
+  if (distance >= SEQNO_SPACE / 2)
+    {
+      /* Old MPDU */
+      return false;
+    }
+  if (distance >= m_winSize)
+    {
+      AdvanceTo ((seq + SEQNO_SPACE - m_winSize + 1) % SEQNO_SPACE);
+    }
+  uint32_t position = seq & m_mask;
+  m_bits[position / 64] |= (uint64_t (1) << (position % 64));
+  return true;
+}
+
+bool
+BlockAckScoreboard::IsRecorded (uint16_t seq) const
+{
+  uint32_t position = seq & m_mask;
+  return IsInWindow (seq) && ((m_bits[position / 64] >> (position % 64)) & 1);
+}
+
+void
+BlockAckScoreboard::ClearRange (uint16_t seq, uint16_t count)
+{
+  uint32_t position = seq & m_mask;
+  while (count > 0)
+    {
+      uint32_t offset = position % 64;
+      uint32_t bits = std::min<uint32_t> (64 - offset, count);
+      uint64_t mask = (bits == 64) ? ~uint64_t (0) : (((uint64_t (1) << bits) - 1) << offset);
+      m_bits[position / 64] &= ~mask;
+      count -= bits;
+      position = (position + bits) & m_mask;
+    }
+}
+
+void
+BlockAckScoreboard::AdvanceTo (uint16_t seq)
+{
+  seq %= SEQNO_SPACE;
+  uint16_t distance = Distance (m_winStart, seq);
+  if (distance >= SEQNO_SPACE / 2)
+    {
+      /* The window never moves backward */
+      return;
+    }
+  if (distance >= m_winSize)
+    {
+      std::fill (m_bits.begin (), m_bits.end (), 0);
+    }
+  else
+    {
+      ClearRange (m_winStart, distance);
+    }
+  m_winStart = seq;
+}
+
+uint16_t
+BlockAckScoreboard::AdvanceOverRecorded (void)
+{
+  uint16_t released = 0;
+  uint32_t position = m_winStart & m_mask;
+  while (released < m_winSize)
+    {
+      uint32_t offset = position % 64;
+      uint64_t word = m_bits[position / 64] >> offset;
+      /* Number of consecutive ones starting from the offset */
+      uint32_t ones = (~word == 0) ? 64 : __builtin_ctzll (~word);
+      ones = std::min<uint32_t> (ones, 64 - offset);
+      ones = std::min<uint32_t> (ones, m_winSize - released);
+      released += ones;
+      position = (position + ones) & m_mask;
+      if (ones < 64 - offset)
+        {
+          break;
+        }
+    }
+  ClearRange (m_winStart, released);
+  m_winStart = (m_winStart + released) % SEQNO_SPACE;
+  return released;
+}
+
+uint64_t
+BlockAckScoreboard::ExtractWord (uint32_t position, uint32_t bits) const
+{
+  uint32_t offset = position % 64;
+  uint64_t word = m_bits[position / 64] >> offset;
+  if ((offset != 0) && (bits > 64 - offset))
+    {
+      word |= m_bits[((position + 64 - offset) & m_mask) / 64] << (64 - offset);
+    }
+  if (bits < 64)
+    {
+      word &= (uint64_t (1) << bits) - 1;
+    }
+  return word;
+}
+
+bool
+BlockAckScoreboard::GetFirstMissing (uint16_t &seq) const
+{
+  for (uint32_t index = 0; index < m_winSize; index += 64)
+    {
+      uint32_t bits = std::min<uint32_t> (64, m_winSize - index);
+      uint64_t word = ExtractWord ((m_winStart + index) & m_mask, bits);
+      uint64_t full = (bits == 64) ? ~uint64_t (0) : ((uint64_t (1) << bits) - 1);
+      if (word != full)
+        {
+          seq = (m_winStart + index + __builtin_ctzll (~word)) % SEQNO_SPACE;
+          return true;
+        }
+    }
+  return false;
+}
+
+uint16_t
+BlockAckScoreboard::GetNRecorded (void) const
+{
+  uint32_t count = 0;
+  for (std::vector<uint64_t>::const_iterator it = m_bits.begin (); it != m_bits.end (); it++)
+    {
+      count += __builtin_popcountll (*it);
+    }
+  return count;
+}
+
+bool
+BlockAckScoreboard::HasGaps (void) const
+{
+  uint16_t missing;
+  if (!GetFirstMissing (missing))
+    {
+      return false;
+    }
+  /* A gap exists if any MPDU after the first missing one has been recorded */
+  uint16_t before = Distance (m_winStart, missing);
+  return GetNRecorded () > before;
+}
+
+bool
+BlockAckScoreboard::NeedBlockAckRequest (uint16_t oldestRetransmittable) const
+{
+  uint16_t missing;
+  if ((Distance (m_winStart, oldestRetransmittable) >= SEQNO_SPACE / 2) || !GetFirstMissing (missing))
+    {
+      return false;
+    }
+  return Distance (m_winStart, missing) < Distance (m_winStart, oldestRetransmittable);
+}
+
+void
+BlockAckScoreboard::GetBitmap (std::vector<uint64_t> &bitmap) const
+{
+  bitmap.resize ((m_winSize + 63) / 64);
+  for (uint32_t index = 0; index < m_winSize; index += 64)
+    {
+      bitmap[index / 64] = ExtractWord ((m_winStart + index) & m_mask, std::min<uint32_t> (64, m_winSize - index));
+    }
+}
+
+} // namespace ns3
+
+#endif // BLOCK_ACK_SCOREBOARD_H
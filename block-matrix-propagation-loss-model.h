@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef BLOCK_MATRIX_PROPAGATION_LOSS_MODEL_H
+#define BLOCK_MATRIX_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/double.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "batch-propagation-loss-model.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+
+/********************************************************
+ *          Block Matrix Propagation Loss Model
+ ********************************************************/
+
+/**
+ * Block-structured loss matrix for clustered deployments (e.g. rooms of a
+ * campus). Each node belongs to one cluster: the losses between nodes of the
+ * same cluster are stored in a dense per-cluster block, while the losses
+ * between two clusters are described by a single value per cluster pair plus
+ * an optional per-node offset (a rank-1 correction in the linear domain):
+ *
+ *   L(i,j) = Intra_c(i,j)                   if cluster(i) == cluster(j) == c
+ *   L(i,j) = Inter(ci,cj) + O(i) + O(j)     otherwise
+ *
+ * The memory footprint is O(sum (n_c^2) + C^2 + N) instead of O(N^2), and
+ * every lookup remains constant-time.
+ */
+class BlockMatrixPropagationLossModel : public BatchPropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  BlockMatrixPropagationLossModel ();
+  virtual ~BlockMatrixPropagationLossModel ();
+
+  /**
+   * Set the number of clusters. The inter-cluster losses already set are
+   * kept, those of the new clusters are set to the default loss.
+   * \param clusters The number of clusters.
+   */
+  void SetNClusters (uint32_t clusters);
+  /**
+   * \return The number of clusters.
+   */
+  uint32_t GetNClusters (void) const;
+  /**
+   * Assign a node to a cluster. A node can be assigned only once and must be
+   * assigned before any of its losses are set.
+   * \param mobility The mobility model of the node.
+   * \param cluster The cluster ID.
+   * \return The dense index of the node.
+   */
+  uint32_t SetCluster (Ptr<MobilityModel> mobility, uint32_t cluster);
+  /**
+   * Read the cluster membership from a file. Each line contains the ID of a
+   * node and the ID of its cluster separated by a space; empty lines and
+   * lines starting with '#' are ignored. The number of clusters is derived
+   * from the largest cluster ID.
+   * \param fileName The path to the membership file.
+   * \param nodes The nodes referred to by the file.
+   */
+  void LoadClusters (std::string fileName, NodeContainer nodes);
+  /**
+   * Set loss (in dB, positive) between two nodes of the same cluster.
+   * \param a Source mobility.
+   * \param b Destination mobility.
+   * \param loss Loss value in dB.
+   * \param symmetric If true (default), both a->b and b->a paths will be affected.
+   */
+  void SetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b, double loss, bool symmetric = true);
+  /**
+   * Set loss (in dB, positive) between two clusters.
+   * \param a Source cluster ID.
+   * \param b Destination cluster ID.
+   * \param loss Loss value in dB.
+   * \param symmetric If true (default), both a->b and b->a paths will be affected.
+   */
+  void SetClusterLoss (uint32_t a, uint32_t b, double loss, bool symmetric = true);
+  /**
+   * Set the per-node correction added to the inter-cluster losses of a node.
+   * \param mobility The mobility model of the node.
+   * \param offset The offset in dB.
+   */
+  void SetNodeOffset (Ptr<MobilityModel> mobility, double offset);
+  /**
+   * \param a The dense index of the source node.
+   * \param b The dense index of the destination node.
+   * \return The loss in dB between two registered nodes.
+   */
+  double GetLoss (uint32_t a, uint32_t b) const;
+  /**
+   * Set the default value of the loss, used for all the pairs that have not
+   * been set explicitly through SetLoss or SetClusterLoss.
+   * \param defaultLoss The default loss value in dB.
+   */
+  void SetDefaultLoss (double defaultLoss);
+  /**
+   * \return The number of loss entries stored by the model.
+   */
+  uint64_t GetNEntries (void) const;
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  virtual void DoCalcRxPowerRow (uint32_t txIndex, double txPowerDbm, double *rxPowersDbm) const;
+  virtual void DoAddReceiver (uint32_t index);
+
+  /**
+   * Dense loss block of a single cluster.
+   */
+  struct ClusterBlock {
+    std::vector<uint32_t> members;    //!< Dense indices of the nodes of the cluster.
+    uint32_t stride = 0;              //!< Allocated row length of the block.
+    std::vector<double> loss;         //!< Row-major intra-cluster losses in dB.
+    std::vector<bool> isExplicit;     //!< Flag entries set through SetLoss so that SetDefaultLoss does not override them.
+  };
+
+  static const uint32_t NO_CLUSTER = std::numeric_limits<uint32_t>::max ();
+
+  double m_defaultLoss;                   //!< Default loss in dB.
+  uint32_t m_clusters;                    //!< Number of clusters.
+  std::vector<double> m_interLoss;        //!< Row-major C x C inter-cluster losses in dB.
+  std::vector<bool> m_interExplicit;      //!< Flag inter-cluster losses set through SetClusterLoss.
+  std::vector<ClusterBlock> m_blocks;     //!< Intra-cluster blocks.
+  std::vector<uint32_t> m_cluster;        //!< Cluster ID of each node.
+  std::vector<uint32_t> m_localIndex;     //!< Index of each node inside its cluster block.
+  std::vector<double> m_offset;           //!< Inter-cluster correction of each node in dB.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BlockMatrixPropagationLossModel);
+
+const uint32_t BlockMatrixPropagationLossModel::NO_CLUSTER;
+
+TypeId
+BlockMatrixPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BlockMatrixPropagationLossModel")
+    .SetParent<BatchPropagationLossModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<BlockMatrixPropagationLossModel> ()
+    .AddAttribute ("DefaultLoss", "The default value for propagation loss, dB.",
+                   DoubleValue (std::numeric_limits<double>::max ()),
+                   MakeDoubleAccessor (&BlockMatrixPropagationLossModel::SetDefaultLoss),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+BlockMatrixPropagationLossModel::BlockMatrixPropagationLossModel ()
+  : m_defaultLoss (std::numeric_limits<double>::max ()),
+    m_clusters (0)
+{
+}
+
+BlockMatrixPropagationLossModel::~BlockMatrixPropagationLossModel ()
+{
+}
+
+void
+BlockMatrixPropagationLossModel::SetNClusters (uint32_t clusters)
+{
+  NS_ASSERT_MSG (clusters >= m_clusters, "Cannot remove clusters which are already in use");
+  std::vector<double> interLoss (clusters * clusters, m_defaultLoss);
+  std::vector<bool> interExplicit (clusters * clusters, false);
+  for (uint32_t a = 0; a < m_clusters; a++)
+    {
+      for (uint32_t b = 0; b < m_clusters; b++)
+        {
+          interLoss[a * clusters + b] = m_interLoss[a * m_clusters + b];
+          interExplicit[a * clusters + b] = m_interExplicit[a * m_clusters + b];
+        }
+    }
+  m_interLoss.swap (interLoss);
+  m_interExplicit.swap (interExplicit);
+  m_clusters = clusters;
+  m_blocks.resize (clusters);
+}
+
+uint32_t
+BlockMatrixPropagationLossModel::GetNClusters (void) const
+{
+  return m_clusters;
+}
+
+uint32_t
+BlockMatrixPropagationLossModel::SetCluster (Ptr<MobilityModel> mobility, uint32_t cluster)
+{
+  NS_ASSERT_MSG (cluster < m_clusters, "Cluster ID " << cluster << " exceeds the number of clusters");
+  uint32_t index = AddReceiver (mobility);
+  NS_ASSERT_MSG (m_cluster[index] == NO_CLUSTER, "Node has already been assigned to a cluster");
+
+  ClusterBlock &block = m_blocks[cluster];
+  uint32_t localIndex = block.members.size ();
+  block.members.push_back (index);
+  if (localIndex >= block.stride)
+    {
+      /* Grow the block geometrically */
+      uint32_t stride = std::max<uint32_t> (4, 2 * block.stride);
+      std::vector<double> loss (stride * stride, m_defaultLoss);
+      std::vector<bool> isExplicit (stride * stride, false);
+      for (uint32_t a = 0; a < block.stride; a++)
+        {
+          for (uint32_t b = 0; b < block.stride; b++)
+            {
+              loss[a * stride + b] = block.loss[a * block.stride + b];
+              isExplicit[a * stride + b] = block.isExplicit[a * block.stride + b];
+            }
+        }
+      block.loss.swap (loss);
+      block.isExplicit.swap (isExplicit);
+      block.stride = stride;
+    }
+  m_cluster[index] = cluster;
+  m_localIndex[index] = localIndex;
+  return index;
+}
+
+void
+BlockMatrixPropagationLossModel::LoadClusters (std::string fileName, NodeContainer nodes)
+{
+  std::ifstream file;
+  file.open (fileName.c_str (), std::ifstream::in);
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("Cluster membership file " << fileName << " not found");
+    }
+
+  std::vector<std::pair<uint32_t, uint32_t> > membership;
+  uint32_t clusters = m_clusters;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream iss (line);
+      uint32_t nodeId, cluster;
+      if (!(iss >> nodeId >> cluster))
+        {
+          NS_FATAL_ERROR ("Malformed line in cluster membership file: " << line);
+        }
+      membership.push_back (std::make_pair (nodeId, cluster));
+      clusters = std::max (clusters, cluster + 1);
+    }
+  file.close ();
+
+  if (clusters != m_clusters)
+    {
+      SetNClusters (clusters);
+    }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = membership.begin ();
+       it != membership.end (); it++)
+    {
+      Ptr<Node> node;
+      for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+        {
+          if ((*i)->GetId () == it->first)
+            {
+              node = *i;
+              break;
+            }
+        }
+      NS_ABORT_MSG_IF (node == 0, "Cannot find node " << it->first << " referred to in " << fileName);
+      Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+      NS_ABORT_MSG_IF (mobility == 0, "Node " << it->first << " has no mobility model");
+      SetCluster (mobility, it->second);
+    }
+}
+
+void
+BlockMatrixPropagationLossModel::SetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b, double loss, bool symmetric)
+{
+  uint32_t indexA, indexB;
+  NS_ABORT_MSG_IF (!GetReceiverIndex (a, indexA) || !GetReceiverIndex (b, indexB),
+                   "Nodes must be assigned to a cluster before setting their loss");
+  uint32_t cluster = m_cluster[indexA];
+  NS_ABORT_MSG_IF (cluster != m_cluster[indexB],
+                   "Per-node losses can only be set inside a cluster, use SetClusterLoss instead");
+  ClusterBlock &block = m_blocks[cluster];
+  block.loss[m_localIndex[indexA] * block.stride + m_localIndex[indexB]] = loss;
+  block.isExplicit[m_localIndex[indexA] * block.stride + m_localIndex[indexB]] = true;
+  if (symmetric)
+    {
+      block.loss[m_localIndex[indexB] * block.stride + m_localIndex[indexA]] = loss;
+      block.isExplicit[m_localIndex[indexB] * block.stride + m_localIndex[indexA]] = true;
+    }
+}
+
+void
+BlockMatrixPropagationLossModel::SetClusterLoss (uint32_t a, uint32_t b, double loss, bool symmetric)
+{
+  NS_ASSERT (a < m_clusters && b < m_clusters);
+  m_interLoss[a * m_clusters + b] = loss;
+  m_interExplicit[a * m_clusters + b] = true;
+  if (symmetric)
+    {
+      m_interLoss[b * m_clusters + a] = loss;
+      m_interExplicit[b * m_clusters + a] = true;
+    }
+}
+
+void
+BlockMatrixPropagationLossModel::SetNodeOffset (Ptr<MobilityModel> mobility, double offset)
+{
+  uint32_t index;
+  NS_ABORT_MSG_IF (!GetReceiverIndex (mobility, index), "Node must be assigned to a cluster first");
+  m_offset[index] = offset;
+}
+
+double
+BlockMatrixPropagationLossModel::GetLoss (uint32_t a, uint32_t b) const
+{
+  NS_ASSERT (a < GetNReceivers () && b < GetNReceivers ());
+  uint32_t clusterA = m_cluster[a];
+  uint32_t clusterB = m_cluster[b];
+  if ((clusterA == NO_CLUSTER) || (clusterB == NO_CLUSTER))
+    {
+      return m_defaultLoss;
+    }
+  else if (clusterA == clusterB)
+    {
+      const ClusterBlock &block = m_blocks[clusterA];
+      return block.loss[m_localIndex[a] * block.stride + m_localIndex[b]];
+    }
+  else
+    {
+      return m_interLoss[clusterA * m_clusters + clusterB] + m_offset[a] + m_offset[b];
+    }
+}
+
+void
+BlockMatrixPropagationLossModel::SetDefaultLoss (double defaultLoss)
+{
+  m_defaultLoss = defaultLoss;
+  for (uint32_t i = 0; i < m_interLoss.size (); i++)
+    {
+      if (!m_interExplicit[i])
+        {
+          m_interLoss[i] = defaultLoss;
+        }
+    }
+  for (std::vector<ClusterBlock>::iterator it = m_blocks.begin (); it != m_blocks.end (); it++)
+    {
+      for (uint32_t i = 0; i < it->loss.size (); i++)
+        {
+          if (!it->isExplicit[i])
+            {
+              it->loss[i] = defaultLoss;
+            }
+        }
+    }
+}
+
+uint64_t
+BlockMatrixPropagationLossModel::GetNEntries (void) const
+{
+  uint64_t entries = m_interLoss.size () + m_offset.size ();
+  for (std::vector<ClusterBlock>::const_iterator it = m_blocks.begin (); it != m_blocks.end (); it++)
+    {
+      entries += it->loss.size ();
+    }
+  return entries;
+}
+
+double
+BlockMatrixPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  uint32_t indexA, indexB;
+  if (GetTransmitterIndex (a, indexA) && GetReceiverIndex (b, indexB))
+    {
+      return txPowerDbm - GetLoss (indexA, indexB);
+    }
+  return txPowerDbm - m_defaultLoss;
+}
+
+int64_t
+BlockMatrixPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+void
+BlockMatrixPropagationLossModel::DoCalcRxPowerRow (uint32_t txIndex, double txPowerDbm, double *rxPowersDbm) const
+{
+  const uint32_t length = GetNReceivers ();
+  const uint32_t txCluster = m_cluster[txIndex];
+  if (txCluster == NO_CLUSTER)
+    {
+      std::fill (rxPowersDbm, rxPowersDbm + length, txPowerDbm - m_defaultLoss);
+      return;
+    }
+
+  /* Inter-cluster part for every receiver: gather the cluster-pair losses */
+  const double *interRow = m_interLoss.data () + txCluster * m_clusters;
+  const double base = txPowerDbm - m_offset[txIndex];
+  for (uint32_t i = 0; i < length; i++)
+    {
+      uint32_t cluster = m_cluster[i];
+      /* Unclustered receivers get the default loss alone, as in GetLoss */
+      rxPowersDbm[i] = (cluster == NO_CLUSTER) ? txPowerDbm - m_defaultLoss
+                                               : base - interRow[cluster] - m_offset[i];
+    }
+
+  /* Overwrite the members of the transmitter's cluster with the dense block row */
+  const ClusterBlock &block = m_blocks[txCluster];
+  const double *intraRow = block.loss.data () + m_localIndex[txIndex] * block.stride;
+  for (uint32_t k = 0; k < block.members.size (); k++)
+    {
+      rxPowersDbm[block.members[k]] = txPowerDbm - intraRow[k];
+    }
+}
+
+void
+BlockMatrixPropagationLossModel::DoAddReceiver (uint32_t index)
+{
+  m_cluster.push_back (NO_CLUSTER);
+  m_localIndex.push_back (0);
+  m_offset.push_back (0);
+}
+
+} // namespace ns3
+
+#endif // BLOCK_MATRIX_PROPAGATION_LOSS_MODEL_H
@@ -9,6 +9,8 @@
 #include "ns3/network-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "event-stream-digest.h"
+#include "sequence-tracker.h"
 #include <iomanip>
 
 /**
@@ -38,6 +40,11 @@
  * The simulation generates the following traces:
  * 1. PCAP traces for each station.
  * 2. The achieved throughput during a window of 100 ms.
+ * 3. Loss, duplicate, reordering and loss burst statistics of the flow. For long runs, FlowMonitor and its
+ *    per-packet state can be disabled with --flowMonitor=false, these statistics use constant memory.
+ * 4. With --digest=<file>, a digest of the PHY, SNR and SLS events per simulated second. Two builds are compared
+ *    by running the second one with --digestReference=<file of the first one>, which reports the first
+ *    divergent interval.
  */
 
 NS_LOG_COMPONENT_DEFINE ("CompareAccessSchemes");
@@ -98,6 +105,10 @@ main (int argc, char *argv[])
   double simulationTime = 10;                   /* Simulation time in seconds. */
   bool pcapTracing = false;                     /* PCAP Tracing is enabled. */
   uint32_t snapshotLength = std::numeric_limits<uint32_t>::max (); /* The maximum PCAP Snapshot Length. */
+  bool enableFlowMonitor = true;                /* Install FlowMonitor on all the nodes. */
+  uint32_t sequenceWindow = 1024;               /* The number of sequence numbers tracked by the sink. */
+  string digestFile = "";                       /* The file of the event stream digest (empty to disable). */
+  string digestReference = "";                  /* The digest file of a reference build to compare with. */
 
   /* Command line argument parser setup. */
   CommandLine cmd;
@@ -115,6 +126,10 @@ main (int argc, char *argv[])
   cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
   cmd.AddValue ("pcap", "Enable PCAP Tracing", pcapTracing);
   cmd.AddValue ("snapshotLength", "The maximum PCAP snapshot length", snapshotLength);
+  cmd.AddValue ("flowMonitor", "Install FlowMonitor on all the nodes", enableFlowMonitor);
+  cmd.AddValue ("sequenceWindow", "The number of sequence numbers tracked by the sink, larger reordering counts as loss", sequenceWindow);
+  cmd.AddValue ("digest", "Write the per second event stream digest to this file", digestFile);
+  cmd.AddValue ("digestReference", "Compare the event stream digest with the one of a reference build", digestReference);
   cmd.Parse (argc, argv);
 
   /* Validate WiGig standard value */
@@ -259,6 +274,12 @@ main (int argc, char *argv[])
   srcApp.Start (Seconds (1.0));
   srcApp.Stop (Seconds (simulationTime));
 
+  /* Carry a sequence number in the payload at the source and track it at the sink */
+  Ptr<SequenceMonitor> sequenceMonitor = CreateObject<SequenceMonitor> ();
+  sequenceMonitor->SetAttribute ("WindowSize", UintegerValue (sequenceWindow));
+  sequenceMonitor->InstallSource (srcApp.Get (0));
+  sequenceMonitor->Install (packetSink);
+
   /* Print Traces */
   if (pcapTracing)
     {
@@ -287,14 +308,53 @@ main (int argc, char *argv[])
   /* Install FlowMonitor on all nodes */
   FlowMonitorHelper flowmon;
   Ptr<FlowMonitor> monitor;
-  monitor = flowmon.InstallAll ();
+  if (enableFlowMonitor)
+    {
+      monitor = flowmon.InstallAll ();
+    }
+
+  /* Digest the event stream */
+  Ptr<EventStreamDigest> eventDigest;
+  if (digestFile != "")
+    {
+      eventDigest = CreateObject<EventStreamDigest> ();
+      eventDigest->Open (digestFile);
+      eventDigest->Install (NetDeviceContainer (apDevice, staDevice));
+    }
 
   Simulator::Stop (Seconds (simulationTime + 0.101));
   Simulator::Run ();
+  if (eventDigest)
+    {
+      eventDigest->Flush ();
+      std::cout << "Event Stream Digest = " << std::hex << eventDigest->GetTotalDigest () << std::dec
+                << " (" << eventDigest->GetTotalEvents () << " events, "
+                << eventDigest->GetNIntervals () << " intervals)" << std::endl;
+      eventDigest->Dispose ();
+      if (digestReference != "")
+        {
+          int64_t interval = EventStreamDigest::FindFirstDivergentInterval (digestReference, digestFile);
+          if (interval < 0)
+            {
+              std::cout << "Event stream matches " << digestReference << std::endl;
+            }
+          else
+            {
+              std::cout << "Event stream diverges from " << digestReference << " in interval " << interval << std::endl;
+            }
+        }
+    }
   Simulator::Destroy ();
 
   /* Print Flow-Monitor Statistics */
-  PrintFlowMonitorStatistics (flowmon, monitor, simulationTime - 1);
+  if (enableFlowMonitor)
+    {
+      PrintFlowMonitorStatistics (flowmon, monitor, simulationTime - 1);
+    }
+
+  /* Print Sequence Statistics */
+  std::cout << "Tx Packets: " << sequenceMonitor->GetTotalTxPackets () << std::endl;
+  sequenceMonitor->Print (std::cout);
 
   /* Print Results Summary */
   std::cout << "Total #Received Packets = " << packetSink->GetTotalReceivedPackets () << std::endl;
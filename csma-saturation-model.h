@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef CSMA_SATURATION_MODEL_H
+#define CSMA_SATURATION_MODEL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "dense-matrix-propagation-loss-model.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *          Analytic CSMA/CA Saturation Throughput
+ ********************************************************/
+
+/**
+ * Bianchi-style estimator of the saturation throughput of the flows of a
+ * CSMA/CA network, extended with a conflict graph for topologies that are not
+ * fully connected.
+ *
+ * The carrier sense relation and the interference relation are derived from
+ * the losses of a DenseMatrixPropagationLossModel. For a flow f:
+ * - its contenders are the flows whose transmitter is sensed by the transmitter
+ *   of f, they share the backoff process of f as in the Bianchi model,
+ * - its hidden flows are the flows whose transmitter is not sensed by the
+ *   transmitter of f but whose interference brings the SINR at the receiver of
+ *   f below SinrThreshold. A hidden flow corrupts f if it starts a transmission
+ *   within the vulnerable period of f: the whole frame exchange without
+ *   RTS/CTS, only the RTS when the hidden transmitter hears the CTS of the
+ *   receiver.
+ * The transmission probability of every flow is the fixed point of its backoff
+ * process (binary exponential backoff with RetryLimit attempts) and of its
+ * failure probability, which combines collisions with the contenders and with
+ * the hidden flows. The throughput of a flow is its successful payload per
+ * mean backoff slot of its own carrier sense domain.
+ *
+ * The frame durations follow the DSSS/HR-DSSS PHY with the long preamble. The
+ * RTS/CTS threshold and, for a ConstantRateWifiManager, the data and control
+ * modes are read from the remote station manager of the devices; for rate
+ * adaptation managers the DataMode and ControlMode attributes are used.
+ */
+class CsmaSaturationModel : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmaSaturationModel ();
+  virtual ~CsmaSaturationModel ();
+
+  /**
+   * Read the topology and the MAC settings of the network.
+   * \param lossModel The loss model of the channel.
+   * \param devices The Wifi devices, flows refer to them by their index in the container.
+   */
+  void Setup (Ptr<DenseMatrixPropagationLossModel> lossModel, NetDeviceContainer devices);
+  /**
+   * Add a flow.
+   * \param src The index of the source device.
+   * \param dst The index of the destination device.
+   * \param payloadSize The UDP payload size in bytes.
+   * \param offeredRate The offered load in bps, zero for a saturated source.
+   */
+  void AddFlow (uint32_t src, uint32_t dst, uint32_t payloadSize, uint64_t offeredRate = 0);
+  /**
+   * Solve the model.
+   * \return The throughput of each flow in Mbps, in the order the flows were added.
+   */
+  std::vector<double> Solve (void);
+  /**
+   * \return The number of fixed point iterations of the last solution.
+   */
+  uint32_t GetNIterations (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct Flow {
+    uint32_t src;                       //!< Index of the source device.
+    uint32_t dst;                       //!< Index of the destination device.
+    uint32_t payloadSize;               //!< UDP payload size in bytes.
+    uint64_t offeredRate;               //!< Offered load in bps, zero if saturated.
+    double successDuration;             //!< Channel time of a successful exchange (us).
+    double collisionDuration;           //!< Channel time of a failed exchange (us).
+    std::vector<uint32_t> contenders;   //!< Flows sharing the backoff process.
+    std::vector<uint32_t> hidden;       //!< Hidden flows.
+    std::vector<double> vulnerable;     //!< Vulnerable period against each hidden flow (us).
+  };
+
+  /**
+   * \param tx The index of the transmitting device.
+   * \param rx The index of the receiving device.
+   * \return The received power in dBm.
+   */
+  double GetRxPower (uint32_t tx, uint32_t rx) const;
+  /**
+   * \param bytes The frame size in bytes.
+   * \param mode The PHY mode.
+   * \return The frame duration in microseconds.
+   */
+  double GetFrameDuration (uint32_t bytes, WifiMode mode) const;
+  /**
+   * Transmission probability per slot of a flow with a given failure probability.
+   * \param p The failure probability of a transmission.
+   * \return The transmission probability.
+   */
+  double GetTransmissionProbability (double p) const;
+  /**
+   * Build the conflict graph and the frame durations.
+   */
+  void BuildConflictGraph (void);
+
+  double m_csThreshold;                 //!< Carrier sense threshold (dBm).
+  double m_sinrThreshold;               //!< Minimum SINR of a successful reception (dB).
+  double m_txPower;                     //!< Transmit power (dBm).
+  Time m_slot;                          //!< Slot time.
+  Time m_sifs;                          //!< SIFS.
+  Time m_preamble;                      //!< PLCP preamble and header duration.
+  uint32_t m_cwMin;                     //!< Minimum contention window.
+  uint32_t m_cwMax;                     //!< Maximum contention window.
+  uint32_t m_retryLimit;                //!< Maximum number of transmission attempts.
+  std::string m_dataModeName;           //!< Data mode of rate adaptation managers.
+  std::string m_controlModeName;        //!< Control mode of rate adaptation managers.
+  uint32_t m_maxIterations;             //!< Maximum number of fixed point iterations.
+  double m_tolerance;                   //!< Convergence tolerance of the fixed point.
+  WifiMode m_dataMode;                  //!< Data mode of the network.
+  WifiMode m_controlMode;               //!< Control mode of the network.
+  uint32_t m_rtsCtsThreshold;           //!< RTS/CTS threshold in bytes.
+  Ptr<DenseMatrixPropagationLossModel> m_lossModel; //!< Loss model of the channel.
+  std::vector<uint32_t> m_index;        //!< Index of each device in the loss model.
+  std::vector<Flow> m_flows;            //!< List of flows.
+  uint32_t m_iterations;                //!< Number of iterations of the last solution.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CsmaSaturationModel);
+
+TypeId
+CsmaSaturationModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmaSaturationModel")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<CsmaSaturationModel> ()
+    .AddAttribute ("CarrierSenseThreshold", "The received power in dBm above which a transmission is sensed.",
+                   DoubleValue (-101.0),
+                   MakeDoubleAccessor (&CsmaSaturationModel::m_csThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SinrThreshold", "The minimum SINR in dB of a successful reception.",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&CsmaSaturationModel::m_sinrThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SlotTime", "The slot time.",
+                   TimeValue (MicroSeconds (20)),
+                   MakeTimeAccessor (&CsmaSaturationModel::m_slot),
+                   MakeTimeChecker ())
+    .AddAttribute ("Sifs", "The short interframe space.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&CsmaSaturationModel::m_sifs),
+                   MakeTimeChecker ())
+    .AddAttribute ("PreambleDuration", "The duration of the PLCP preamble and header.",
+                   TimeValue (MicroSeconds (192)),
+                   MakeTimeAccessor (&CsmaSaturationModel::m_preamble),
+                   MakeTimeChecker ())
+    .AddAttribute ("CwMin", "The minimum contention window.",
+                   UintegerValue (31),
+                   MakeUintegerAccessor (&CsmaSaturationModel::m_cwMin),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CwMax", "The maximum contention window.",
+                   UintegerValue (1023),
+                   MakeUintegerAccessor (&CsmaSaturationModel::m_cwMax),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RetryLimit", "The maximum number of transmission attempts of a frame.",
+                   UintegerValue (7),
+                   MakeUintegerAccessor (&CsmaSaturationModel::m_retryLimit),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DataMode", "The data mode assumed for rate adaptation managers.",
+                   StringValue ("DsssRate11Mbps"),
+                   MakeStringAccessor (&CsmaSaturationModel::m_dataModeName),
+                   MakeStringChecker ())
+    .AddAttribute ("ControlMode", "The control mode assumed for rate adaptation managers.",
+                   StringValue ("DsssRate1Mbps"),
+                   MakeStringAccessor (&CsmaSaturationModel::m_controlModeName),
+                   MakeStringChecker ())
+    .AddAttribute ("MaxIterations", "The maximum number of fixed point iterations.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&CsmaSaturationModel::m_maxIterations),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Tolerance", "The convergence tolerance on the transmission probabilities.",
+                   DoubleValue (1e-9),
+                   MakeDoubleAccessor (&CsmaSaturationModel::m_tolerance),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+CsmaSaturationModel::CsmaSaturationModel ()
+  : m_txPower (16.0206),
+    m_rtsCtsThreshold (65535),
+    m_iterations (0)
+{
+}
+
+CsmaSaturationModel::~CsmaSaturationModel ()
+{
+}
+
+void
+CsmaSaturationModel::DoDispose (void)
+{
+  m_lossModel = 0;
+  m_flows.clear ();
+  Object::DoDispose ();
+}
+
+void
+CsmaSaturationModel::Setup (Ptr<DenseMatrixPropagationLossModel> lossModel, NetDeviceContainer devices)
+{
+  NS_ABORT_MSG_IF (devices.GetN () == 0, "There are no devices");
+  m_lossModel = lossModel;
+  m_index.clear ();
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<MobilityModel> mobility = devices.Get (i)->GetNode ()->GetObject<MobilityModel> ();
+      NS_ABORT_MSG_IF (!mobility, "Device " << i << " has no mobility model");
+      m_index.push_back (m_lossModel->AddReceiver (mobility));
+    }
+
+  /* The MAC settings are the same for all the devices */
+  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (0));
+  NS_ABORT_MSG_IF (!device, "The devices are not Wifi devices");
+  Ptr<WifiRemoteStationManager> manager = device->GetRemoteStationManager ();
+  UintegerValue threshold;
+  manager->GetAttribute ("RtsCtsThreshold", threshold);
+  m_rtsCtsThreshold = threshold.Get ();
+  if (manager->GetInstanceTypeId () == ConstantRateWifiManager::GetTypeId ())
+    {
+      WifiModeValue mode;
+      manager->GetAttribute ("DataMode", mode);
+      m_dataMode = mode.Get ();
+      manager->GetAttribute ("ControlMode", mode);
+      m_controlMode = mode.Get ();
+    }
+  else
+    {
+      m_dataMode = WifiMode (m_dataModeName);
+      m_controlMode = WifiMode (m_controlModeName);
+    }
+  DoubleValue txPower;
+  device->GetPhy ()->GetAttribute ("TxPowerStart", txPower);
+  m_txPower = txPower.Get ();
+}
+
+void
+CsmaSaturationModel::AddFlow (uint32_t src, uint32_t dst, uint32_t payloadSize, uint64_t offeredRate)
+{
+  NS_ABORT_MSG_IF ((src >= m_index.size ()) || (dst >= m_index.size ()), "Unknown device, call Setup first");
+  Flow flow;
+  flow.src = src;
+  flow.dst = dst;
+  flow.payloadSize = payloadSize;
+  flow.offeredRate = offeredRate;
+  flow.successDuration = 0;
+  flow.collisionDuration = 0;
+  m_flows.push_back (flow);
+}
+
+uint32_t
+CsmaSaturationModel::GetNIterations (void) const
+{
+  return m_iterations;
+}
+
+double
+CsmaSaturationModel::GetRxPower (uint32_t tx, uint32_t rx) const
+{
+  return m_txPower - m_lossModel->GetLoss (m_index[tx], m_index[rx]);
+}
+
+double
+CsmaSaturationModel::GetFrameDuration (uint32_t bytes, WifiMode mode) const
+{
+  return m_preamble.GetMicroSeconds () + bytes * 8.0 * 1e6 / mode.GetPhyRate ();
+}
+
+double
+CsmaSaturationModel::GetTransmissionProbability (double p) const
+{
+  /* Renewal form of the Bianchi model: attempts per frame over attempts plus backoff slots per frame */
+  double attempts = 0;
+  double backoff = 0;
+  double probability = 1;
+  uint32_t cw = m_cwMin;
+  for (uint32_t i = 0; i < m_retryLimit; i++)
+    {
+      attempts += probability;
+      backoff += probability * cw / 2.0;
+      probability *= p;
+      cw = std::min (2 * cw + 1, m_cwMax);
+    }
+  return attempts / (attempts + backoff);
+}
+
+void
+CsmaSaturationModel::BuildConflictGraph (void)
+{
+  double sifs = m_sifs.GetMicroSeconds ();
+  double difs = sifs + 2 * m_slot.GetMicroSeconds ();
+  double ack = GetFrameDuration (14, m_controlMode);
+  double rts = GetFrameDuration (20, m_controlMode);
+  double cts = GetFrameDuration (14, m_controlMode);
+  for (uint32_t f = 0; f < m_flows.size (); f++)
+    {
+      Flow &flow = m_flows[f];
+      /* UDP, IP, LLC/SNAP, MAC header and FCS */
+      uint32_t mpduSize = flow.payloadSize + 8 + 20 + 8 + 24 + 4;
+      double data = GetFrameDuration (mpduSize, m_dataMode);
+      bool useRts = (mpduSize > m_rtsCtsThreshold);
+      if (useRts)
+        {
+          flow.successDuration = rts + sifs + cts + sifs + data + sifs + ack + difs;
+          flow.collisionDuration = rts + sifs + cts + difs;
+        }
+      else
+        {
+          flow.successDuration = data + sifs + ack + difs;
+          /* The other stations defer for EIFS after a corrupted frame */
+          flow.collisionDuration = data + sifs + ack + difs;
+        }
+
+      flow.contenders.clear ();
+      flow.hidden.clear ();
+      flow.vulnerable.clear ();
+      double signal = GetRxPower (flow.src, flow.dst);
+      for (uint32_t g = 0; g < m_flows.size (); g++)
+        {
+          if (g == f)
+            {
+              continue;
+            }
+          const Flow &other = m_flows[g];
+          if ((other.src == flow.src) || (GetRxPower (other.src, flow.src) >= m_csThreshold))
+            {
+              flow.contenders.push_back (g);
+              continue;
+            }
+          double interference = GetRxPower (other.src, flow.dst);
+          if (signal - interference >= m_sinrThreshold)
+            {
+              continue;
+            }
+          /* A hidden transmitter hearing the CTS of the receiver only threatens the RTS */
+          uint32_t otherMpdu = other.payloadSize + 8 + 20 + 8 + 24 + 4;
+          bool otherRts = (otherMpdu > m_rtsCtsThreshold);
+          double otherFrame = otherRts ? rts : GetFrameDuration (otherMpdu, m_dataMode);
+          double vulnerable;
+          if (useRts && (GetRxPower (flow.dst, other.src) >= m_csThreshold))
+            {
+              vulnerable = rts + otherFrame;
+            }
+          else
+            {
+              vulnerable = flow.successDuration - difs + otherFrame;
+            }
+          flow.hidden.push_back (g);
+          flow.vulnerable.push_back (vulnerable);
+        }
+    }
+}
+
+std::vector<double>
+CsmaSaturationModel::Solve (void)
+{
+  NS_ABORT_MSG_IF (m_flows.empty (), "There are no flows");
+  BuildConflictGraph ();
+  uint32_t n = m_flows.size ();
+  double slot = m_slot.GetMicroSeconds ();
+  std::vector<double> tau (n, GetTransmissionProbability (0));
+  std::vector<double> hiddenFailure (n, 0);
+  std::vector<double> meanSlot (n, slot);
+  std::vector<double> alone (n, 0);
+
+  for (m_iterations = 1; m_iterations <= m_maxIterations; m_iterations++)
+    {
+      /* Mean slot duration of the carrier sense domain of every flow */
+      for (uint32_t f = 0; f < n; f++)
+        {
+          const Flow &flow = m_flows[f];
+          std::vector<uint32_t> domain (flow.contenders);
+          domain.push_back (f);
+          double idle = 1;
+          double longestCollision = 0;
+          for (uint32_t i = 0; i < domain.size (); i++)
+            {
+              idle *= 1 - tau[domain[i]];
+              longestCollision = std::max (longestCollision, m_flows[domain[i]].collisionDuration);
+            }
+          double busy = 0;
+          double single = 0;
+          for (uint32_t i = 0; i < domain.size (); i++)
+            {
+              uint32_t g = domain[i];
+              double probability = (tau[g] < 1) ? tau[g] * idle / (1 - tau[g]) : 0;
+              busy += probability * ((1 - hiddenFailure[g]) * m_flows[g].successDuration
+                                     + hiddenFailure[g] * m_flows[g].collisionDuration);
+              single += probability;
+              if (g == f)
+                {
+                  alone[f] = probability;
+                }
+            }
+          meanSlot[f] = idle * slot + busy + (1 - idle - single) * longestCollision;
+        }
+
+      /* Failure probability and new transmission probability */
+      double change = 0;
+      for (uint32_t f = 0; f < n; f++)
+        {
+          const Flow &flow = m_flows[f];
+          double noCollision = 1;
+          for (uint32_t i = 0; i < flow.contenders.size (); i++)
+            {
+              noCollision *= 1 - tau[flow.contenders[i]];
+            }
+          double noHidden = 1;
+          for (uint32_t i = 0; i < flow.hidden.size (); i++)
+            {
+              uint32_t g = flow.hidden[i];
+              noHidden *= std::pow (1 - tau[g], flow.vulnerable[i] / meanSlot[g]);
+            }
+          hiddenFailure[f] = 1 - noHidden;
+          double target = GetTransmissionProbability (1 - noCollision * noHidden);
+          /* Damped update, the fixed point oscillates with strongly coupled flows */
+          double next = 0.5 * tau[f] + 0.5 * target;
+          change = std::max (change, std::abs (next - tau[f]));
+          tau[f] = next;
+        }
+      if (change < m_tolerance)
+        {
+          break;
+        }
+    }
+
+  std::vector<double> throughput (n);
+  for (uint32_t f = 0; f < n; f++)
+    {
+      const Flow &flow = m_flows[f];
+      throughput[f] = alone[f] * (1 - hiddenFailure[f]) * flow.payloadSize * 8 / meanSlot[f];
+      if (flow.offeredRate > 0)
+        {
+          throughput[f] = std::min (throughput[f], flow.offeredRate / 1e6);
+        }
+    }
+  return throughput;
+}
+
+} // namespace ns3
+
+#endif // CSMA_SATURATION_MODEL_H
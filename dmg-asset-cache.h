@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_ASSET_CACHE_H
+#define DMG_ASSET_CACHE_H
+
+#include "ns3/abort.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+#include <map>
+
+namespace ns3 {
+
+/********************************************************
+ *              Process-Wide DmgFiles Asset Cache
+ ********************************************************/
+
+/**
+ * Cache of the resources loaded from DmgFiles. Each asset is loaded and parsed
+ * once per process, and the same immutable instance is handed out to every
+ * simulation run of a sweep, so re-creating the devices for every sweep point
+ * no longer re-reads the files. The cache outlives Simulator::Destroy.
+ *
+ * Only the error rate lookup tables are shared, through CachedErrorRateModel.
+ * Codebooks keep the current antenna/sector configuration of their device and
+ * the Q-D propagation engine reads and keeps its own traces, so both remain
+ * per device and per run respectively.
+ */
+class DmgAssetCache
+{
+public:
+  /**
+   * Get the shared error rate model loaded from a lookup table.
+   * \param typeId The TypeId of the error rate model, e.g. "ns3::DmgErrorModel".
+   * \param fileName The lookup table, e.g. "DmgFiles/ErrorModel/LookupTable_1458_ay.txt".
+   * \return The error rate model.
+   */
+  static Ptr<ErrorRateModel> GetErrorRateModel (std::string typeId, std::string fileName);
+  /**
+   * \return The number of files parsed so far.
+   */
+  static uint32_t GetNLoads (void);
+  /**
+   * Release all the cached assets.
+   */
+  static void Clear (void);
+
+private:
+  typedef std::pair<std::string, std::string> ErrorModelKey;
+  static std::map<ErrorModelKey, Ptr<ErrorRateModel> > &GetErrorRateModels (void);
+  static uint32_t &GetLoadCounter (void);
+
+};
+
+std::map<DmgAssetCache::ErrorModelKey, Ptr<ErrorRateModel> > &
+DmgAssetCache::GetErrorRateModels (void)
+{
+  static std::map<ErrorModelKey, Ptr<ErrorRateModel> > models;
+  return models;
+}
+
+uint32_t &
+DmgAssetCache::GetLoadCounter (void)
+{
+  static uint32_t loads = 0;
+  return loads;
+}
+
+Ptr<ErrorRateModel>
+DmgAssetCache::GetErrorRateModel (std::string typeId, std::string fileName)
+{
+  ErrorModelKey key (typeId, fileName);
+  std::map<ErrorModelKey, Ptr<ErrorRateModel> > &models = GetErrorRateModels ();
+  std::map<ErrorModelKey, Ptr<ErrorRateModel> >::const_iterator it = models.find (key);
+  if (it != models.end ())
+    {
+      return it->second;
+    }
+  ObjectFactory factory;
+  factory.SetTypeId (typeId);
+  factory.Set ("FileName", StringValue (fileName));
+  Ptr<ErrorRateModel> model = factory.Create<ErrorRateModel> ();
+  models[key] = model;
+  GetLoadCounter ()++;
+  return model;
+}
+
+uint32_t
+DmgAssetCache::GetNLoads (void)
+{
+  return GetLoadCounter ();
+}
+
+void
+DmgAssetCache::Clear (void)
+{
+  GetErrorRateModels ().clear ();
+}
+
+/**
+ * Error rate model forwarding to the shared instance of DmgAssetCache. It is
+ * set on the PHY helper before the devices are installed, in place of the
+ * model itself:
+ *
+ *   wifiPhy.SetErrorRateModel ("ns3::CachedErrorRateModel",
+ *                              "ErrorRateModel", StringValue ("ns3::DmgErrorModel"),
+ *                              "FileName", StringValue ("DmgFiles/ErrorModel/LookupTable_1458_ay.txt"));
+ *
+ * Each PHY gets its own lightweight instance, while the lookup table is parsed
+ * once per process on the first chunk evaluated.
+ */
+class CachedErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CachedErrorRateModel ();
+  virtual ~CachedErrorRateModel ();
+
+private:
+  virtual double DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  std::string m_typeId;                         //!< TypeId of the shared error rate model.
+  std::string m_fileName;                       //!< Lookup table of the shared error rate model.
+  mutable Ptr<ErrorRateModel> m_model;          //!< Shared error rate model, resolved on first use.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CachedErrorRateModel);
+
+TypeId
+CachedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<CachedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel", "The TypeId of the shared error rate model.",
+                   StringValue ("ns3::DmgErrorModel"),
+                   MakeStringAccessor (&CachedErrorRateModel::m_typeId),
+                   MakeStringChecker ())
+    .AddAttribute ("FileName", "The lookup table of the shared error rate model.",
+                   StringValue (""),
+                   MakeStringAccessor (&CachedErrorRateModel::m_fileName),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+CachedErrorRateModel::CachedErrorRateModel ()
+{
+}
+
+CachedErrorRateModel::~CachedErrorRateModel ()
+{
+}
+
+double
+CachedErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  if (m_model == 0)
+    {
+      NS_ABORT_MSG_IF (m_fileName.empty (), "No lookup table given to the cached error rate model");
+      m_model = DmgAssetCache::GetErrorRateModel (m_typeId, m_fileName);
+    }
+  return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+}
+
+} // namespace ns3
+
+#endif // DMG_ASSET_CACHE_H
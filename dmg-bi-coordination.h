@@ -0,0 +1,541 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_BI_COORDINATION_H
+#define DMG_BI_COORDINATION_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *      Beacon Interval Coordination between PCP/APs
+ ********************************************************/
+
+/**
+ * Maximum duration of an allocation block in microseconds (IEEE 802.11ad 8.4.2.134).
+ */
+static const uint32_t DMG_MAX_BLOCK_DURATION = 32767;
+
+/**
+ * Decentralized coordination of the beacon intervals of co-channel DMG PCP/APs,
+ * in the spirit of the decentralized PCP/AP clustering of IEEE 802.11ad 10.37.
+ * All the PCP/APs are assumed to use the same beacon interval and the same BHI
+ * configuration.
+ *
+ * The PCP/AP overhears the DMG Beacons of its neighbours and learns the phase
+ * of their beacon header intervals (BHI). Since the first DMG Beacon heard from
+ * a neighbour is not necessarily the first one of its BTI, the BHI of the
+ * neighbour is conservatively assumed to occupy one BHI duration before and
+ * after that beacon. Whenever the BHI of the PCP/AP overlaps with the BHI of a
+ * neighbour, it moves its BHI into the largest idle gap of the beacon interval
+ * by stretching a single beacon interval (the BeaconInterval attribute is read
+ * by the PCP/AP when it computes the DTI duration). If two PCP/APs overlap, only
+ * the one with the largest BSSID moves.
+ *
+ * After LearningIntervals beacon intervals the schedule is frozen and the
+ * requested service periods are allocated in the quiet periods of the DTI,
+ * i.e. outside the BHIs of the neighbours. Each request gets one allocation ID
+ * and a single block of at most DMG_MAX_BLOCK_DURATION in the quiet period
+ * leaving it the largest share; a request made after the schedule is frozen
+ * re-plans the blocks of the earlier requests. To give neighbours a chance to
+ * be overheard before the first BTI, the PCP/APs should delay their first
+ * beacon interval with a random BeaconJitter spread over one beacon interval.
+ */
+class DmgBeaconIntervalCoordination : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DmgBeaconIntervalCoordination ();
+  virtual ~DmgBeaconIntervalCoordination ();
+
+  /**
+   * Setup the coordination of a DMG PCP/AP.
+   * \param apDevice The DMG PCP/AP device.
+   */
+  void Setup (Ptr<WifiNetDevice> apDevice);
+  /**
+   * Request a service period between two stations of the BSS. The service
+   * periods are allocated once the schedule is frozen, the quiet periods are
+   * shared equally between the requests. A request made once the schedule is
+   * frozen moves and shrinks the service periods already allocated. At most
+   * MAX_ALLOCATION_ID requests are accepted, the size of the AllocationID field.
+   * \param srcAid The AID of the source station.
+   * \param dstAid The AID of the destination station.
+   */
+  void RequestServicePeriod (uint8_t srcAid, uint8_t dstAid);
+  /**
+   * \return True if the schedule is frozen.
+   */
+  bool IsAligned (void) const;
+  /**
+   * \return The number of neighbouring PCP/APs overheard so far.
+   */
+  uint32_t GetNNeighbours (void) const;
+  /**
+   * \return The number of beacon interval shifts so far.
+   */
+  uint32_t GetNShifts (void) const;
+  /**
+   * \return The total duration of the allocated service periods per beacon interval.
+   */
+  Time GetAllocatedDuration (void) const;
+
+  /**
+   * TracedCallback signature for beacon interval shifts.
+   * \param shift The shift of the start of the beacon interval.
+   */
+  typedef void (* BeaconIntervalShiftCallback)(Time shift);
+
+  static const uint8_t MAX_ALLOCATION_ID = 15;  //!< Largest value of the 4-bit AllocationID field.
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * A busy window within the beacon interval [start, start + duration), start
+   * is the offset modulo the beacon interval.
+   */
+  struct BusyWindow {
+    int64_t start;            //!< Offset within the beacon interval in nanoseconds.
+    int64_t duration;         //!< Duration in nanoseconds.
+
+    bool operator< (const BusyWindow &other) const
+    {
+      return start < other.start;
+    }
+  };
+
+  /**
+   * Information learnt about a neighbour.
+   */
+  struct NeighbourInfo {
+    Time lastRx;              //!< Reception time of the last DMG Beacon.
+    int64_t phase;            //!< Phase of the first DMG Beacon of the last BTI heard.
+  };
+
+  /**
+   * A requested service period, its allocation ID is its index plus one.
+   */
+  struct ServicePeriodRequest {
+    uint8_t srcAid;           //!< AID of the source station.
+    uint8_t dstAid;           //!< AID of the destination station.
+    bool allocated;           //!< Flag to indicate that the allocation exists at the PCP/AP.
+  };
+
+  void PhyRxEnd (Ptr<const Packet> packet);
+  void DataTransmissionIntervalStarted (Mac48Address address, Time duration);
+  /**
+   * \param info The information learnt about the neighbour.
+   * \return The BHI of the neighbour, extended by one BHI before its phase and the guard time.
+   */
+  BusyWindow GetNeighbourWindow (const NeighbourInfo &info) const;
+  /**
+   * \return The BHIs of the neighbours, sorted by offset.
+   */
+  std::vector<BusyWindow> GetNeighbourWindows (void) const;
+  /**
+   * \param phase The phase of the own beacon interval.
+   * \return True if the own BHI overlaps with the BHI of a neighbour which does not move away.
+   */
+  bool IsInConflict (int64_t phase) const;
+  /**
+   * Move the BHI to the largest idle gap of the beacon interval.
+   * \param phase The phase of the own beacon interval.
+   */
+  void Shift (int64_t phase);
+  /**
+   * Allocate the requested service periods in the quiet periods of the DTI,
+   * or move the existing ones to make room for new requests.
+   * \param phase The phase of the own beacon interval.
+   */
+  void AllocateServicePeriods (int64_t phase);
+  /**
+   * \return The value modulo the beacon interval.
+   */
+  int64_t Wrap (int64_t value) const;
+  /**
+   * \return True if the two windows overlap on the beacon interval circle.
+   */
+  bool Overlap (const BusyWindow &a, const BusyWindow &b) const;
+
+  uint32_t m_learningIntervals;                     //!< Number of beacon intervals before freezing the schedule.
+  Time m_guardTime;                                 //!< Guard time around the BHIs.
+  Ptr<DmgApWifiMac> m_apMac;                        //!< MAC of the DMG PCP/AP.
+  int64_t m_beaconInterval;                         //!< Nominal beacon interval in nanoseconds.
+  int64_t m_bhiDuration;                            //!< Measured BHI duration in nanoseconds.
+  int64_t m_phase;                                  //!< Phase of the own beacon interval once frozen.
+  std::map<Mac48Address, NeighbourInfo> m_neighbours; //!< Neighbouring PCP/APs.
+  std::vector<ServicePeriodRequest> m_requests;     //!< Requested service periods.
+  uint32_t m_intervals;                             //!< Number of beacon intervals since the start.
+  bool m_stretched;                                 //!< Flag to indicate that the next beacon interval is stretched.
+  bool m_aligned;                                   //!< Flag to indicate that the schedule is frozen.
+  uint32_t m_shifts;                                //!< Number of beacon interval shifts.
+  Time m_allocatedDuration;                         //!< Total duration of the allocated service periods.
+  TracedCallback<Time> m_beaconIntervalShift;       //!< Trace fired upon a beacon interval shift.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DmgBeaconIntervalCoordination);
+
+TypeId
+DmgBeaconIntervalCoordination::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DmgBeaconIntervalCoordination")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<DmgBeaconIntervalCoordination> ()
+    .AddAttribute ("LearningIntervals", "The number of beacon intervals during which the PCP/AP learns "
+                   "the schedules of its neighbours before freezing its own schedule.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&DmgBeaconIntervalCoordination::m_learningIntervals),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("GuardTime", "The guard time kept around the BHIs.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&DmgBeaconIntervalCoordination::m_guardTime),
+                   MakeTimeChecker ())
+    .AddTraceSource ("BeaconIntervalShift", "The start of the beacon interval has been shifted.",
+                     MakeTraceSourceAccessor (&DmgBeaconIntervalCoordination::m_beaconIntervalShift),
+                     "ns3::DmgBeaconIntervalCoordination::BeaconIntervalShiftCallback")
+  ;
+  return tid;
+}
+
+DmgBeaconIntervalCoordination::DmgBeaconIntervalCoordination ()
+  : m_beaconInterval (0),
+    m_bhiDuration (0),
+    m_phase (0),
+    m_intervals (0),
+    m_stretched (false),
+    m_aligned (false),
+    m_shifts (0)
+{
+}
+
+DmgBeaconIntervalCoordination::~DmgBeaconIntervalCoordination ()
+{
+}
+
+void
+DmgBeaconIntervalCoordination::DoDispose (void)
+{
+  m_apMac = 0;
+  Object::DoDispose ();
+}
+
+void
+DmgBeaconIntervalCoordination::Setup (Ptr<WifiNetDevice> apDevice)
+{
+  m_apMac = DynamicCast<DmgApWifiMac> (apDevice->GetMac ());
+  NS_ABORT_MSG_IF (m_apMac == 0, "The beacon interval coordination requires a DMG PCP/AP");
+  TimeValue beaconInterval;
+  m_apMac->GetAttribute ("BeaconInterval", beaconInterval);
+  m_beaconInterval = beaconInterval.Get ().GetNanoSeconds ();
+  apDevice->GetPhy ()->TraceConnectWithoutContext ("PhyRxEnd",
+                                                   MakeCallback (&DmgBeaconIntervalCoordination::PhyRxEnd, this));
+  m_apMac->TraceConnectWithoutContext ("DTIStarted",
+                                       MakeCallback (&DmgBeaconIntervalCoordination::DataTransmissionIntervalStarted, this));
+}
+
+void
+DmgBeaconIntervalCoordination::RequestServicePeriod (uint8_t srcAid, uint8_t dstAid)
+{
+  for (uint32_t i = 0; i < m_requests.size (); i++)
+    {
+      if ((m_requests[i].srcAid == srcAid) && (m_requests[i].dstAid == dstAid))
+        {
+          /* Re-association of the same station */
+          return;
+        }
+    }
+  NS_ABORT_MSG_IF (m_requests.size () >= MAX_ALLOCATION_ID,
+                   "At most " << uint16_t (MAX_ALLOCATION_ID) << " service periods can be requested");
+  ServicePeriodRequest request;
+  request.srcAid = srcAid;
+  request.dstAid = dstAid;
+  request.allocated = false;
+  m_requests.push_back (request);
+  /* Late request, re-plan the service periods */
+  if (m_aligned)
+    {
+      AllocateServicePeriods (m_phase);
+    }
+}
+
+bool
+DmgBeaconIntervalCoordination::IsAligned (void) const
+{
+  return m_aligned;
+}
+
+uint32_t
+DmgBeaconIntervalCoordination::GetNNeighbours (void) const
+{
+  return m_neighbours.size ();
+}
+
+uint32_t
+DmgBeaconIntervalCoordination::GetNShifts (void) const
+{
+  return m_shifts;
+}
+
+Time
+DmgBeaconIntervalCoordination::GetAllocatedDuration (void) const
+{
+  return m_allocatedDuration;
+}
+
+int64_t
+DmgBeaconIntervalCoordination::Wrap (int64_t value) const
+{
+  value %= m_beaconInterval;
+  return (value < 0) ? value + m_beaconInterval : value;
+}
+
+bool
+DmgBeaconIntervalCoordination::Overlap (const BusyWindow &a, const BusyWindow &b) const
+{
+  return (Wrap (b.start - a.start) < a.duration) || (Wrap (a.start - b.start) < b.duration);
+}
+
+void
+DmgBeaconIntervalCoordination::PhyRxEnd (Ptr<const Packet> packet)
+{
+  WifiMacHeader hdr;
+  packet->PeekHeader (hdr);
+  if (!hdr.IsDMGBeacon () || (hdr.GetAddr1 () == m_apMac->GetAddress ()))
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  std::map<Mac48Address, NeighbourInfo>::iterator it = m_neighbours.find (hdr.GetAddr1 ());
+  if (it == m_neighbours.end ())
+    {
+      NeighbourInfo info;
+      info.lastRx = now;
+      info.phase = Wrap (now.GetNanoSeconds ());
+      m_neighbours[hdr.GetAddr1 ()] = info;
+      return;
+    }
+  /* A new BTI of the neighbour starts after a silence longer than one BHI */
+  if ((m_bhiDuration == 0) || ((now - it->second.lastRx).GetNanoSeconds () > m_bhiDuration))
+    {
+      it->second.phase = Wrap (now.GetNanoSeconds ());
+    }
+  it->second.lastRx = now;
+}
+
+DmgBeaconIntervalCoordination::BusyWindow
+DmgBeaconIntervalCoordination::GetNeighbourWindow (const NeighbourInfo &info) const
+{
+  int64_t guard = m_guardTime.GetNanoSeconds ();
+  BusyWindow window;
+  window.start = Wrap (info.phase - m_bhiDuration - guard);
+  window.duration = 2 * (m_bhiDuration + guard);
+  return window;
+}
+
+std::vector<DmgBeaconIntervalCoordination::BusyWindow>
+DmgBeaconIntervalCoordination::GetNeighbourWindows (void) const
+{
+  std::vector<BusyWindow> windows;
+  for (std::map<Mac48Address, NeighbourInfo>::const_iterator it = m_neighbours.begin (); it != m_neighbours.end (); it++)
+    {
+      windows.push_back (GetNeighbourWindow (it->second));
+    }
+  std::sort (windows.begin (), windows.end ());
+  return windows;
+}
+
+bool
+DmgBeaconIntervalCoordination::IsInConflict (int64_t phase) const
+{
+  BusyWindow own;
+  own.start = phase;
+  own.duration = m_bhiDuration;
+  for (std::map<Mac48Address, NeighbourInfo>::const_iterator it = m_neighbours.begin (); it != m_neighbours.end (); it++)
+    {
+      /* Of two overlapping PCP/APs, the one with the largest BSSID moves away */
+      if (Overlap (own, GetNeighbourWindow (it->second)) && (it->first < m_apMac->GetAddress ()))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+DmgBeaconIntervalCoordination::Shift (int64_t phase)
+{
+  std::vector<BusyWindow> windows = GetNeighbourWindows ();
+  int64_t guard = m_guardTime.GetNanoSeconds ();
+  int64_t bestStart = 0;
+  int64_t bestGap = -1;
+  for (uint32_t i = 0; i < windows.size (); i++)
+    {
+      int64_t end = windows[i].start + windows[i].duration;
+      int64_t gap = Wrap (windows[(i + 1) % windows.size ()].start - end);
+      if (windows.size () == 1)
+        {
+          gap = m_beaconInterval - windows[i].duration;
+        }
+      if (gap > bestGap)
+        {
+          bestGap = gap;
+          bestStart = Wrap (end);
+        }
+    }
+  if (bestGap < m_bhiDuration + 2 * guard)
+    {
+      NS_LOG_UNCOND ("DMG PCP/AP " << m_apMac->GetAddress () << " found no idle gap for its BHI");
+      return;
+    }
+  /* Center the BHI within the gap */
+  int64_t target = Wrap (bestStart + (bestGap - m_bhiDuration) / 2);
+  Time shift = NanoSeconds (Wrap (target - phase));
+  m_apMac->SetAttribute ("BeaconInterval", TimeValue (NanoSeconds (m_beaconInterval) + shift));
+  m_stretched = true;
+  m_shifts++;
+  m_beaconIntervalShift (shift);
+}
+
+void
+DmgBeaconIntervalCoordination::AllocateServicePeriods (int64_t phase)
+{
+  if (m_requests.empty ())
+    {
+      return;
+    }
+  /* Quiet periods of the DTI, relative to the start of the DTI */
+  int64_t dtiStart = Wrap (phase + m_bhiDuration);
+  int64_t dtiDuration = m_beaconInterval - m_bhiDuration;
+  int64_t guard = m_guardTime.GetNanoSeconds ();
+  std::vector<BusyWindow> windows = GetNeighbourWindows ();
+  std::vector<std::pair<int64_t, int64_t> > busy;
+  for (uint32_t i = 0; i < windows.size (); i++)
+    {
+      int64_t start = Wrap (windows[i].start - dtiStart);
+      int64_t end = std::min (start + windows[i].duration, dtiDuration);
+      if (start + windows[i].duration > m_beaconInterval)
+        {
+          /* The window wraps around the start of the DTI */
+          busy.push_back (std::make_pair (int64_t (0), start + windows[i].duration - m_beaconInterval));
+        }
+      if (start < dtiDuration)
+        {
+          busy.push_back (std::make_pair (start, end));
+        }
+    }
+  std::sort (busy.begin (), busy.end ());
+
+  /* Quiet periods as (start, duration) */
+  std::vector<std::pair<int64_t, int64_t> > quiet;
+  int64_t cursor = guard;
+  busy.push_back (std::make_pair (dtiDuration, dtiDuration));
+  for (uint32_t i = 0; i < busy.size (); i++)
+    {
+      int64_t duration = busy[i].first - guard - cursor;
+      if (duration > guard)
+        {
+          quiet.push_back (std::make_pair (cursor, duration));
+        }
+      cursor = std::max (cursor, busy[i].second + guard);
+    }
+  if (quiet.empty ())
+    {
+      NS_LOG_UNCOND ("DMG PCP/AP " << m_apMac->GetAddress () << " found no quiet period for its SPs");
+      return;
+    }
+
+  /* Every request goes to the quiet period leaving it the largest share */
+  std::vector<uint32_t> count (quiet.size (), 0);
+  std::vector<uint32_t> assigned (m_requests.size ());
+  for (uint32_t j = 0; j < m_requests.size (); j++)
+    {
+      uint32_t best = 0;
+      for (uint32_t k = 1; k < quiet.size (); k++)
+        {
+          if (quiet[k].second / (count[k] + 1) > quiet[best].second / (count[best] + 1))
+            {
+              best = k;
+            }
+        }
+      assigned[j] = best;
+      count[best]++;
+    }
+
+  /* One block per request, so the allocation ID of a request stays the same when re-planning */
+  std::vector<uint32_t> slot (quiet.size (), 0);
+  m_allocatedDuration = Seconds (0);
+  for (uint32_t j = 0; j < m_requests.size (); j++)
+    {
+      uint32_t k = assigned[j];
+      int64_t share = quiet[k].second / count[k];
+      int64_t start = quiet[k].first + slot[k] * share;
+      int64_t block = std::min (std::max (share - guard, int64_t (0)),
+                                MicroSeconds (DMG_MAX_BLOCK_DURATION).GetNanoSeconds ());
+      slot[k]++;
+      if (m_requests[j].allocated)
+        {
+          /* Move the existing allocation, a share shorter than the guard time shrinks it to nothing */
+          m_apMac->ModifyAllocation (j + 1, m_requests[j].srcAid, m_requests[j].dstAid,
+                                     NanoSeconds (start).GetMicroSeconds (), NanoSeconds (block).GetMicroSeconds ());
+        }
+      else if (block > 0)
+        {
+          m_apMac->AllocateSingleContiguousBlock (j + 1, SERVICE_PERIOD_ALLOCATION, true,
+                                                  m_requests[j].srcAid, m_requests[j].dstAid,
+                                                  NanoSeconds (start).GetMicroSeconds (),
+                                                  NanoSeconds (block).GetMicroSeconds ());
+          m_requests[j].allocated = true;
+        }
+      m_allocatedDuration += NanoSeconds (block);
+    }
+}
+
+void
+DmgBeaconIntervalCoordination::DataTransmissionIntervalStarted (Mac48Address address, Time duration)
+{
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  /* Phase of the next beacon interval */
+  int64_t phase = Wrap (now + duration.GetNanoSeconds ());
+  if (m_stretched)
+    {
+      m_apMac->SetAttribute ("BeaconInterval", TimeValue (NanoSeconds (m_beaconInterval)));
+      m_stretched = false;
+      return;
+    }
+  m_bhiDuration = m_beaconInterval - duration.GetNanoSeconds ();
+  if (m_aligned)
+    {
+      return;
+    }
+  m_intervals++;
+  if (m_intervals < m_learningIntervals)
+    {
+      if (IsInConflict (phase))
+        {
+          Shift (phase);
+        }
+    }
+  else
+    {
+      m_aligned = true;
+      m_phase = phase;
+      AllocateServicePeriods (phase);
+    }
+}
+
+} // namespace ns3
+
+#endif // DMG_BI_COORDINATION_H
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_DYNAMIC_ALLOCATION_H
+#define DMG_DYNAMIC_ALLOCATION_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "dmg-service-period-scheduler.h"
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Dynamic Channel Time Allocation
+ ********************************************************/
+
+/**
+ * Callback returning the queue state of a STA in bytes, i.e. the value the STA
+ * would report in the Service Period Request (SPR) frame when polled.
+ */
+typedef Callback<uint64_t> QueueStateCallback;
+
+/**
+ * Demand driven channel time allocation in the PCP/AP, modelled on the
+ * IEEE 802.11ad dynamic allocation procedure (polling period, SPR and Grant).
+ *
+ * Every source STA owns one SP in the DTI. A polling period is reserved at the
+ * end of each DTI: the PCP/AP polls every STA, collects the queue state carried
+ * in its SPR and resizes the SPs of the following DTI in proportion to the
+ * reported demand, each STA keeping at least MinimumDuration so that it can be
+ * served as soon as traffic arrives. The grants are carried by the Extended
+ * Schedule element of the next DMG Beacon, which directly follows the polling
+ * period. With Polling disabled the SPs keep their initial equal durations,
+ * which gives the static allocation used as a baseline.
+ */
+class DmgDynamicAllocator : public DmgServicePeriodScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DmgDynamicAllocator ();
+  virtual ~DmgDynamicAllocator ();
+
+  /**
+   * Add a STA to poll.
+   * \param srcAid The AID of the source STA of the SP.
+   * \param dstAid The AID of the destination STA of the SP.
+   * \param queueState Callback returning the queue state reported in the SPR.
+   */
+  void AddStation (uint8_t srcAid, uint8_t dstAid, QueueStateCallback queueState);
+  /**
+   * \return The number of polling periods so far.
+   */
+  uint32_t GetNPollingPeriods (void) const;
+
+  /**
+   * TracedCallback signature for Grant events.
+   *
+   * \param srcAid The AID of the source STA.
+   * \param dstAid The AID of the destination STA.
+   * \param queueState The queue state reported by the source STA in bytes.
+   * \param duration The granted SP duration.
+   */
+  typedef void (* GrantCallback)(uint8_t srcAid, uint8_t dstAid, uint64_t queueState, Time duration);
+
+protected:
+  virtual void DoDispose (void);
+  /**
+   * Allocate equal SPs, the STAs are polled in every following DTI.
+   */
+  virtual void DoStart (void);
+  /**
+   * Schedule the polling period at the end of the DTI.
+   * \param duration The duration of the DTI.
+   */
+  virtual void DoDataTransmissionIntervalStarted (Time duration);
+
+private:
+  struct PolledStation {
+    uint8_t srcAid;                     //!< AID of the source STA.
+    uint8_t dstAid;                     //!< AID of the destination STA.
+    uint8_t allocationId;               //!< Allocation ID of the SP.
+    QueueStateCallback queueState;      //!< Queue state reported in the SPR.
+  };
+
+  /**
+   * Poll all the STAs and issue the grants of the next DTI.
+   */
+  void PollingPeriod (void);
+  /**
+   * Allocate the SPs of the next DTI.
+   * \param durations The duration of the SP of each STA.
+   * \param modify Whether to modify the existing allocations or create them.
+   */
+  void Allocate (const std::vector<Time> &durations, bool modify);
+
+  bool m_polling;                       //!< Whether to poll the STAs and resize their SPs.
+  Time m_pollingPeriod;                 //!< Duration of the polling period.
+  Time m_minimumDuration;               //!< Minimum SP duration of a STA.
+  Time m_maximumDuration;               //!< Maximum SP duration of a STA.
+  std::vector<PolledStation> m_stations;//!< List of polled STAs.
+  uint32_t m_pollingPeriods;            //!< Number of polling periods.
+  TracedCallback<uint8_t, uint8_t, uint64_t, Time> m_grantTrace;
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DmgDynamicAllocator);
+
+TypeId
+DmgDynamicAllocator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DmgDynamicAllocator")
+    .SetParent<DmgServicePeriodScheduler> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<DmgDynamicAllocator> ()
+    .AddAttribute ("Polling", "Whether to poll the STAs and resize their SPs in every DTI.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DmgDynamicAllocator::m_polling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PollingPeriod", "The duration of the polling period at the end of the DTI.",
+                   TimeValue (MicroSeconds (200)),
+                   MakeTimeAccessor (&DmgDynamicAllocator::m_pollingPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinimumDuration", "The minimum SP duration granted to a STA.",
+                   TimeValue (MicroSeconds (200)),
+                   MakeTimeAccessor (&DmgDynamicAllocator::m_minimumDuration),
+                   MakeTimeChecker (MicroSeconds (1), MicroSeconds (32767)))
+    .AddAttribute ("MaximumDuration", "The maximum SP duration granted to a STA.",
+                   TimeValue (MicroSeconds (32767)),
+                   MakeTimeAccessor (&DmgDynamicAllocator::m_maximumDuration),
+                   MakeTimeChecker (MicroSeconds (1), MicroSeconds (32767)))
+    .AddTraceSource ("Grant", "The PCP/AP granted a SP to a STA for the next DTI.",
+                     MakeTraceSourceAccessor (&DmgDynamicAllocator::m_grantTrace),
+                     "ns3::DmgDynamicAllocator::GrantCallback")
+  ;
+  return tid;
+}
+
+DmgDynamicAllocator::DmgDynamicAllocator ()
+  : m_pollingPeriods (0)
+{
+}
+
+DmgDynamicAllocator::~DmgDynamicAllocator ()
+{
+}
+
+void
+DmgDynamicAllocator::DoDispose (void)
+{
+  m_stations.clear ();
+  DmgServicePeriodScheduler::DoDispose ();
+}
+
+void
+DmgDynamicAllocator::AddStation (uint8_t srcAid, uint8_t dstAid, QueueStateCallback queueState)
+{
+  NS_ABORT_MSG_IF (IsStarted (), "Cannot add a STA once the allocations have started");
+  PolledStation station;
+  station.srcAid = srcAid;
+  station.dstAid = dstAid;
+  station.queueState = queueState;
+  m_stations.push_back (station);
+}
+
+uint32_t
+DmgDynamicAllocator::GetNPollingPeriods (void) const
+{
+  return m_pollingPeriods;
+}
+
+void
+DmgDynamicAllocator::DoStart (void)
+{
+  NS_ABORT_MSG_IF (m_stations.empty (), "There are no STAs to poll");
+  Time available = m_dtiDuration - m_pollingPeriod - NanoSeconds (m_guardTime.GetNanoSeconds () * m_stations.size ());
+  Time equal = std::min (NanoSeconds (available.GetNanoSeconds () / m_stations.size ()), m_maximumDuration);
+  NS_ABORT_MSG_IF (equal < m_minimumDuration, "The DTI is too short for the number of STAs");
+  for (uint32_t i = 0; i < m_stations.size (); i++)
+    {
+      m_stations[i].allocationId = GetNextAllocationId (m_stations[i].srcAid, m_stations[i].dstAid);
+    }
+  Allocate (std::vector<Time> (m_stations.size (), equal), false);
+}
+
+void
+DmgDynamicAllocator::DoDataTransmissionIntervalStarted (Time duration)
+{
+  if (m_polling)
+    {
+      Simulator::Schedule (duration - m_pollingPeriod, &DmgDynamicAllocator::PollingPeriod, this);
+    }
+}
+
+void
+DmgDynamicAllocator::PollingPeriod (void)
+{
+  m_pollingPeriods++;
+  std::vector<uint64_t> demand (m_stations.size ());
+  uint64_t totalDemand = 0;
+  for (uint32_t i = 0; i < m_stations.size (); i++)
+    {
+      demand[i] = m_stations[i].queueState ();
+      totalDemand += demand[i];
+    }
+
+  /* Every STA keeps its minimum SP, the rest of the DTI is shared in proportion to the demand */
+  Time available = m_dtiDuration - m_pollingPeriod
+                   - NanoSeconds ((m_guardTime + m_minimumDuration).GetNanoSeconds () * m_stations.size ());
+  std::vector<Time> durations (m_stations.size (), m_minimumDuration);
+  for (uint32_t i = 0; i < m_stations.size (); i++)
+    {
+      if (totalDemand > 0)
+        {
+          durations[i] += NanoSeconds (available.GetNanoSeconds () * (double (demand[i]) / totalDemand));
+        }
+      else
+        {
+          durations[i] += NanoSeconds (available.GetNanoSeconds () / m_stations.size ());
+        }
+      durations[i] = std::min (durations[i], m_maximumDuration);
+      m_grantTrace (m_stations[i].srcAid, m_stations[i].dstAid, demand[i], durations[i]);
+    }
+  Allocate (durations, true);
+}
+
+void
+DmgDynamicAllocator::Allocate (const std::vector<Time> &durations, bool modify)
+{
+  uint32_t start = 0;
+  for (uint32_t i = 0; i < m_stations.size (); i++)
+    {
+      uint16_t duration = durations[i].GetMicroSeconds ();
+      if (modify)
+        {
+          m_apMac->ModifyAllocation (m_stations[i].allocationId, m_stations[i].srcAid, m_stations[i].dstAid, start, duration);
+        }
+      else
+        {
+          m_apMac->AllocateSingleContiguousBlock (m_stations[i].allocationId, SERVICE_PERIOD_ALLOCATION, true,
+                                                  m_stations[i].srcAid, m_stations[i].dstAid, start, duration);
+        }
+      start += duration + m_guardTime.GetMicroSeconds ();
+    }
+}
+
+} // namespace ns3
+
+#endif // DMG_DYNAMIC_ALLOCATION_H
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_FRAME_TEMPLATE_CACHE_H
+#define DMG_FRAME_TEMPLATE_CACHE_H
+
+#include "ns3/abort.h"
+#include "ns3/packet.h"
+#include "ns3/wifi-module.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *          DMG Beacon and SSW Frame Template Cache
+ ********************************************************/
+
+/**
+ * Byte offsets of the fields patched in the serialized frames (IEEE 802.11ad
+ * 8.3.1.16 and 8.3.4.1). The MAC header of both frames is Frame Control (2),
+ * Duration (2) and one (DMG Beacon) or two (SSW) addresses.
+ */
+static const uint32_t DMG_BEACON_TIMESTAMP_OFFSET = 10;   //!< Timestamp of the DMG Beacon.
+static const uint32_t DMG_BEACON_SSW_OFFSET = 18;         //!< SSW field of the DMG Beacon.
+static const uint32_t DMG_SSW_FRAME_SSW_OFFSET = 16;      //!< SSW field of the SSW frame.
+static const uint32_t DMG_FRAME_NO_FIELD = 0xFFFFFFFF;    //!< The template has no such field.
+
+/**
+ * Cache of serialized DMG frames that differ only in a few fields within a
+ * beacon interval: the DMG Beacons of the BTI sectors and the SSW/SSW-FBCK
+ * frames of a sector sweep. The first frame is serialized as usual and stored
+ * as a template; the following ones are created from the template bytes by
+ * patching the timestamp and the SSW field (direction, CDOWN, sector ID and
+ * DMG antenna ID).
+ *
+ * The templates must be dropped whenever the content of the frames changes.
+ * The Extended Schedule element of the DMG Beacon changes with the allocations
+ * (AddAllocationPeriod, ModifyAllocation, ...), which the PCP/AP and the
+ * schedulers of this folder change during the DTI. Install connects the cache
+ * to the DTIStarted trace of the MAC, so the templates are dropped once per
+ * beacon interval, after the BTI in which they were stored and before any
+ * allocation change can reach the next DMG Beacon. Invalidate must still be
+ * called for allocations changed during the BTI itself.
+ *
+ * A frame created from a template gets the packet and byte tags of the
+ * template, but not its header metadata. Hence, templates are refused when
+ * packet metadata is enabled (Packet::EnablePrinting), and the caller keeps
+ * serializing the frames as usual. The FCS carried by the ns-3 MAC trailer is
+ * not computed, hence it does not need to be updated.
+ */
+class DmgFrameTemplateCache
+{
+public:
+  DmgFrameTemplateCache ();
+
+  /**
+   * Drop the templates at the start of each DTI of a MAC.
+   * \param mac The MAC building the frames.
+   */
+  void Install (Ptr<DmgWifiMac> mac);
+  /**
+   * \param key The key of the template (e.g. the frame type and the peer).
+   * \return True if a template is stored for this key.
+   */
+  bool HasTemplate (uint32_t key) const;
+  /**
+   * Store a fully serialized frame as a template.
+   * \param key The key of the template.
+   * \param packet The frame including its MAC header.
+   * \param sswOffset The byte offset of the SSW field.
+   * \param timestampOffset The byte offset of the timestamp or DMG_FRAME_NO_FIELD.
+   * \return False if the packet carries header metadata, which the templates cannot reproduce.
+   */
+  bool StoreTemplate (uint32_t key, Ptr<const Packet> packet, uint32_t sswOffset,
+                      uint32_t timestampOffset = DMG_FRAME_NO_FIELD);
+  /**
+   * Create an SSW or SSW-FBCK frame from its template.
+   * \param key The key of the template.
+   * \param direction The direction bit (0 for the initiator, 1 for the responder).
+   * \param cdown The CDOWN field.
+   * \param sectorId The sector ID.
+   * \param antennaId The DMG antenna ID.
+   * \return The frame, or a null pointer if there is no template for this key.
+   */
+  Ptr<Packet> CreateFrame (uint32_t key, uint8_t direction, uint16_t cdown, uint8_t sectorId, uint8_t antennaId);
+  /**
+   * Create a DMG Beacon from its template.
+   * \param key The key of the template.
+   * \param timestamp The timestamp in microseconds.
+   * \param cdown The CDOWN field.
+   * \param sectorId The sector ID.
+   * \param antennaId The DMG antenna ID.
+   * \return The DMG Beacon, or a null pointer if there is no template for this key.
+   */
+  Ptr<Packet> CreateBeacon (uint32_t key, uint64_t timestamp, uint16_t cdown, uint8_t sectorId, uint8_t antennaId);
+  /**
+   * Drop all the templates.
+   */
+  void Invalidate (void);
+  /**
+   * \return The number of frames created from a template.
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \return The number of frames requested without a template.
+   */
+  uint64_t GetNMisses (void) const;
+  /**
+   * \return The number of templates stored.
+   */
+  uint64_t GetNStores (void) const;
+
+private:
+  struct FrameTemplate {
+    Ptr<const Packet> packet;     //!< The frame, for its tags.
+    std::vector<uint8_t> bytes;   //!< The serialized frame.
+    uint32_t sswOffset;           //!< Byte offset of the SSW field.
+    uint32_t timestampOffset;     //!< Byte offset of the timestamp.
+  };
+
+  /**
+   * Write the direction, CDOWN, sector ID and antenna ID subfields of the SSW
+   * field, keeping the RXSS length subfield.
+   */
+  void PatchSswField (uint8_t *field, uint8_t direction, uint16_t cdown, uint8_t sectorId, uint8_t antennaId);
+  /**
+   * Create a packet from the patched bytes, with the tags of the template.
+   */
+  Ptr<Packet> CreatePacket (const FrameTemplate &frame);
+  void DtiStarted (Mac48Address address, Time duration);
+
+  std::map<uint32_t, FrameTemplate> m_templates;  //!< Templates of the current beacon interval.
+  std::vector<uint8_t> m_buffer;                  //!< Scratch buffer used to patch the frames.
+  uint64_t m_hits;                                //!< Number of frames created from a template.
+  uint64_t m_misses;                              //!< Number of frames requested without a template.
+  uint64_t m_stores;                              //!< Number of templates stored.
+
+};
+
+DmgFrameTemplateCache::DmgFrameTemplateCache ()
+  : m_hits (0),
+    m_misses (0),
+    m_stores (0)
+{
+}
+
+void
+DmgFrameTemplateCache::Install (Ptr<DmgWifiMac> mac)
+{
+  mac->TraceConnectWithoutContext ("DTIStarted", MakeCallback (&DmgFrameTemplateCache::DtiStarted, this));
+}
+
+void
+DmgFrameTemplateCache::DtiStarted (Mac48Address, Time)
+{
+  Invalidate ();
+}
+
+bool
+DmgFrameTemplateCache::HasTemplate (uint32_t key) const
+{
+  return m_templates.find (key) != m_templates.end ();
+}
+
+bool
+DmgFrameTemplateCache::StoreTemplate (uint32_t key, Ptr<const Packet> packet, uint32_t sswOffset, uint32_t timestampOffset)
+{
+  if (packet->BeginItem ().HasNext ())
+    {
+      return false;
+    }
+  FrameTemplate frame;
+  frame.packet = packet->Copy ();
+  frame.bytes.resize (packet->GetSize ());
+  packet->CopyData (frame.bytes.data (), frame.bytes.size ());
+  NS_ABORT_MSG_IF (sswOffset + 3 > frame.bytes.size (), "The SSW field lies outside of the frame");
+  NS_ABORT_MSG_IF ((timestampOffset != DMG_FRAME_NO_FIELD) && (timestampOffset + 8 > frame.bytes.size ()),
+                   "The timestamp lies outside of the frame");
+  frame.sswOffset = sswOffset;
+  frame.timestampOffset = timestampOffset;
+  m_templates[key] = frame;
+  m_stores++;
+  return true;
+}
+
+void
+DmgFrameTemplateCache::PatchSswField (uint8_t *field, uint8_t direction, uint16_t cdown, uint8_t sectorId, uint8_t antennaId)
+{
+  /* B0: Direction, B1-B9: CDOWN, B10-B15: Sector ID, B16-B17: DMG Antenna ID, B18-B23: RXSS Length */
+  uint32_t ssw = field[0] | (field[1] << 8) | (field[2] << 16);
+  ssw &= 0xFC0000;
+  ssw |= (direction & 0x1);
+  ssw |= (cdown & 0x1FF) << 1;
+  ssw |= (sectorId & 0x3F) << 10;
+  ssw |= (antennaId & 0x3) << 16;
+  field[0] = ssw & 0xFF;
+  field[1] = (ssw >> 8) & 0xFF;
+  field[2] = (ssw >> 16) & 0xFF;
+}
+
+Ptr<Packet>
+DmgFrameTemplateCache::CreatePacket (const FrameTemplate &frame)
+{
+  Ptr<Packet> packet = Create<Packet> (m_buffer.data (), m_buffer.size ());
+  /* Restore the tags, as done by Packet::Print to access tags of unknown types */
+  PacketTagIterator packetTags = frame.packet->GetPacketTagIterator ();
+  while (packetTags.HasNext ())
+    {
+      PacketTagIterator::Item item = packetTags.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      packet->AddPacketTag (*tag);
+      delete tag;
+    }
+  ByteTagIterator byteTags = frame.packet->GetByteTagIterator ();
+  while (byteTags.HasNext ())
+    {
+      ByteTagIterator::Item item = byteTags.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      packet->AddByteTag (*tag, item.GetStart (), item.GetEnd ());
+      delete tag;
+    }
+  return packet;
+}
+
+Ptr<Packet>
+DmgFrameTemplateCache::CreateFrame (uint32_t key, uint8_t direction, uint16_t cdown, uint8_t sectorId, uint8_t antennaId)
+{
+  std::map<uint32_t, FrameTemplate>::const_iterator it = m_templates.find (key);
+  if (it == m_templates.end ())
+    {
+      m_misses++;
+      return 0;
+    }
+  m_buffer = it->second.bytes;
+  PatchSswField (m_buffer.data () + it->second.sswOffset, direction, cdown, sectorId, antennaId);
+  m_hits++;
+  return CreatePacket (it->second);
+}
+
+Ptr<Packet>
+DmgFrameTemplateCache::CreateBeacon (uint32_t key, uint64_t timestamp, uint16_t cdown, uint8_t sectorId, uint8_t antennaId)
+{
+  std::map<uint32_t, FrameTemplate>::const_iterator it = m_templates.find (key);
+  if (it == m_templates.end ())
+    {
+      m_misses++;
+      return 0;
+    }
+  NS_ABORT_MSG_IF (it->second.timestampOffset == DMG_FRAME_NO_FIELD, "The frame template has no timestamp");
+  m_buffer = it->second.bytes;
+  /* Little endian as written by Buffer::Iterator::WriteHtolsbU64 */
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      m_buffer[it->second.timestampOffset + i] = (timestamp >> (8 * i)) & 0xFF;
+    }
+  /* The DMG Beacon is always transmitted by the initiator */
+  PatchSswField (m_buffer.data () + it->second.sswOffset, 0, cdown, sectorId, antennaId);
+  m_hits++;
+  return CreatePacket (it->second);
+}
+
+void
+DmgFrameTemplateCache::Invalidate (void)
+{
+  m_templates.clear ();
+}
+
+uint64_t
+DmgFrameTemplateCache::GetNHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+DmgFrameTemplateCache::GetNMisses (void) const
+{
+  return m_misses;
+}
+
+uint64_t
+DmgFrameTemplateCache::GetNStores (void) const
+{
+  return m_stores;
+}
+
+} // namespace ns3
+
+#endif // DMG_FRAME_TEMPLATE_CACHE_H
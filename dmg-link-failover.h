@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_LINK_FAILOVER_H
+#define DMG_LINK_FAILOVER_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+namespace ns3 {
+
+/********************************************************
+ *                  DMG Link Failover
+ ********************************************************/
+
+/**
+ * Failure detection of the DMG link towards a peer and the host route steering
+ * the traffic around it, shared by the fast session transfer and the link
+ * switching relay. The link fails when threshold consecutive MSDUs to the peer
+ * are dropped after exhausting their retries; an MSDU acknowledged by the peer
+ * resets the count. The host route is added to the static routing protocol,
+ * which takes precedence over the global routing protocol in the default list
+ * routing.
+ */
+class DmgLinkFailover
+{
+public:
+  DmgLinkFailover ();
+
+  /**
+   * Monitor the MSDUs sent to the peer over the DMG interface.
+   * \param device The DMG interface.
+   * \param peer The MAC address of the peer.
+   * \param threshold The number of consecutive dropped MSDUs after which the link has failed.
+   * \param linkFailed Callback invoked once the link has failed.
+   */
+  void Setup (Ptr<WifiNetDevice> device, Mac48Address peer, uint32_t threshold, Callback<void> linkFailed);
+  /**
+   * Set the host route used to steer the traffic around the DMG link.
+   * \param destination The destination of the host route.
+   * \param nextHop The next hop towards the destination.
+   * \param device The outgoing interface, on the same node as the DMG interface.
+   */
+  void SetHostRoute (Ipv4Address destination, Ipv4Address nextHop, Ptr<NetDevice> device);
+  /**
+   * Start or stop counting the dropped MSDUs, the count restarts from zero.
+   * \param enable True to detect failures of the DMG link.
+   */
+  void SetMonitoring (bool enable);
+  /**
+   * Install the host route in the static routing protocol of the node.
+   */
+  void AddHostRoute (void);
+  /**
+   * Remove the host route from the static routing protocol of the node.
+   */
+  void RemoveHostRoute (void);
+  /**
+   * Release the interface and the routing protocol of the node.
+   */
+  void Dispose (void);
+
+private:
+  void TxFailed (Mac48Address address);
+  void TxOk (const WifiMacHeader &hdr);
+
+  Ptr<WifiNetDevice> m_device;                  //!< DMG interface.
+  Mac48Address m_peer;                          //!< MAC address of the peer.
+  uint32_t m_threshold;                         //!< Consecutive dropped MSDUs before the link fails.
+  Callback<void> m_linkFailed;                  //!< Callback invoked when the link fails.
+  bool m_monitoring;                            //!< Flag to indicate if the dropped MSDUs are counted.
+  uint32_t m_failures;                          //!< Consecutive dropped MSDUs to the peer.
+  Ptr<Ipv4StaticRouting> m_staticRouting;       //!< Static routing protocol of the node.
+  Ipv4Address m_destination;                    //!< Destination of the host route.
+  Ipv4Address m_nextHop;                        //!< Next hop of the host route.
+  uint32_t m_interface;                         //!< IPv4 interface index of the host route.
+
+};
+
+DmgLinkFailover::DmgLinkFailover ()
+  : m_threshold (1),
+    m_monitoring (true),
+    m_failures (0),
+    m_interface (0)
+{
+}
+
+void
+DmgLinkFailover::Setup (Ptr<WifiNetDevice> device, Mac48Address peer, uint32_t threshold, Callback<void> linkFailed)
+{
+  m_device = device;
+  m_peer = peer;
+  m_threshold = threshold;
+  m_linkFailed = linkFailed;
+
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  NS_ABORT_MSG_IF (ipv4 == 0, "The Internet stack must be installed before the DMG link failover");
+  Ipv4StaticRoutingHelper staticRoutingHelper;
+  m_staticRouting = staticRoutingHelper.GetStaticRouting (ipv4);
+  NS_ABORT_MSG_IF (m_staticRouting == 0, "No static routing protocol on the node");
+
+  device->GetRemoteStationManager ()->TraceConnectWithoutContext ("MacTxFinalDataFailed",
+                                                                  MakeCallback (&DmgLinkFailover::TxFailed, this));
+  device->GetMac ()->TraceConnectWithoutContext ("TxOkHeader", MakeCallback (&DmgLinkFailover::TxOk, this));
+}
+
+void
+DmgLinkFailover::SetHostRoute (Ipv4Address destination, Ipv4Address nextHop, Ptr<NetDevice> device)
+{
+  NS_ABORT_MSG_IF (m_device == 0, "The DMG link failover must be setup before its host route");
+  NS_ABORT_MSG_IF (device->GetNode () != m_device->GetNode (), "Both interfaces must belong to the same node");
+  int32_t interface = device->GetNode ()->GetObject<Ipv4> ()->GetInterfaceForDevice (device);
+  NS_ABORT_MSG_IF (interface < 0, "The outgoing device of the host route has no IPv4 interface");
+  m_destination = destination;
+  m_nextHop = nextHop;
+  m_interface = interface;
+}
+
+void
+DmgLinkFailover::SetMonitoring (bool enable)
+{
+  m_monitoring = enable;
+  m_failures = 0;
+}
+
+void
+DmgLinkFailover::AddHostRoute (void)
+{
+  m_staticRouting->AddHostRouteTo (m_destination, m_nextHop, m_interface, 0);
+}
+
+void
+DmgLinkFailover::RemoveHostRoute (void)
+{
+  for (uint32_t i = 0; i < m_staticRouting->GetNRoutes (); i++)
+    {
+      Ipv4RoutingTableEntry route = m_staticRouting->GetRoute (i);
+      if (route.IsHost () && (route.GetDest () == m_destination)
+          && (route.GetGateway () == m_nextHop) && (route.GetInterface () == m_interface))
+        {
+          m_staticRouting->RemoveRoute (i);
+          break;
+        }
+    }
+}
+
+void
+DmgLinkFailover::Dispose (void)
+{
+  m_device = 0;
+  m_staticRouting = 0;
+  m_linkFailed = MakeNullCallback<void> ();
+}
+
+void
+DmgLinkFailover::TxFailed (Mac48Address address)
+{
+  if (!m_monitoring || (address != m_peer))
+    {
+      return;
+    }
+  m_failures++;
+  if (m_failures >= m_threshold)
+    {
+      m_failures = 0;
+      m_linkFailed ();
+    }
+}
+
+void
+DmgLinkFailover::TxOk (const WifiMacHeader &hdr)
+{
+  /* The DMG link still delivers MSDUs, so the failures are not consecutive */
+  if (hdr.IsData () && (hdr.GetAddr1 () == m_peer))
+    {
+      m_failures = 0;
+    }
+}
+
+} // namespace ns3
+
+#endif // DMG_LINK_FAILOVER_H
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_RELAY_LINK_SWITCHING_H
+#define DMG_RELAY_LINK_SWITCHING_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "dmg-link-failover.h"
+
+namespace ns3 {
+
+/********************************************************
+ *              DMG Link Switching Relay
+ ********************************************************/
+
+/**
+ * Link switching relay operation (IEEE 802.11ad 10.35) for the source of a
+ * DMG link. While the direct link works, the frames go straight to the
+ * destination. When FailureThreshold consecutive MSDUs towards the destination
+ * are dropped, with an MSDU acknowledged by the destination resetting the
+ * count, the source switches to the relay path by installing a host
+ * route towards the destination through the relay. After RetryInterval on the
+ * relay path, the source tentatively switches back to the direct link, which
+ * is how the link is re-evaluated; a blocked direct link sends it back to the
+ * relay after FailureThreshold dropped MSDUs.
+ *
+ * The relay is a regular node that forwards at the IP layer. The antenna
+ * configuration of the source, the destination and the relay is updated by
+ * the scenario through the PathSwitch trace. The failure detection and the
+ * host route are handled by DmgLinkFailover.
+ */
+class DmgRelayLinkSwitching : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DmgRelayLinkSwitching ();
+  virtual ~DmgRelayLinkSwitching ();
+
+  /**
+   * Setup the relay operation of the source.
+   * \param device The DMG interface of the source.
+   * \param dstAddress The MAC address of the destination.
+   * \param dstIp The IP address of the destination.
+   * \param relayIp The IP address of the relay interface facing the source.
+   */
+  void Setup (Ptr<WifiNetDevice> device, Mac48Address dstAddress, Ipv4Address dstIp, Ipv4Address relayIp);
+  /**
+   * \return True if the traffic goes through the relay.
+   */
+  bool IsRelayed (void) const;
+  /**
+   * \return The number of path switches so far.
+   */
+  uint32_t GetNSwitches (void) const;
+
+  /**
+   * TracedCallback signature for path switches.
+   * \param relayed True if the traffic goes through the relay, false for the direct link.
+   */
+  typedef void (* PathSwitchCallback)(bool relayed);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void SwitchToRelay (void);
+  void SwitchToDirect (void);
+
+  uint32_t m_failureThreshold;                  //!< Consecutive dropped MSDUs before switching to the relay.
+  Time m_retryInterval;                         //!< Time on the relay path before re-evaluating the direct link.
+  Ptr<WifiNetDevice> m_device;                  //!< DMG interface of the source.
+  DmgLinkFailover m_failover;                   //!< Failure detection of the direct link and relay host route.
+  bool m_relayed;                               //!< Flag to indicate if the traffic goes through the relay.
+  uint32_t m_switches;                          //!< Number of path switches.
+  EventId m_retryEvent;                         //!< Re-evaluation of the direct link.
+  TracedCallback<bool> m_pathSwitch;            //!< Trace fired upon a path switch.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DmgRelayLinkSwitching);
+
+TypeId
+DmgRelayLinkSwitching::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DmgRelayLinkSwitching")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<DmgRelayLinkSwitching> ()
+    .AddAttribute ("FailureThreshold", "The number of consecutive MSDUs dropped on the direct link "
+                   "before switching to the relay path.",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&DmgRelayLinkSwitching::m_failureThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RetryInterval", "The time spent on the relay path before re-evaluating the direct link.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&DmgRelayLinkSwitching::m_retryInterval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("PathSwitch", "The traffic has been switched to another path.",
+                     MakeTraceSourceAccessor (&DmgRelayLinkSwitching::m_pathSwitch),
+                     "ns3::DmgRelayLinkSwitching::PathSwitchCallback")
+  ;
+  return tid;
+}
+
+DmgRelayLinkSwitching::DmgRelayLinkSwitching ()
+  : m_relayed (false),
+    m_switches (0)
+{
+}
+
+DmgRelayLinkSwitching::~DmgRelayLinkSwitching ()
+{
+}
+
+void
+DmgRelayLinkSwitching::DoDispose (void)
+{
+  m_retryEvent.Cancel ();
+  m_device = 0;
+  m_failover.Dispose ();
+  Object::DoDispose ();
+}
+
+void
+DmgRelayLinkSwitching::Setup (Ptr<WifiNetDevice> device, Mac48Address dstAddress, Ipv4Address dstIp, Ipv4Address relayIp)
+{
+  m_device = device;
+  m_failover.Setup (device, dstAddress, m_failureThreshold, MakeCallback (&DmgRelayLinkSwitching::SwitchToRelay, this));
+  m_failover.SetHostRoute (dstIp, relayIp, device);
+}
+
+bool
+DmgRelayLinkSwitching::IsRelayed (void) const
+{
+  return m_relayed;
+}
+
+uint32_t
+DmgRelayLinkSwitching::GetNSwitches (void) const
+{
+  return m_switches;
+}
+
+void
+DmgRelayLinkSwitching::SwitchToRelay (void)
+{
+  m_failover.AddHostRoute ();
+  m_failover.SetMonitoring (false);
+  m_relayed = true;
+  m_switches++;
+  m_pathSwitch (true);
+  m_retryEvent = Simulator::Schedule (m_retryInterval, &DmgRelayLinkSwitching::SwitchToDirect, this);
+}
+
+void
+DmgRelayLinkSwitching::SwitchToDirect (void)
+{
+  m_failover.RemoveHostRoute ();
+  m_failover.SetMonitoring (true);
+  m_relayed = false;
+  m_switches++;
+  m_pathSwitch (false);
+}
+
+} // namespace ns3
+
+#endif // DMG_RELAY_LINK_SWITCHING_H
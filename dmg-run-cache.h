@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_RUN_CACHE_H
+#define DMG_RUN_CACHE_H
+
+#include "ns3/core-module.h"
+#include <sys/stat.h>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Content-Addressed Run Cache
+ ********************************************************/
+
+/**
+ * Stream buffer writing every character to two other stream buffers. It is
+ * used to record the standard output of a run while still printing it.
+ */
+class TeeStreamBuffer : public std::streambuf
+{
+public:
+  TeeStreamBuffer (std::streambuf *first, std::streambuf *second)
+    : m_first (first),
+      m_second (second)
+  {
+  }
+
+protected:
+  virtual int overflow (int c)
+  {
+    if (traits_type::eq_int_type (c, traits_type::eof ()))
+      {
+        return traits_type::not_eof (c);
+      }
+    int_type r1 = m_first->sputc (traits_type::to_char_type (c));
+    int_type r2 = m_second->sputc (traits_type::to_char_type (c));
+    if (traits_type::eq_int_type (r1, traits_type::eof ()) || traits_type::eq_int_type (r2, traits_type::eof ()))
+      {
+        return traits_type::eof ();
+      }
+    return c;
+  }
+  virtual int sync (void)
+  {
+    int r1 = m_first->pubsync ();
+    int r2 = m_second->pubsync ();
+    return ((r1 == 0) && (r2 == 0)) ? 0 : -1;
+  }
+
+private:
+  std::streambuf *m_first;
+  std::streambuf *m_second;
+
+};
+
+/**
+ * Cache of whole simulation runs. A run is identified by the FNV-1a hash of:
+ * - the command line arguments,
+ * - the initial value of every attribute of every registered TypeId, which
+ *   covers all the Config::SetDefault calls of the script,
+ * - the value of every GlobalValue (e.g. RngSeed and RngRun), which may be set
+ *   through NS_GLOBAL_VALUE or GlobalValue::Bind without showing in the arguments,
+ * - the content of every input asset (Q-D files, codebooks, error model tables),
+ * - a code version, by default the hash of the build: the executable of the
+ *   script and the ns-3 libraries it loaded, read through /proc/self. Any
+ *   change of the script, of the headers it includes or of ns-3 followed by a
+ *   rebuild gives a new version, whereas the build time of the script would
+ *   miss changes in ns-3 and in the headers. On systems without /proc, a
+ *   version must be given explicitly, e.g. the git revision of the tree.
+ *
+ * The key only depends on the command line and the code, so the script looks
+ * it up right after parsing its arguments, before building the topology. When
+ * a completed entry with the same key exists, Lookup restores its output files,
+ * replays its standard output and the script can exit without any setup.
+ * Otherwise the script calls Start and Store once all its results are written. An entry is only valid once its metadata
+ * file has been written, so an interrupted run never produces a hit.
+ */
+class DmgRunCache
+{
+public:
+  /**
+   * Create a run cache.
+   * \param folder The folder where the entries are stored.
+   * \param version The code version, entries of other versions are ignored. By default, the hash of the build,
+   * computed on first use of the key.
+   */
+  DmgRunCache (std::string folder, std::string version = "");
+  ~DmgRunCache ();
+
+  /**
+   * Add the command line arguments to the key.
+   * \param argc The number of arguments.
+   * \param argv The arguments.
+   */
+  void AddArguments (int argc, char *argv[]);
+  /**
+   * Add the initial value of all the attributes and the value of all the global values to the key.
+   */
+  void AddConfigDefaults (void);
+  /**
+   * Add the content of an input file, or of all the files below a folder, to the key.
+   * \param path The path of the file or the folder.
+   */
+  void AddAsset (std::string path);
+  /**
+   * Register an output file of the run.
+   * \param fileName The name of the output file.
+   */
+  void AddOutput (std::string fileName);
+  /**
+   * Look for a completed entry and restore it.
+   * \return True if the entry exists, in which case its outputs have been restored.
+   */
+  bool Lookup (void);
+  /**
+   * Start recording the standard output of the run.
+   */
+  void Start (void);
+  /**
+   * Stop recording and store the outputs of the run.
+   */
+  void Store (void);
+  /**
+   * \return The key of the run as an hexadecimal string.
+   */
+  std::string GetKey (void) const;
+  /**
+   * \return The code version.
+   */
+  const std::string &GetVersion (void) const;
+
+private:
+  void Hash (const std::string &data);
+  /**
+   * \param hash The current FNV-1a hash.
+   * \param data The data to add to the hash.
+   * \param size The size of the data.
+   * \return The FNV-1a hash updated with the data.
+   */
+  static uint64_t Fnv1a (uint64_t hash, const char *data, size_t size);
+  /**
+   * \return The hash of the executable and of the ns-3 libraries loaded by the process.
+   */
+  static std::string GetBuildVersion (void);
+  static bool CopyFile (std::string from, std::string to);
+  std::string GetEntryFolder (void) const;
+
+  std::string m_folder;                 //!< Cache folder.
+  mutable std::string m_version;        //!< Code version, resolved on first use.
+  uint64_t m_hash;                      //!< FNV-1a hash of the run.
+  std::string m_arguments;              //!< Command line, for the metadata.
+  std::list<std::string> m_outputs;     //!< Output files of the run.
+  uint32_t m_assets;                    //!< Number of hashed asset files.
+  std::ofstream m_stdout;               //!< Recorded standard output.
+  std::streambuf *m_coutBuffer;         //!< Original buffer of std::cout.
+  TeeStreamBuffer *m_tee;               //!< Buffer writing to the console and the record.
+
+};
+
+DmgRunCache::DmgRunCache (std::string folder, std::string version)
+  : m_folder (folder),
+    m_version (version),
+    m_hash (14695981039346656037ULL),
+    m_assets (0),
+    m_coutBuffer (0),
+    m_tee (0)
+{
+  if (m_folder.back () != '/')
+    {
+      m_folder += '/';
+    }
+}
+
+DmgRunCache::~DmgRunCache ()
+{
+  if (m_tee)
+    {
+      std::cout.rdbuf (m_coutBuffer);
+      delete m_tee;
+    }
+}
+
+uint64_t
+DmgRunCache::Fnv1a (uint64_t hash, const char *data, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      hash ^= static_cast<uint8_t> (data[i]);
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+void
+DmgRunCache::Hash (const std::string &data)
+{
+  m_hash = Fnv1a (m_hash, data.data (), data.size ());
+  /* Separator, so that ("ab", "c") and ("a", "bc") differ */
+  m_hash ^= 0xff;
+  m_hash *= 1099511628211ULL;
+}
+
+std::string
+DmgRunCache::GetBuildVersion (void)
+{
+  /* The executable holds the script, the shared libraries named libns3* hold the ns-3 build */
+  std::list<std::string> binaries;
+  std::ifstream maps ("/proc/self/maps");
+  std::string line;
+  while (std::getline (maps, line))
+    {
+      std::string::size_type path = line.find ('/');
+      if ((path != std::string::npos) && (line.find ("libns3", path) != std::string::npos))
+        {
+          binaries.push_back (line.substr (path));
+        }
+    }
+  binaries.sort ();
+  binaries.unique ();
+  binaries.push_front ("/proc/self/exe");
+
+  uint64_t hash = 14695981039346656037ULL;
+  std::vector<char> buffer (1 << 16);
+  for (std::list<std::string>::const_iterator it = binaries.begin (); it != binaries.end (); it++)
+    {
+      std::ifstream file (it->c_str (), std::ios::binary);
+      NS_ABORT_MSG_IF (!file.is_open (), "Cannot hash " << *it << ", give the run cache an explicit version");
+      while (file.read (buffer.data (), buffer.size ()) || (file.gcount () > 0))
+        {
+          hash = Fnv1a (hash, buffer.data (), file.gcount ());
+        }
+    }
+  std::ostringstream version;
+  version << "build-" << std::hex << std::setfill ('0') << std::setw (16) << hash;
+  return version.str ();
+}
+
+void
+DmgRunCache::AddArguments (int argc, char *argv[])
+{
+  /* Skip the program path, only the arguments identify the run */
+  for (int i = 1; i < argc; i++)
+    {
+      Hash (argv[i]);
+      m_arguments += std::string (argv[i]) + " ";
+    }
+}
+
+void
+DmgRunCache::AddConfigDefaults (void)
+{
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (j);
+          Hash (tid.GetName () + "::" + info.name + "=" + info.initialValue->SerializeToString (info.checker));
+        }
+    }
+  for (GlobalValue::Iterator it = GlobalValue::Begin (); it != GlobalValue::End (); it++)
+    {
+      StringValue value;
+      (*it)->GetValue (value);
+      Hash ((*it)->GetName () + "=" + value.Get ());
+    }
+}
+
+void
+DmgRunCache::AddAsset (std::string path)
+{
+  struct stat info;
+  NS_ABORT_MSG_IF (stat (path.c_str (), &info) != 0, "Cannot find asset " << path);
+  if (S_ISDIR (info.st_mode))
+    {
+      if (path.back () != '/')
+        {
+          path += '/';
+        }
+      /* Sort the entries, the key must not depend on the order of the directory listing */
+      std::list<std::string> files = SystemPath::ReadFiles (path);
+      files.sort ();
+      for (std::list<std::string>::const_iterator it = files.begin (); it != files.end (); it++)
+        {
+          if ((*it != ".") && (*it != ".."))
+            {
+              AddAsset (path + *it);
+            }
+        }
+    }
+  else
+    {
+      std::ifstream file (path.c_str (), std::ios::binary);
+      NS_ABORT_MSG_IF (!file.is_open (), "Cannot open asset " << path);
+      std::ostringstream content;
+      content << file.rdbuf ();
+      Hash (path);
+      Hash (content.str ());
+      m_assets++;
+    }
+}
+
+void
+DmgRunCache::AddOutput (std::string fileName)
+{
+  m_outputs.push_back (fileName);
+}
+
+const std::string &
+DmgRunCache::GetVersion (void) const
+{
+  if (m_version.empty ())
+    {
+      m_version = GetBuildVersion ();
+    }
+  return m_version;
+}
+
+std::string
+DmgRunCache::GetKey (void) const
+{
+  const std::string &version = GetVersion ();
+  std::ostringstream key;
+  key << std::hex << std::setfill ('0') << std::setw (16) << Fnv1a (m_hash, version.data (), version.size ());
+  return key.str ();
+}
+
+std::string
+DmgRunCache::GetEntryFolder (void) const
+{
+  return m_folder + GetKey () + "/";
+}
+
+bool
+DmgRunCache::CopyFile (std::string from, std::string to)
+{
+  std::ifstream source (from.c_str (), std::ios::binary);
+  if (!source.is_open ())
+    {
+      return false;
+    }
+  std::ofstream destination (to.c_str (), std::ios::binary);
+  destination << source.rdbuf ();
+  return destination.good ();
+}
+
+bool
+DmgRunCache::Lookup (void)
+{
+  std::string entry = GetEntryFolder ();
+  std::ifstream metadata ((entry + "metadata.txt").c_str ());
+  if (!metadata.is_open ())
+    {
+      return false;
+    }
+  std::string line;
+  std::getline (metadata, line);
+  if (line != "VERSION=" + GetVersion ())
+    {
+      return false;
+    }
+  uint32_t i = 0;
+  for (std::list<std::string>::const_iterator it = m_outputs.begin (); it != m_outputs.end (); it++, i++)
+    {
+      if (!CopyFile (entry + "output" + std::to_string (i), *it))
+        {
+          return false;
+        }
+    }
+  std::ifstream record ((entry + "stdout.txt").c_str ());
+  std::cout << record.rdbuf ();
+  std::cout.flush ();
+  return true;
+}
+
+void
+DmgRunCache::Start (void)
+{
+  SystemPath::MakeDirectories (GetEntryFolder ());
+  /* Invalidate a previous entry with the same key until this run completes */
+  std::remove ((GetEntryFolder () + "metadata.txt").c_str ());
+  m_stdout.open ((GetEntryFolder () + "stdout.txt").c_str ());
+  m_coutBuffer = std::cout.rdbuf ();
+  m_tee = new TeeStreamBuffer (m_coutBuffer, m_stdout.rdbuf ());
+  std::cout.rdbuf (m_tee);
+}
+
+void
+DmgRunCache::Store (void)
+{
+  NS_ABORT_MSG_IF (!m_tee, "The run cache has not been started");
+  std::cout.flush ();
+  std::cout.rdbuf (m_coutBuffer);
+  delete m_tee;
+  m_tee = 0;
+  m_stdout.close ();
+
+  std::string entry = GetEntryFolder ();
+  uint32_t i = 0;
+  for (std::list<std::string>::const_iterator it = m_outputs.begin (); it != m_outputs.end (); it++, i++)
+    {
+      NS_ABORT_MSG_IF (!CopyFile (*it, entry + "output" + std::to_string (i)), "Cannot store output " << *it);
+    }
+
+  /* The metadata is written last and marks the entry as complete */
+  std::ofstream metadata ((entry + "metadata.txt").c_str ());
+  metadata << "VERSION=" << GetVersion () << std::endl;
+  metadata << "ARGUMENTS=" << m_arguments << std::endl;
+  metadata << "ASSETS=" << m_assets << std::endl;
+  metadata << "CREATED=" << std::time (0) << std::endl;
+  for (std::list<std::string>::const_iterator it = m_outputs.begin (); it != m_outputs.end (); it++)
+    {
+      metadata << "OUTPUT=" << *it << std::endl;
+    }
+}
+
+} // namespace ns3
+
+#endif // DMG_RUN_CACHE_H
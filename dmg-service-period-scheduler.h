@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_SERVICE_PERIOD_SCHEDULER_H
+#define DMG_SERVICE_PERIOD_SCHEDULER_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include <map>
+
+namespace ns3 {
+
+/********************************************************
+ *              Service Period Scheduler
+ ********************************************************/
+
+/**
+ * Base class of the schedulers which map the DTI of a DMG PCP/AP onto static
+ * service periods. The scheduler learns the DTI duration from the DTIStarted
+ * trace of the PCP/AP; Start makes the allocations through DoStart once the
+ * DTI duration is known, and DoDataTransmissionIntervalStarted is notified at
+ * the start of every following DTI.
+ *
+ * An allocation is identified by its allocation ID together with its source
+ * and destination AIDs, so GetNextAllocationId numbers the 4-bit allocation
+ * IDs per pair of AIDs, up to MAX_ALLOCATION_ID allocations per pair.
+ */
+class DmgServicePeriodScheduler : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DmgServicePeriodScheduler ();
+  virtual ~DmgServicePeriodScheduler ();
+
+  /**
+   * Setup the scheduler of a DMG PCP/AP.
+   * \param apMac The MAC of the DMG PCP/AP.
+   */
+  void Setup (Ptr<DmgApWifiMac> apMac);
+  /**
+   * Allocate the SPs over the DTI of the following beacon intervals.
+   * The DTI duration is learnt from the DTIStarted trace of the PCP/AP.
+   */
+  void Start (void);
+  /**
+   * \return True if the SPs have been allocated.
+   */
+  bool IsStarted (void) const;
+
+  static const uint8_t MAX_ALLOCATION_ID = 15;  //!< Largest value of the 4-bit AllocationID field.
+
+protected:
+  virtual void DoDispose (void);
+  /**
+   * Make the allocations, the DTI duration is known.
+   */
+  virtual void DoStart (void) = 0;
+  /**
+   * Notify the start of a DTI once the allocations have been made.
+   * \param duration The duration of the DTI.
+   */
+  virtual void DoDataTransmissionIntervalStarted (Time duration);
+  /**
+   * \param srcAid The AID of the source STA.
+   * \param dstAid The AID of the destination STA.
+   * \return A new allocation ID for an allocation between the two STAs.
+   */
+  uint8_t GetNextAllocationId (uint8_t srcAid, uint8_t dstAid);
+
+  Time m_guardTime;                     //!< Guard time between two SPs.
+  Ptr<DmgApWifiMac> m_apMac;            //!< MAC of the DMG PCP/AP.
+  Time m_dtiDuration;                   //!< Last DTI duration.
+
+private:
+  void DataTransmissionIntervalStarted (Mac48Address address, Time duration);
+
+  bool m_started;                       //!< Whether the SPs have been allocated.
+  std::map<std::pair<uint8_t, uint8_t>, uint8_t> m_allocationIds; //!< Last allocation ID of each pair of AIDs.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DmgServicePeriodScheduler);
+
+TypeId
+DmgServicePeriodScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DmgServicePeriodScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddAttribute ("GuardTime", "The guard time between two SPs.",
+                   TimeValue (MicroSeconds (5)),
+                   MakeTimeAccessor (&DmgServicePeriodScheduler::m_guardTime),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+DmgServicePeriodScheduler::DmgServicePeriodScheduler ()
+  : m_started (false)
+{
+}
+
+DmgServicePeriodScheduler::~DmgServicePeriodScheduler ()
+{
+}
+
+void
+DmgServicePeriodScheduler::DoDispose (void)
+{
+  m_apMac = 0;
+  Object::DoDispose ();
+}
+
+void
+DmgServicePeriodScheduler::Setup (Ptr<DmgApWifiMac> apMac)
+{
+  m_apMac = apMac;
+  m_apMac->TraceConnectWithoutContext ("DTIStarted",
+                                       MakeCallback (&DmgServicePeriodScheduler::DataTransmissionIntervalStarted, this));
+}
+
+void
+DmgServicePeriodScheduler::Start (void)
+{
+  NS_ABORT_MSG_IF (m_started, "The SPs have already been allocated");
+  NS_ABORT_MSG_IF (m_dtiDuration.IsZero (), "The DTI duration is not known yet");
+  DoStart ();
+  m_started = true;
+}
+
+bool
+DmgServicePeriodScheduler::IsStarted (void) const
+{
+  return m_started;
+}
+
+void
+DmgServicePeriodScheduler::DataTransmissionIntervalStarted (Mac48Address address, Time duration)
+{
+  m_dtiDuration = duration;
+  if (m_started)
+    {
+      DoDataTransmissionIntervalStarted (duration);
+    }
+}
+
+void
+DmgServicePeriodScheduler::DoDataTransmissionIntervalStarted (Time duration)
+{
+}
+
+uint8_t
+DmgServicePeriodScheduler::GetNextAllocationId (uint8_t srcAid, uint8_t dstAid)
+{
+  uint8_t id = ++m_allocationIds[std::make_pair (srcAid, dstAid)];
+  NS_ABORT_MSG_IF (id > MAX_ALLOCATION_ID, "More than " << uint16_t (MAX_ALLOCATION_ID) << " allocations from AID "
+                   << uint16_t (srcAid) << " to AID " << uint16_t (dstAid));
+  return id;
+}
+
+} // namespace ns3
+
+#endif // DMG_SERVICE_PERIOD_SCHEDULER_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_SIMULATION_STATISTICS_H
+#define DMG_SIMULATION_STATISTICS_H
+
+#include "ns3/core-module.h"
+#include "common-functions.h"
+#include <chrono>
+#include <iostream>
+
+namespace ns3 {
+
+/********************************************************
+ *              Simulation Statistics
+ ********************************************************/
+
+/**
+ * Cost of a simulation run.
+ */
+struct SimulationCost {
+  double wallTime;            //!< Wall-clock time spent in Simulator::Run in seconds.
+  uint64_t events;            //!< Number of events executed by the simulator.
+};
+
+/**
+ * Run the simulation and measure its cost. Must be called before Simulator::Destroy.
+ * \return The wall-clock time and the number of events of the run.
+ */
+SimulationCost
+RunSimulation (void)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  std::chrono::duration<double> wallTime = std::chrono::steady_clock::now () - start;
+  SimulationCost cost;
+  cost.wallTime = wallTime.count ();
+  cost.events = Simulator::GetEventCount ();
+  return cost;
+}
+
+/**
+ * Print the cost of a simulation run.
+ * \param os The output stream.
+ * \param cost The cost returned by RunSimulation.
+ */
+void
+PrintSimulationCost (std::ostream &os, const SimulationCost &cost)
+{
+  os << "  Wall-clock Time [s] = " << cost.wallTime << std::endl;
+  os << "  Simulator Events = " << cost.events << std::endl;
+}
+
+/**
+ * Sum the throughput of all the communication pairs, each one averaged from
+ * the start of its application.
+ * \param communicationPairList The communication pairs.
+ * \param endTime The time in seconds at which the measurement ends.
+ * \return The aggregate throughput in Mbps.
+ */
+double
+CalculateAggregateThroughput (const CommunicationPairList &communicationPairList, double endTime)
+{
+  double aggregateThroughput = 0;
+  for (CommunicationPairList_CI it = communicationPairList.begin (); it != communicationPairList.end (); it++)
+    {
+      aggregateThroughput += it->second.packetSink->GetTotalRx () * 8.0
+                           / ((endTime - it->second.startTime.GetSeconds ()) * 1e6);
+    }
+  return aggregateThroughput;
+}
+
+} // namespace ns3
+
+#endif // DMG_SIMULATION_STATISTICS_H
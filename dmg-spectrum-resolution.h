@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_SPECTRUM_RESOLUTION_H
+#define DMG_SPECTRUM_RESOLUTION_H
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-model.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/wifi-phy.h"
+#include <map>
+#include <tuple>
+
+namespace ns3 {
+
+/********************************************************
+ *          DMG/EDMG Spectral Resolution Helpers
+ ********************************************************/
+
+/**
+ * Width of a single DMG channel in Hz. EDMG bonded channels span 2, 3 or 4 of them.
+ */
+static const double DMG_CHANNEL_WIDTH = 2.16e9;
+
+/**
+ * Create (or retrieve) a spectrum model covering a DMG/EDMG channel with a
+ * configurable number of bins per 2.16 GHz channel. The bins are uniformly
+ * spaced over the whole bonded channel. Models are cached so that all the
+ * PHYs using the same configuration share a single instance, which is
+ * required by SpectrumValue operations.
+ * \param centerFrequency The center frequency of the (bonded) channel in Hz.
+ * \param channels The number of bonded 2.16 GHz channels (1 to 4).
+ * \param binsPerChannel The number of bins per 2.16 GHz channel.
+ * \return The spectrum model.
+ */
+Ptr<SpectrumModel>
+GetDmgSpectrumModel (double centerFrequency, uint8_t channels, uint32_t binsPerChannel)
+{
+  NS_ABORT_MSG_IF ((channels < 1) || (channels > 4), "IEEE 802.11ay supports bonding of up to 4 channels");
+  NS_ABORT_MSG_IF (binsPerChannel == 0, "At least one bin per channel is required");
+  typedef std::tuple<double, uint8_t, uint32_t> ModelKey;
+  static std::map<ModelKey, Ptr<SpectrumModel> > models;
+  ModelKey key (centerFrequency, channels, binsPerChannel);
+  std::map<ModelKey, Ptr<SpectrumModel> >::const_iterator it = models.find (key);
+  if (it != models.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t numBins = channels * binsPerChannel;
+  double width = channels * DMG_CHANNEL_WIDTH;
+  double binWidth = width / numBins;
+  Bands bands;
+  for (uint32_t i = 0; i < numBins; i++)
+    {
+      BandInfo info;
+      info.fl = centerFrequency - width / 2 + i * binWidth;
+      info.fh = info.fl + binWidth;
+      info.fc = info.fl + binWidth / 2;
+      bands.push_back (info);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (bands);
+  models[key] = model;
+  return model;
+}
+
+/**
+ * Spectral resolution of the DMG/EDMG power spectral densities. The number of
+ * bins per 2.16 GHz channel is an attribute, so it can be set once for all the
+ * PHYs with Config::SetDefault or from the command line
+ * (--ns3::DmgSpectrumResolution::BinsPerChannel=64), and the spectrum model is
+ * derived from the channel configured on the PHY: its center frequency and its
+ * channel width, which gives the number of bonded channels.
+ */
+class DmgSpectrumResolution : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DmgSpectrumResolution ();
+  virtual ~DmgSpectrumResolution ();
+
+  /**
+   * \param centerFrequency The center frequency of the (bonded) channel in Hz.
+   * \param channelWidth The channel width in MHz, a multiple of 2160 MHz.
+   * \return The spectrum model of the channel.
+   */
+  Ptr<SpectrumModel> GetSpectrumModel (double centerFrequency, uint16_t channelWidth) const;
+  /**
+   * \param phy The PHY, configured with its operating channel.
+   * \return The spectrum model of the channel the PHY operates on.
+   */
+  Ptr<SpectrumModel> GetSpectrumModel (Ptr<const WifiPhy> phy) const;
+
+private:
+  uint32_t m_binsPerChannel;              //!< Number of bins per 2.16 GHz channel.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DmgSpectrumResolution);
+
+TypeId
+DmgSpectrumResolution::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DmgSpectrumResolution")
+    .SetParent<Object> ()
+    .SetGroupName ("Spectrum")
+    .AddConstructor<DmgSpectrumResolution> ()
+    .AddAttribute ("BinsPerChannel", "The number of bins per 2.16 GHz channel of the power spectral densities.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&DmgSpectrumResolution::m_binsPerChannel),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+DmgSpectrumResolution::DmgSpectrumResolution ()
+{
+}
+
+DmgSpectrumResolution::~DmgSpectrumResolution ()
+{
+}
+
+Ptr<SpectrumModel>
+DmgSpectrumResolution::GetSpectrumModel (double centerFrequency, uint16_t channelWidth) const
+{
+  uint16_t dmgChannelWidth = DMG_CHANNEL_WIDTH / 1e6;
+  NS_ABORT_MSG_IF ((channelWidth == 0) || (channelWidth % dmgChannelWidth != 0),
+                   "The channel width " << channelWidth << " MHz is not a multiple of 2160 MHz");
+  return GetDmgSpectrumModel (centerFrequency, channelWidth / dmgChannelWidth, m_binsPerChannel);
+}
+
+Ptr<SpectrumModel>
+DmgSpectrumResolution::GetSpectrumModel (Ptr<const WifiPhy> phy) const
+{
+  return GetSpectrumModel (phy->GetFrequency () * 1e6, phy->GetChannelWidth ());
+}
+
+/**
+ * Create a flat transmit power spectral density over a DMG/EDMG channel.
+ * \param txPowerW The total transmit power in Watts.
+ * \param model The spectrum model returned by GetDmgSpectrumModel.
+ * \return The power spectral density in W/Hz.
+ */
+Ptr<SpectrumValue>
+CreateDmgTxPowerSpectralDensity (double txPowerW, Ptr<const SpectrumModel> model)
+{
+  Ptr<SpectrumValue> psd = Create<SpectrumValue> (model);
+  double width = 0;
+  for (Bands::const_iterator it = model->Begin (); it != model->End (); it++)
+    {
+      width += it->fh - it->fl;
+    }
+  (*psd) = txPowerW / width;
+  return psd;
+}
+
+} // namespace ns3
+
+#endif // DMG_SPECTRUM_RESOLUTION_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef DMG_TDD_SCHEDULER_H
+#define DMG_TDD_SCHEDULER_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "dmg-service-period-scheduler.h"
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              TDD Channel Access Scheduler
+ ********************************************************/
+
+/**
+ * Direction of a TDD slot.
+ */
+enum TddSlotType {
+  TDD_SLOT_DOWNLINK = 0,    //!< From the PCP/AP to the STA.
+  TDD_SLOT_UPLINK = 1,      //!< From the STA to the PCP/AP.
+};
+
+/**
+ * A TDD slot of the TDD slot schedule.
+ */
+struct TddSlot {
+  uint8_t aid;              //!< AID of the STA served in the slot.
+  TddSlotType type;         //!< Direction of the slot.
+};
+
+/**
+ * Deterministic TDD channel access for fixed wireless access, in the spirit of
+ * the IEEE 802.11ay TDD mode. The DTI is divided into TDD intervals, which all
+ * repeat the same TDD slot schedule: a sequence of slots of SlotDuration, each
+ * followed by GuardTime and assigned to one STA in one direction. There is no
+ * contention and no per-interval signalling.
+ *
+ * The DMG PCP/AP has no TDD mode, so the slot schedule is mapped onto static
+ * service periods: each slot becomes one allocation made of one block per TDD
+ * interval, with the TDD interval as block period. The whole schedule is then
+ * announced once in the Extended Schedule element. The allocation IDs are
+ * numbered per pair of AIDs, so a STA can own up to MAX_ALLOCATION_ID slots in
+ * each direction.
+ */
+class DmgTddScheduler : public DmgServicePeriodScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DmgTddScheduler ();
+  virtual ~DmgTddScheduler ();
+
+  /**
+   * Append the slots of a STA to the TDD slot schedule.
+   * \param aid The AID of the STA.
+   * \param downlinkSlots The number of downlink slots per TDD interval.
+   * \param uplinkSlots The number of uplink slots per TDD interval.
+   */
+  void AddStation (uint8_t aid, uint8_t downlinkSlots, uint8_t uplinkSlots);
+  /**
+   * \return The TDD slot schedule.
+   */
+  const std::vector<TddSlot> &GetSlotSchedule (void) const;
+  /**
+   * \return The duration of one TDD interval.
+   */
+  Time GetIntervalDuration (void) const;
+  /**
+   * \return The number of TDD intervals per DTI.
+   */
+  uint32_t GetNIntervals (void) const;
+
+protected:
+  /**
+   * Allocate the TDD intervals over the DTI.
+   */
+  virtual void DoStart (void);
+
+private:
+  Time m_slotDuration;                  //!< Duration of a TDD slot.
+  std::vector<TddSlot> m_slots;         //!< TDD slot schedule.
+  uint32_t m_intervals;                 //!< Number of TDD intervals per DTI.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (DmgTddScheduler);
+
+TypeId
+DmgTddScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DmgTddScheduler")
+    .SetParent<DmgServicePeriodScheduler> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<DmgTddScheduler> ()
+    .AddAttribute ("SlotDuration", "The duration of a TDD slot.",
+                   TimeValue (MicroSeconds (500)),
+                   MakeTimeAccessor (&DmgTddScheduler::m_slotDuration),
+                   MakeTimeChecker (MicroSeconds (1), MicroSeconds (32767)))
+  ;
+  return tid;
+}
+
+DmgTddScheduler::DmgTddScheduler ()
+  : m_intervals (0)
+{
+}
+
+DmgTddScheduler::~DmgTddScheduler ()
+{
+}
+
+void
+DmgTddScheduler::AddStation (uint8_t aid, uint8_t downlinkSlots, uint8_t uplinkSlots)
+{
+  TddSlot slot;
+  slot.aid = aid;
+  slot.type = TDD_SLOT_DOWNLINK;
+  for (uint8_t i = 0; i < downlinkSlots; i++)
+    {
+      m_slots.push_back (slot);
+    }
+  slot.type = TDD_SLOT_UPLINK;
+  for (uint8_t i = 0; i < uplinkSlots; i++)
+    {
+      m_slots.push_back (slot);
+    }
+}
+
+const std::vector<TddSlot> &
+DmgTddScheduler::GetSlotSchedule (void) const
+{
+  return m_slots;
+}
+
+Time
+DmgTddScheduler::GetIntervalDuration (void) const
+{
+  return NanoSeconds ((m_slotDuration + m_guardTime).GetNanoSeconds () * m_slots.size ());
+}
+
+uint32_t
+DmgTddScheduler::GetNIntervals (void) const
+{
+  return m_intervals;
+}
+
+void
+DmgTddScheduler::DoStart (void)
+{
+  NS_ABORT_MSG_IF (m_slots.empty (), "The TDD slot schedule is empty");
+  Time interval = GetIntervalDuration ();
+  NS_ABORT_MSG_IF (interval > MicroSeconds (65535), "The TDD interval exceeds the maximum allocation block period");
+  NS_ABORT_MSG_IF (m_slots.size () > 255, "Too many TDD slots");
+  m_intervals = std::min<int64_t> (m_dtiDuration.GetNanoSeconds () / interval.GetNanoSeconds (), 255);
+  NS_ABORT_MSG_IF (m_intervals == 0, "The TDD interval does not fit in the DTI");
+
+  for (uint32_t i = 0; i < m_slots.size (); i++)
+    {
+      uint8_t srcAid = (m_slots[i].type == TDD_SLOT_UPLINK) ? m_slots[i].aid : uint8_t (AID_AP);
+      uint8_t dstAid = (m_slots[i].type == TDD_SLOT_UPLINK) ? uint8_t (AID_AP) : m_slots[i].aid;
+      Time start = NanoSeconds ((m_slotDuration + m_guardTime).GetNanoSeconds () * i);
+      m_apMac->AddAllocationPeriod (GetNextAllocationId (srcAid, dstAid), SERVICE_PERIOD_ALLOCATION, true,
+                                    srcAid, dstAid, start.GetMicroSeconds (), m_slotDuration.GetMicroSeconds (),
+                                    interval.GetMicroSeconds (), m_intervals);
+    }
+}
+
+} // namespace ns3
+
+#endif // DMG_TDD_SCHEDULER_H
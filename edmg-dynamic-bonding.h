@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef EDMG_DYNAMIC_BONDING_H
+#define EDMG_DYNAMIC_BONDING_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *            EDMG Dynamic Channel Bonding
+ ********************************************************/
+
+/**
+ * Number of 2.16 GHz channels in the 60 GHz band (IEEE 802.11ay).
+ */
+static const uint8_t EDMG_NUM_2_16_CHANNELS = 8;
+
+/**
+ * Get the 2.16 GHz channels making up an EDMG channel (IEEE 802.11ay Table 29-2).
+ * \param channel The EDMG channel number.
+ * \return The 2.16 GHz channel numbers in increasing order.
+ */
+std::vector<uint8_t>
+GetEdmgSubChannels (uint8_t channel)
+{
+  uint8_t first;
+  uint8_t ncb;
+  if ((channel >= 1) && (channel <= 8))
+    {
+      first = channel;
+      ncb = 1;
+    }
+  else if ((channel >= 9) && (channel <= 15))
+    {
+      first = channel - 8;
+      ncb = 2;
+    }
+  else if ((channel >= 17) && (channel <= 22))
+    {
+      first = channel - 16;
+      ncb = 3;
+    }
+  else if ((channel >= 25) && (channel <= 29))
+    {
+      first = channel - 24;
+      ncb = 4;
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown EDMG channel number " << uint16_t (channel));
+    }
+  std::vector<uint8_t> subChannels;
+  for (uint8_t i = 0; i < ncb; i++)
+    {
+      subChannels.push_back (first + i);
+    }
+  return subChannels;
+}
+
+/**
+ * Dynamic channel bonding for an EDMG link. The link is configured with its
+ * widest channel (e.g. channel 25 for 8.64 GHz) and its primary 2.16 GHz
+ * channel. Every DecisionInterval, the link uses the widest EDMG channel that
+ * contains the primary channel, fits in the configured channel and whose
+ * secondary 2.16 GHz channels passed the CCA, i.e. they have been idle during
+ * the last PIFS and busy for at most MaxBusyFraction of the last interval. The
+ * link therefore falls back from 8.64 GHz to 6.48, 4.32 or 2.16 GHz when the
+ * secondary channels are busy and bonds them again once they are released.
+ *
+ * In the DMG PHY the transmit bandwidth follows the channel of the PHY, hence
+ * the decision reconfigures the channel of both ends of the link at the same
+ * time, which keeps the primary channel (and the association) untouched. The
+ * PHY waits for the end of an ongoing transmission before switching.
+ *
+ * The activity of the secondary channels is sensed from the transmissions of
+ * the interferers given to AddInterferer, i.e. the scenario decides which
+ * devices are within the CCA range of the link.
+ */
+class EdmgDynamicBonding : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  EdmgDynamicBonding ();
+  virtual ~EdmgDynamicBonding ();
+
+  /**
+   * Setup the dynamic bonding of a link. Both devices must already be
+   * configured with the widest channel and the primary channel of the link.
+   * \param apDevice The EDMG PCP/AP of the link.
+   * \param staDevice The EDMG STA of the link.
+   */
+  void Setup (Ptr<WifiNetDevice> apDevice, Ptr<WifiNetDevice> staDevice);
+  /**
+   * Add a device whose transmissions are sensed by the link.
+   * \param device The interfering device.
+   */
+  void AddInterferer (Ptr<WifiNetDevice> device);
+  /**
+   * Notify the transmission of an interferer.
+   * \param phy The PHY of the interferer.
+   * \param start The start of the transmission.
+   * \param duration The duration of the transmission.
+   * \param state The state of the PHY of the interferer.
+   */
+  void NotifyInterfererState (Ptr<WifiPhy> phy, Time start, Time duration, WifiPhyState state);
+  /**
+   * \return The EDMG channel currently used by the link.
+   */
+  uint8_t GetCurrentChannel (void) const;
+  /**
+   * \param ncb The number of bonded 2.16 GHz channels.
+   * \return The fraction of time spent with this bandwidth.
+   */
+  double GetTimeFraction (uint8_t ncb) const;
+  /**
+   * \return The number of bandwidth changes so far.
+   */
+  uint32_t GetNChanges (void) const;
+
+  /**
+   * TracedCallback signature for bandwidth changes.
+   * \param channel The new EDMG channel of the link.
+   * \param ncb The number of bonded 2.16 GHz channels.
+   */
+  typedef void (* BandwidthChangeCallback)(uint8_t channel, uint8_t ncb);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  typedef std::vector<std::pair<Time, Time> > BusyPeriods;
+
+  /**
+   * Run the CCA of the secondary channels and select the EDMG channel.
+   */
+  void Decide (void);
+  /**
+   * \param channel The 2.16 GHz channel.
+   * \return True if the 2.16 GHz channel passed the CCA.
+   */
+  bool IsIdle (uint8_t channel) const;
+
+  Time m_decisionInterval;                          //!< Interval between two bandwidth decisions.
+  Time m_pifs;                                      //!< Idle time required on a secondary channel.
+  double m_maxBusyFraction;                         //!< Maximum busy fraction of a secondary channel.
+  Ptr<WifiPhy> m_apPhy;                             //!< PHY of the EDMG PCP/AP.
+  Ptr<WifiPhy> m_staPhy;                            //!< PHY of the EDMG STA.
+  uint8_t m_primaryChannel;                         //!< Primary 2.16 GHz channel.
+  uint8_t m_currentChannel;                         //!< EDMG channel currently used.
+  std::vector<uint8_t> m_candidates;                //!< EDMG channels sorted by decreasing bandwidth.
+  BusyPeriods m_busyPeriods[EDMG_NUM_2_16_CHANNELS + 1]; //!< Busy periods per 2.16 GHz channel.
+  std::map<uint8_t, Time> m_timePerNcb;             //!< Time spent per number of bonded channels.
+  uint32_t m_changes;                               //!< Number of bandwidth changes.
+  EventId m_decisionEvent;                          //!< Next bandwidth decision.
+  TracedCallback<uint8_t, uint8_t> m_bandwidthChange; //!< Trace fired upon a bandwidth change.
+
+};
+
+/**
+ * Forward the PHY state of an interferer to the dynamic bonding of a link.
+ */
+void
+EdmgInterfererState (EdmgDynamicBonding *bonding, Ptr<WifiPhy> phy, Time start, Time duration, WifiPhyState state)
+{
+  bonding->NotifyInterfererState (phy, start, duration, state);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (EdmgDynamicBonding);
+
+TypeId
+EdmgDynamicBonding::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EdmgDynamicBonding")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<EdmgDynamicBonding> ()
+    .AddAttribute ("DecisionInterval", "The interval between two bandwidth decisions.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&EdmgDynamicBonding::m_decisionInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Pifs", "The time a secondary channel must be idle before bonding it.",
+                   TimeValue (MicroSeconds (8)),
+                   MakeTimeAccessor (&EdmgDynamicBonding::m_pifs),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxBusyFraction", "The maximum fraction of the last interval a secondary channel "
+                   "may have been busy before bonding it.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&EdmgDynamicBonding::m_maxBusyFraction),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddTraceSource ("BandwidthChange", "The link has changed its bandwidth.",
+                     MakeTraceSourceAccessor (&EdmgDynamicBonding::m_bandwidthChange),
+                     "ns3::EdmgDynamicBonding::BandwidthChangeCallback")
+  ;
+  return tid;
+}
+
+EdmgDynamicBonding::EdmgDynamicBonding ()
+  : m_primaryChannel (0),
+    m_currentChannel (0),
+    m_changes (0)
+{
+}
+
+EdmgDynamicBonding::~EdmgDynamicBonding ()
+{
+}
+
+void
+EdmgDynamicBonding::DoDispose (void)
+{
+  m_decisionEvent.Cancel ();
+  m_apPhy = 0;
+  m_staPhy = 0;
+  Object::DoDispose ();
+}
+
+void
+EdmgDynamicBonding::Setup (Ptr<WifiNetDevice> apDevice, Ptr<WifiNetDevice> staDevice)
+{
+  m_apPhy = apDevice->GetPhy ();
+  m_staPhy = staDevice->GetPhy ();
+  uint8_t maxChannel = m_apPhy->GetChannelNumber ();
+  NS_ABORT_MSG_IF (maxChannel != m_staPhy->GetChannelNumber (), "Both ends of the link must use the same channel");
+  UintegerValue primaryChannel;
+  m_apPhy->GetAttribute ("PrimaryChannelNumber", primaryChannel);
+  m_primaryChannel = primaryChannel.Get ();
+  m_currentChannel = maxChannel;
+
+  /* EDMG channels containing the primary channel and fitting in the widest channel */
+  std::vector<uint8_t> allowed = GetEdmgSubChannels (maxChannel);
+  static const uint8_t firstChannel[4] = {25, 17, 9, 1};
+  static const uint8_t lastChannel[4] = {29, 22, 15, 8};
+  m_candidates.clear ();
+  for (uint8_t i = 0; i < 4; i++)
+    {
+      for (uint8_t channel = firstChannel[i]; channel <= lastChannel[i]; channel++)
+        {
+          std::vector<uint8_t> subChannels = GetEdmgSubChannels (channel);
+          if ((subChannels.front () <= m_primaryChannel) && (m_primaryChannel <= subChannels.back ())
+              && (allowed.front () <= subChannels.front ()) && (subChannels.back () <= allowed.back ()))
+            {
+              m_candidates.push_back (channel);
+              break;
+            }
+        }
+    }
+  NS_ABORT_MSG_IF (m_candidates.empty (), "The primary channel is not part of the channel of the link");
+
+  m_decisionEvent = Simulator::Schedule (m_decisionInterval, &EdmgDynamicBonding::Decide, this);
+}
+
+void
+EdmgDynamicBonding::AddInterferer (Ptr<WifiNetDevice> device)
+{
+  Ptr<WifiPhy> phy = device->GetPhy ();
+  PointerValue state;
+  phy->GetAttribute ("State", state);
+  state.Get<WifiPhyStateHelper> ()->TraceConnectWithoutContext ("State", MakeBoundCallback (&EdmgInterfererState, this, phy));
+}
+
+void
+EdmgDynamicBonding::NotifyInterfererState (Ptr<WifiPhy> phy, Time start, Time duration, WifiPhyState state)
+{
+  if (state != WifiPhyState::TX)
+    {
+      return;
+    }
+  std::vector<uint8_t> subChannels = GetEdmgSubChannels (phy->GetChannelNumber ());
+  for (std::vector<uint8_t>::const_iterator it = subChannels.begin (); it != subChannels.end (); it++)
+    {
+      m_busyPeriods[*it].push_back (std::make_pair (start, start + duration));
+    }
+}
+
+bool
+EdmgDynamicBonding::IsIdle (uint8_t channel) const
+{
+  Time now = Simulator::Now ();
+  Time windowStart = now - m_decisionInterval;
+  Time busy;
+  for (BusyPeriods::const_iterator it = m_busyPeriods[channel].begin (); it != m_busyPeriods[channel].end (); it++)
+    {
+      /* Busy now or during the last PIFS */
+      if ((it->first <= now) && (it->second > now - m_pifs))
+        {
+          return false;
+        }
+      busy += Min (it->second, now) - Max (it->first, windowStart);
+    }
+  return busy.GetSeconds () <= m_maxBusyFraction * m_decisionInterval.GetSeconds ();
+}
+
+void
+EdmgDynamicBonding::Decide (void)
+{
+  Time now = Simulator::Now ();
+  m_timePerNcb[GetEdmgSubChannels (m_currentChannel).size ()] += m_decisionInterval;
+
+  /* Select the widest channel whose secondary channels are idle */
+  uint8_t selected = m_candidates.back ();
+  for (std::vector<uint8_t>::const_iterator it = m_candidates.begin (); it != m_candidates.end (); it++)
+    {
+      std::vector<uint8_t> subChannels = GetEdmgSubChannels (*it);
+      bool idle = true;
+      for (std::vector<uint8_t>::const_iterator sub = subChannels.begin (); sub != subChannels.end () && idle; sub++)
+        {
+          idle = (*sub == m_primaryChannel) || IsIdle (*sub);
+        }
+      if (idle)
+        {
+          selected = *it;
+          break;
+        }
+    }
+
+  if (selected != m_currentChannel)
+    {
+      m_apPhy->SetAttribute ("ChannelNumber", UintegerValue (selected));
+      m_staPhy->SetAttribute ("ChannelNumber", UintegerValue (selected));
+      m_currentChannel = selected;
+      m_changes++;
+      m_bandwidthChange (selected, GetEdmgSubChannels (selected).size ());
+    }
+
+  /* Forget the busy periods which cannot overlap with the next decision window */
+  for (uint8_t channel = 1; channel <= EDMG_NUM_2_16_CHANNELS; channel++)
+    {
+      BusyPeriods &periods = m_busyPeriods[channel];
+      BusyPeriods::iterator end = periods.begin ();
+      for (BusyPeriods::iterator it = periods.begin (); it != periods.end (); it++)
+        {
+          if (it->second > now)
+            {
+              *end++ = *it;
+            }
+        }
+      periods.erase (end, periods.end ());
+    }
+
+  m_decisionEvent = Simulator::Schedule (m_decisionInterval, &EdmgDynamicBonding::Decide, this);
+}
+
+uint8_t
+EdmgDynamicBonding::GetCurrentChannel (void) const
+{
+  return m_currentChannel;
+}
+
+double
+EdmgDynamicBonding::GetTimeFraction (uint8_t ncb) const
+{
+  Time total;
+  for (std::map<uint8_t, Time>::const_iterator it = m_timePerNcb.begin (); it != m_timePerNcb.end (); it++)
+    {
+      total += it->second;
+    }
+  std::map<uint8_t, Time>::const_iterator it = m_timePerNcb.find (ncb);
+  if (total.IsZero () || (it == m_timePerNcb.end ()))
+    {
+      return 0;
+    }
+  return it->second.GetSeconds () / total.GetSeconds ();
+}
+
+uint32_t
+EdmgDynamicBonding::GetNChanges (void) const
+{
+  return m_changes;
+}
+
+} // namespace ns3
+
+#endif // EDMG_DYNAMIC_BONDING_H
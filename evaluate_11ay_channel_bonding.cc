@@ -9,6 +9,7 @@
 #include "ns3/network-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "dmg-asset-cache.h"
 #include <complex>
 #include <iomanip>
 #include <string>
@@ -144,8 +145,9 @@ main (int argc, char *argv[])
               /* Set default algorithm for all nodes to be constant rate */
               wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode",
                                             StringValue (wifiModePrefix + "_MCS" + std::to_string (mcs)));
-              /* Set the correct error model */
-              wifiPhy.SetErrorRateModel ("ns3::DmgErrorModel",
+              /* Set the correct error model, the lookup table is parsed once for the whole sweep */
+              wifiPhy.SetErrorRateModel ("ns3::CachedErrorRateModel",
+                                         "ErrorRateModel", StringValue ("ns3::DmgErrorModel"),
                                          "FileName", StringValue ("DmgFiles/ErrorModel/LookupTable_1458_ay.txt"));
 
               /* Make two nodes and set them up with the PHY and the MAC */
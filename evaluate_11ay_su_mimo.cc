@@ -12,6 +12,8 @@
 #include "ns3/spectrum-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "hybrid-digital-precoding.h"
+#include "su-mimo-incremental-training.h"
 #include <iomanip>
 #include <sstream>
 
@@ -34,11 +36,22 @@
  * ./waf --run "evaluate_11ay_su_mimo --qdChannelFolder=SU-MIMO-Scenarios/su2x2Mimo3cm/Output/Ns3
  * --arrayConfig=28x_AzEl_SU-MIMO_2x2_27 --useAwvs=false --numStreams=2 --kBestCombinations=85 --simulationTime=5"
  *
+ * To evaluate SVD and zero-forcing digital baseband precoding on top of the selected analog beams, run:
+ * ./waf --run "evaluate_11ay_su_mimo --digitalPrecoding=true --subcarrierGroups=16"
+ *
+ * To retrain the SU-MIMO link every 100 ms along a mobility trace and test only the previous top candidates and
+ * their angular neighbours in the MIMO phase, run:
+ * ./waf --run "evaluate_11ay_su_mimo --kBestCombinations=85 --retrainingPeriod=0.1 --incrementalTraining=true"
+ *
  * Simulation Output:
  * The simulation generates the following traces:
  * 1. SNR data for all the data packets.
  * 2. SU-MIMO SISO and MIMO phases traces.
  * 3. PCAP traces for each station.
+ * With digital precoding enabled, the simulation also prints the per-stream MCS and PHY rate after analog-only,
+ * SVD and zero-forcing baseband processing together with the compute time of each precoder. The effective channel
+ * is synthetic: the SNR of each array pair measured in the MIMO phase with a random phase and residual delay, so
+ * the gains are indicative only and do not reflect the phases of the Q-D channel.
  */
 
 NS_LOG_COMPONENT_DEFINE ("Evaluate11aySU-MIMO");
@@ -78,6 +91,18 @@ uint8_t numberOfTxCombinationsRequested = 10;   /* The number of Tx combinations
 bool useAwvs = false;                           /* Flag to indicate whether we test AWVs in MIMO phase or not. */
 std::string tracesFolder = "Traces/";           /* Directory to store the traces. */
 
+/* Hybrid digital precoding */
+bool digitalPrecoding = false;                  /* Evaluate digital baseband precoding on top of the analog beams. */
+uint32_t subcarrierGroups = 8;                  /* The number of subcarrier groups of the digital precoder. */
+std::map<Mac48Address, std::vector<std::vector<double> > > analogChannels; /* Effective channel after analog BF per measuring STA. */
+
+/* SU-MIMO retraining */
+double retrainingPeriod = 0;                    /* The period in seconds between two SU-MIMO BFTs (0 to train once). */
+bool incrementalTraining = false;               /* Retrain only the previous top MIMO candidates and their neighbours. */
+Ptr<SuMimoIncrementalTraining> candidateSelection;  /* MIMO phase candidate selection. */
+Time nextSuMimoTraining;                        /* The time of the next SU-MIMO BFT. */
+uint32_t suMimoTrainings = 0;                   /* The number of SU-MIMO BFTs. */
+
 /* Tracing */
 Ptr<QdPropagationEngine> qdPropagationEngine;   /* Q-D Propagation Engine. */
 AsciiTraceHelper ascii;
@@ -236,8 +261,16 @@ SuMimoSisoPhaseComplete (Ptr<SLS_PARAMETERS> parameters, Mac48Address from, MIMO
                             << uint16_t (std::get<2> (it->first))  << "," <<  RatioToDb ((it->second))  << ","
                             << Simulator::Now ().GetNanoSeconds () << std::endl;
     }
-  MIMO_ANTENNA_COMBINATIONS_LIST mimoCandidates =
-      parameters->wifiMac->FindKBestCombinations (kBestCombinations, numberOfTxAntennas, numberOfRxAntennas, feedbackMap);
+  MIMO_ANTENNA_COMBINATIONS_LIST mimoCandidates;
+  if (incrementalTraining)
+    {
+      mimoCandidates = candidateSelection->SelectCandidates (parameters->wifiMac, kBestCombinations,
+                                                             numberOfTxAntennas, numberOfRxAntennas, feedbackMap);
+    }
+  else
+    {
+      mimoCandidates = parameters->wifiMac->FindKBestCombinations (kBestCombinations, numberOfTxAntennas, numberOfRxAntennas, feedbackMap);
+    }
   //mimoCandidates.erase (mimoCandidates.begin (), mimoCandidates.begin () + 10);
   /* Append 5 AWVs to each sector in the codebook, increasing the granularity of steering to 5 degrees */
   if (useAwvs)
@@ -317,6 +350,7 @@ SuMimoMimoPhaseMeasurements (Ptr<MIMO_PARAMETERS> parameters, Mac48Address from,
       *outputMimoPhase->GetStream () << "SNR,";
     }
   *outputMimoPhase->GetStream () << "min_Stream_SNR" << std::endl;
+  bool selected = true;
   while (!minSnr.empty ())
     {
       MEASUREMENT_AWV_IDs awvId = minSnr.top ().second;
@@ -354,16 +388,83 @@ SuMimoMimoPhaseMeasurements (Ptr<MIMO_PARAMETERS> parameters, Mac48Address from,
             }
         }
       *outputMimoPhase->GetStream () << RatioToDb (minSnr.top ().first) << std::endl;
+      /* The best combination is the one used for data transmission */
+      if (selected && digitalPrecoding)
+        {
+          std::vector<std::vector<double> > &channel = analogChannels[parameters->srcWifiMac->GetAddress ()];
+          channel.assign (nRxAntennas, std::vector<double> (nTxAntennas));
+          snrIndex = 0;
+          for (uint8_t i = 0; i < nTxAntennas; i++)
+            {
+              for (uint8_t j = 0; j < nRxAntennas; j++)
+                {
+                  channel[j][i] = measurements.at (j).second.at (snrIndex);
+                  snrIndex++;
+                }
+            }
+        }
+      selected = false;
       minSnr.pop ();
     }
 }
 
+void
+EvaluateDigitalPrecoding (Mac48Address address, Mac48Address from)
+{
+  std::map<Mac48Address, std::vector<std::vector<double> > >::iterator it = analogChannels.find (address);
+  if (it == analogChannels.end ())
+    {
+      return;
+    }
+  Ptr<HybridDigitalPrecoding> hybrid = CreateObject<HybridDigitalPrecoding> ();
+  hybrid->SetAttribute ("SubcarrierGroups", UintegerValue (subcarrierGroups));
+  hybrid->AssignStreams (1);
+  hybrid->SetSyntheticChannel (it->second);
+
+  const DigitalPrecoder precoders[] = {DIGITAL_PRECODER_NONE, DIGITAL_PRECODER_SVD, DIGITAL_PRECODER_ZF};
+  const std::string names[] = {"Analog", "SVD", "ZF"};
+  double analogRate = 0;
+  std::cout << "Digital precoding over a synthetic channel (measured SNRs, random phases and delays) for the link from EDMG STA "
+            << from << " to EDMG STA " << address << ":" << std::endl;
+  std::cout << std::left << std::setw (12) << "Precoder"
+            << std::left << std::setw (40) << "Stream SINR [dB] / MCS"
+            << std::left << std::setw (16) << "Rate [Mbps]"
+            << std::left << std::setw (12) << "Gain"
+            << std::left << std::setw (20) << "Compute/Group [ns]" << std::endl;
+  for (uint8_t p = 0; p < 3; p++)
+    {
+      StreamRateList streams = hybrid->Evaluate (precoders[p]);
+      std::ostringstream perStream;
+      double rate = 0;
+      for (StreamRateList::const_iterator stream = streams.begin (); stream != streams.end (); stream++)
+        {
+          perStream << std::fixed << std::setprecision (1) << RatioToDb (std::max (stream->snr, 1e-30))
+                    << "/" << uint16_t (stream->mcs) << " ";
+          rate += stream->rate;
+        }
+      if (precoders[p] == DIGITAL_PRECODER_NONE)
+        {
+          analogRate = rate;
+        }
+      std::cout << std::left << std::setw (12) << names[p]
+                << std::left << std::setw (40) << perStream.str ()
+                << std::left << std::setw (16) << rate
+                << std::left << std::setw (12) << ((analogRate > 0) ? rate / analogRate : 0)
+                << std::left << std::setw (20) << hybrid->GetComputeTimePerGroup ().GetNanoSeconds () << std::endl;
+    }
+}
+
 void
 SuMimoMimoPhaseComplete (Ptr<SLS_PARAMETERS> parameters, Mac48Address from)
 {
   std::cout << "EDMG STA " << parameters->wifiMac->GetAddress ()
             << " finished MIMO phase of SU-MIMO BFT with EDMG STA " << from << " at " << Simulator::Now ().GetSeconds () << std::endl;
   suMimoCompleted = true;
+  nextSuMimoTraining = Simulator::Now () + Seconds (retrainingPeriod);
+  if (digitalPrecoding)
+    {
+      EvaluateDigitalPrecoding (parameters->wifiMac->GetAddress (), from);
+    }
 //    if (applicationType == "onoff")
 //      {
 //        onoff->StartApplication ();
@@ -382,8 +483,15 @@ DataTransmissionIntervalStarted (Ptr<DmgStaWifiMac> wifiMac, Mac48Address addres
       wifiMac->Perform_TXSS_TXOP (wifiMac->GetBssid ());
       firstDti = false;
     }
-  if ((beamformedLinks == 2) && (Simulator::Now () > Seconds (0.6)) && !suMimoCompleted)
+  bool retrain = suMimoCompleted && (retrainingPeriod > 0) && (Simulator::Now () >= nextSuMimoTraining);
+  if ((beamformedLinks == 2) && (Simulator::Now () > Seconds (0.6)) && (!suMimoCompleted || retrain))
     {
+      if (retrain)
+        {
+          /* Do not retrain again until the current training completes */
+          nextSuMimoTraining = Simulator::GetMaximumSimulationTime ();
+        }
+      suMimoTrainings++;
       std::cout << "EDMG STA " << wifiMac->GetAddress ()
                 << " initiating SU-MIMO BFT EDMG STA " << wifiMac->GetBssid () <<  " at " << Simulator::Now ().GetSeconds () << std::endl;
       Ptr<Codebook> initiatorCodebook = wifiMac->GetCodebook ();
@@ -434,6 +542,10 @@ main (int argc, char *argv[])
   cmd.AddValue ("kBestCombinations", "The number of K best candidates to test in the MIMO phase", kBestCombinations);
   cmd.AddValue ("nTxCombinations", "The number of Tx combinations to feedback", numberOfTxCombinationsRequested);
   cmd.AddValue ("useAwvs", "Flag to indicate whether we test AWVs in MIMO phase or not", useAwvs);
+  cmd.AddValue ("digitalPrecoding", "Evaluate SVD and ZF digital precoding on top of the selected analog beams", digitalPrecoding);
+  cmd.AddValue ("retrainingPeriod", "The period in seconds between two SU-MIMO BFTs, 0 to train once", retrainingPeriod);
+  cmd.AddValue ("incrementalTraining", "Retrain only the previous top MIMO candidates and their angular neighbours", incrementalTraining);
+  cmd.AddValue ("subcarrierGroups", "The number of subcarrier groups of the digital precoder", subcarrierGroups);
   cmd.AddValue ("channelNumber", "The channel number of the network", channelNumber);
   cmd.AddValue ("txPower", "The transmit power in dBm of the devices", txPower);
   cmd.AddValue ("phyMode", "802.11ay PHY Mode", phyMode);
@@ -447,6 +559,8 @@ main (int argc, char *argv[])
   cmd.AddValue ("csv", "Enable CSV output instead of plain text. This mode will suppress all the messages related statistics and events.", csv);
   cmd.Parse (argc, argv);
 
+  candidateSelection = CreateObject<SuMimoIncrementalTraining> ();
+
   /* Validate A-MSDU and A-MPDU values */
   ValidateFrameAggregationAttributes (msduAggSize, mpduAggSize, WIFI_PHY_STANDARD_80211ay);
   /* Configure RTS/CTS and Fragmentation */
@@ -710,6 +824,16 @@ main (int argc, char *argv[])
           std::cout << "  Throughput: " << packetSink->GetTotalRx () * 8.0 / ((simulationTime - 1) * 1e6) << " Mbps" << std::endl;
         }
 
+      /* Print SU-MIMO BFT Statistics */
+      std::cout << "\nSU-MIMO BFT Statistics:" << std::endl;
+      std::cout << "  Number of SU-MIMO BFTs: " << suMimoTrainings << std::endl;
+      if (incrementalTraining)
+        {
+          std::cout << "  Full Searches:          " << candidateSelection->GetNFullSearches () << std::endl;
+          std::cout << "  Incremental Searches:   " << candidateSelection->GetNIncrementalSearches () << std::endl;
+          std::cout << "  MIMO Phase Candidates:  " << candidateSelection->GetNCandidates () << std::endl;
+        }
+
       /* Print MAC Layer Statistics */
       std::cout << "\nMAC Layer Statistics:" << std::endl;;
       std::cout << "  Number of Failed Tx Data Packets:  " << macTxDataFailed << std::endl;
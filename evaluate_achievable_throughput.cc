@@ -9,6 +9,7 @@
 #include "ns3/network-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "dmg-asset-cache.h"
 #include <complex>
 #include <iomanip>
 #include <string>
@@ -175,8 +176,9 @@ main (int argc, char *argv[])
           wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue (wifiModePrefix + std::to_string (mcs)));
           if (standard == "ay")
             {
-              /* Set the correct error model */
-              wifiPhy.SetErrorRateModel ("ns3::DmgErrorModel",
+              /* Set the correct error model, the lookup table is parsed once for the whole sweep */
+              wifiPhy.SetErrorRateModel ("ns3::CachedErrorRateModel",
+                                         "ErrorRateModel", StringValue ("ns3::DmgErrorModel"),
                                          "FileName", StringValue ("DmgFiles/ErrorModel/LookupTable_1458_ay.txt"));
             }
 
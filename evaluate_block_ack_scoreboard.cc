@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "block-ack-scoreboard.h"
+#include <chrono>
+#include <deque>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Micro-benchmark of the bitmap BlockAck scoreboard against a per-MPDU scoreboard for the window sizes used by
+ * DMG (64), EDMG with large aggregates (256) and the maximum EDMG window (1024). The traffic model mimics a
+ * recipient receiving A-MPDUs of one window each, with independent MPDU losses and retransmissions of the
+ * missing MPDUs in the next A-MPDU. After each A-MPDU, the recipient builds the Compressed BlockAck bitmap and
+ * releases the in-order MPDUs, while the originator checks whether a BlockAckReq is required.
+ *
+ * Both scoreboards are driven with the same sequence of events and their outputs are compared.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_block_ack_scoreboard --lossRate=0.05 --ampdus=20000"
+ *
+ * Simulation Output:
+ * A table with the time per MPDU of both scoreboards for each window size.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateBlockAckScoreboard");
+
+using namespace ns3;
+using namespace std;
+
+/**
+ * Reference scoreboard keeping one flag per MPDU of the window.
+ */
+class PerMpduScoreboard
+{
+public:
+  PerMpduScoreboard (uint16_t windowSize, uint16_t startingSequence)
+    : m_window (windowSize, false),
+      m_winStart (startingSequence)
+  {
+  }
+  void Record (uint16_t seq)
+  {
+    uint16_t distance = (seq - m_winStart) & 4095;
+    if (distance >= 2048)
+      {
+        return;
+      }
+    while (distance >= m_window.size ())
+      {
+        m_window.pop_front ();
+        m_window.push_back (false);
+        m_winStart = (m_winStart + 1) & 4095;
+        distance--;
+      }
+    m_window[distance] = true;
+  }
+  uint16_t AdvanceOverRecorded (void)
+  {
+    uint16_t released = 0;
+    while ((released < m_window.size ()) && m_window.front ())
+      {
+        m_window.pop_front ();
+        m_window.push_back (false);
+        m_winStart = (m_winStart + 1) & 4095;
+        released++;
+      }
+    return released;
+  }
+  bool GetFirstMissing (uint16_t &seq) const
+  {
+    for (uint16_t i = 0; i < m_window.size (); i++)
+      {
+        if (!m_window[i])
+          {
+            seq = (m_winStart + i) & 4095;
+            return true;
+          }
+      }
+    return false;
+  }
+  void GetBitmap (std::vector<uint64_t> &bitmap) const
+  {
+    bitmap.assign ((m_window.size () + 63) / 64, 0);
+    for (uint16_t i = 0; i < m_window.size (); i++)
+      {
+        if (m_window[i])
+          {
+            bitmap[i / 64] |= uint64_t (1) << (i % 64);
+          }
+      }
+  }
+
+private:
+  std::deque<bool> m_window;
+  uint16_t m_winStart;
+};
+
+/**
+ * Run the traffic model over a scoreboard.
+ * \return A checksum of the scoreboard outputs.
+ */
+template <typename Scoreboard>
+uint64_t
+RunTraffic (Scoreboard &scoreboard, const std::vector<bool> &losses, uint16_t windowSize, uint32_t ampdus)
+{
+  uint64_t checksum = 0;
+  std::vector<uint64_t> bitmap;
+  std::vector<uint16_t> missing;
+  std::vector<uint16_t> next;
+  uint16_t nextNew = 0;
+  size_t loss = 0;
+  for (uint32_t n = 0; n < ampdus; n++)
+    {
+      /* Retransmissions first, then new MPDUs up to the window size */
+      next.clear ();
+      for (size_t i = 0; i < missing.size (); i++)
+        {
+          if (losses[loss++ % losses.size ()])
+            {
+              next.push_back (missing[i]);
+            }
+          else
+            {
+              scoreboard.Record (missing[i]);
+            }
+        }
+      for (size_t i = missing.size (); i < windowSize; i++)
+        {
+          if (losses[loss++ % losses.size ()])
+            {
+              next.push_back (nextNew);
+            }
+          else
+            {
+              scoreboard.Record (nextNew);
+            }
+          nextNew = (nextNew + 1) & 4095;
+        }
+      missing.swap (next);
+
+      scoreboard.GetBitmap (bitmap);
+      for (size_t i = 0; i < bitmap.size (); i++)
+        {
+          checksum = checksum * 31 + bitmap[i];
+        }
+      uint16_t first;
+      if (scoreboard.GetFirstMissing (first))
+        {
+          checksum += first;
+        }
+      checksum += scoreboard.AdvanceOverRecorded ();
+    }
+  return checksum;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double lossRate = 0.05;       /* The MPDU loss probability. */
+  uint32_t ampdus = 20000;      /* The number of A-MPDUs per window size. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("lossRate", "The MPDU loss probability", lossRate);
+  cmd.AddValue ("ampdus", "The number of A-MPDUs per window size", ampdus);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  std::vector<bool> losses (1 << 16);
+  for (size_t i = 0; i < losses.size (); i++)
+    {
+      losses[i] = (uniform->GetValue () < lossRate);
+    }
+
+  std::cout << std::left << std::setw (12) << "Window"
+            << std::left << std::setw (20) << "Per-MPDU [ns/MPDU]"
+            << std::left << std::setw (20) << "Bitmap [ns/MPDU]"
+            << std::left << std::setw (12) << "Speed-up"
+            << std::left << std::setw (12) << "Identical" << std::endl;
+
+  for (uint16_t windowSize : {64, 256, 1024})
+    {
+      double mpdus = double (ampdus) * windowSize;
+
+      PerMpduScoreboard reference (windowSize, 0);
+      auto start = std::chrono::steady_clock::now ();
+      uint64_t referenceChecksum = RunTraffic (reference, losses, windowSize, ampdus);
+      auto end = std::chrono::steady_clock::now ();
+      double referenceTime = std::chrono::duration<double, std::nano> (end - start).count () / mpdus;
+
+      BlockAckScoreboard scoreboard (windowSize, 0);
+      start = std::chrono::steady_clock::now ();
+      uint64_t checksum = RunTraffic (scoreboard, losses, windowSize, ampdus);
+      end = std::chrono::steady_clock::now ();
+      double time = std::chrono::duration<double, std::nano> (end - start).count () / mpdus;
+
+      std::cout << std::left << std::setw (12) << windowSize
+                << std::left << std::setw (20) << referenceTime
+                << std::left << std::setw (20) << time
+                << std::left << std::setw (12) << referenceTime / time
+                << std::left << std::setw (12) << ((checksum == referenceChecksum) ? "yes" : "no") << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "block-matrix-propagation-loss-model.h"
+#include "dense-matrix-propagation-loss-model.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Micro-benchmark of the block-structured loss matrix against the dense loss matrix for a clustered deployment
+ * (e.g. rooms of a campus). Both models are filled with the same losses and compared in terms of stored entries,
+ * time per pairwise CalcRxPower and time per receiver of a CalcRxPowerRow.
+ *
+ * Simulation Description:
+ * The nodes are spread evenly over the clusters, except for a few unclustered nodes which only see the default
+ * loss. The inter-cluster losses of the first half of the clusters are set before the remaining clusters are
+ * added, so growing the number of clusters must keep them. For every pair of nodes, the pairwise and row results
+ * of the block model are checked against the dense model.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_block_matrix_loss --nodes=1000 --clusters=50"
+ *
+ * Simulation Output:
+ * A table with the stored entries and the lookup times of both models, and the largest difference between them.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateBlockMatrixLoss");
+
+using namespace ns3;
+using namespace std;
+
+double txPowerDbm = 10.0;                       /* The transmit power in dBm. */
+
+/**
+ * Evaluate every pair of nodes through CalcRxPower.
+ * \return The time per pair in ns.
+ */
+double
+TimePairwise (Ptr<PropagationLossModel> model, const std::vector<Ptr<MobilityModel> > &mobility,
+              std::vector<double> &rxPowers)
+{
+  uint32_t n = mobility.size ();
+  rxPowers.resize (n * n);
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (uint32_t j = 0; j < n; j++)
+        {
+          rxPowers[i * n + j] = model->CalcRxPower (txPowerDbm, mobility[i], mobility[j]);
+        }
+    }
+  auto end = std::chrono::steady_clock::now ();
+  return std::chrono::duration<double, std::nano> (end - start).count () / (double (n) * n);
+}
+
+/**
+ * Evaluate every row of the loss matrix through CalcRxPowerRow.
+ * \return The time per receiver in ns.
+ */
+double
+TimeRows (Ptr<BatchPropagationLossModel> model, const std::vector<Ptr<MobilityModel> > &mobility,
+          std::vector<double> &rxPowers)
+{
+  uint32_t n = mobility.size ();
+  rxPowers.resize (n * n);
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      model->CalcRxPowerRow (mobility[i], txPowerDbm, rxPowers.data () + i * n);
+    }
+  auto end = std::chrono::steady_clock::now ();
+  return std::chrono::duration<double, std::nano> (end - start).count () / (double (n) * n);
+}
+
+double
+MaxDifference (const std::vector<double> &a, const std::vector<double> &b)
+{
+  double difference = 0;
+  for (size_t i = 0; i < a.size (); i++)
+    {
+      difference = std::max (difference, std::abs (a[i] - b[i]));
+    }
+  return difference;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 1000;                        /* The number of nodes. */
+  uint32_t clusters = 50;                       /* The number of clusters. */
+  uint32_t unclustered = 10;                    /* The number of nodes outside any cluster. */
+  double defaultLoss = 200;                     /* The loss of the pairs which are not set in dB. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "The number of nodes", nodes);
+  cmd.AddValue ("clusters", "The number of clusters", clusters);
+  cmd.AddValue ("unclustered", "The number of nodes outside any cluster", unclustered);
+  cmd.AddValue ("defaultLoss", "The loss of the pairs which are not set in dB", defaultLoss);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (clusters < 2, "At least two clusters are required");
+  NS_ABORT_MSG_IF (unclustered >= nodes, "At least one node must belong to a cluster");
+
+  std::vector<Ptr<MobilityModel> > mobility (nodes);
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      mobility[i] = CreateObject<ConstantPositionMobilityModel> ();
+    }
+
+  /* Draw the losses of the deployment */
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uint32_t clustered = nodes - unclustered;
+  std::vector<uint32_t> cluster (nodes);
+  std::vector<double> offset (nodes, 0);
+  for (uint32_t i = 0; i < clustered; i++)
+    {
+      cluster[i] = i % clusters;
+      offset[i] = uniform->GetValue (0, 6);
+    }
+  std::vector<double> interLoss (clusters * clusters);
+  for (uint32_t a = 0; a < clusters; a++)
+    {
+      for (uint32_t b = a; b < clusters; b++)
+        {
+          interLoss[a * clusters + b] = interLoss[b * clusters + a] = uniform->GetValue (90, 140);
+        }
+    }
+
+  /* Block model: the first half of the clusters is set up before the others are added */
+  Ptr<BlockMatrixPropagationLossModel> blockModel = CreateObject<BlockMatrixPropagationLossModel> ();
+  blockModel->SetDefaultLoss (defaultLoss);
+  uint32_t firstHalf = clusters / 2;
+  blockModel->SetNClusters (firstHalf);
+  for (uint32_t a = 0; a < firstHalf; a++)
+    {
+      for (uint32_t b = a; b < firstHalf; b++)
+        {
+          blockModel->SetClusterLoss (a, b, interLoss[a * clusters + b]);
+        }
+    }
+  blockModel->SetNClusters (clusters);
+  for (uint32_t a = 0; a < clusters; a++)
+    {
+      for (uint32_t b = std::max (a, firstHalf); b < clusters; b++)
+        {
+          blockModel->SetClusterLoss (a, b, interLoss[a * clusters + b]);
+        }
+    }
+  for (uint32_t i = 0; i < clustered; i++)
+    {
+      blockModel->SetCluster (mobility[i], cluster[i]);
+      blockModel->SetNodeOffset (mobility[i], offset[i]);
+    }
+  for (uint32_t i = clustered; i < nodes; i++)
+    {
+      blockModel->AddReceiver (mobility[i]);
+    }
+
+  /* Dense model with the same losses */
+  Ptr<DenseMatrixPropagationLossModel> denseModel = CreateObject<DenseMatrixPropagationLossModel> ();
+  denseModel->SetDefaultLoss (defaultLoss);
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      denseModel->AddReceiver (mobility[i]);
+    }
+  for (uint32_t i = 0; i < clustered; i++)
+    {
+      for (uint32_t j = i + 1; j < clustered; j++)
+        {
+          double loss;
+          if (cluster[i] == cluster[j])
+            {
+              loss = uniform->GetValue (40, 80);
+              blockModel->SetLoss (mobility[i], mobility[j], loss);
+            }
+          else
+            {
+              loss = interLoss[cluster[i] * clusters + cluster[j]] + offset[i] + offset[j];
+            }
+          denseModel->SetLoss (i, j, loss);
+          denseModel->SetLoss (j, i, loss);
+        }
+    }
+
+  std::vector<double> densePairwise, denseRows, blockPairwise, blockRows;
+  double densePairwiseTime = TimePairwise (denseModel, mobility, densePairwise);
+  double denseRowTime = TimeRows (denseModel, mobility, denseRows);
+  double blockPairwiseTime = TimePairwise (blockModel, mobility, blockPairwise);
+  double blockRowTime = TimeRows (blockModel, mobility, blockRows);
+
+  std::cout << std::left << std::setw (12) << "Model"
+            << std::left << std::setw (16) << "Entries"
+            << std::left << std::setw (20) << "Pairwise [ns]"
+            << std::left << std::setw (20) << "Row [ns/rx]" << std::endl;
+  std::cout << std::left << std::setw (12) << "Dense"
+            << std::left << std::setw (16) << uint64_t (nodes) * nodes
+            << std::left << std::setw (20) << densePairwiseTime
+            << std::left << std::setw (20) << denseRowTime << std::endl;
+  std::cout << std::left << std::setw (12) << "Block"
+            << std::left << std::setw (16) << blockModel->GetNEntries ()
+            << std::left << std::setw (20) << blockPairwiseTime
+            << std::left << std::setw (20) << blockRowTime << std::endl;
+
+  /* The block model must give the same losses on both paths */
+  std::cout << "\nMax |Block pairwise - Dense| [dB] = " << MaxDifference (blockPairwise, densePairwise) << std::endl;
+  std::cout << "Max |Block row - Block pairwise| [dB] = " << MaxDifference (blockRows, blockPairwise) << std::endl;
+  std::cout << "Max |Dense row - Dense pairwise| [dB] = " << MaxDifference (denseRows, densePairwise) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "common-functions.h"
+#include "dmg-relay-link-switching.h"
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Evaluate the link switching relay operation under blockage of the direct DMG link. Without a relay, the traffic
+ * stops for the whole blockage. With a relay, the source switches to the alternate beamformed path through the
+ * relay STA once the direct link fails, and periodically re-evaluates the direct link.
+ *
+ * Network Topology:
+ * The scenario consists of two DMG STAs (West + East) and one relay DMG STA with two DMG interfaces, one
+ * facing each STA. All the devices use the DMG Ad-Hoc MAC with predefined antenna configurations (sector k of
+ * the analytical codebook points at (k - 1) * 45 degrees).
+ *
+ *                          Relay DMG STA (0,+distance)
+ *
+ *
+ * West DMG STA (-distance,0)                          East DMG STA (+distance,0)
+ *
+ * Simulation Description:
+ * West DMG STA sends UDP traffic to East DMG STA. The direct link is blocked between blockageStart and
+ * blockageEnd using the same blockage mechanism as test_beamformedlink_maintenance.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_dmg_relay --relay=1"
+ * ./waf --run "evaluate_dmg_relay --relay=0"
+ *
+ * Simulation Output:
+ * 1. The path switch events.
+ * 2. The longest outage and the goodput during the blockage.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateDmgRelay");
+
+using namespace ns3;
+using namespace std;
+
+/*** Application Layer Variables ***/
+Ptr<PacketSink> sink;
+uint64_t lastTotalRx = 0;
+Time sampleInterval = MilliSeconds (1);
+
+/*** Blockage Variables ***/
+Ptr<DmgWifiChannel> mmWaveChannel;
+double blockageValue = -100;              /* Link loss due to blockage in dB. */
+Time blockageStartTime;
+Time blockageEndTime;
+uint64_t rxBeforeBlockage = 0;            /* Bytes received before the blockage. */
+uint64_t rxAfterBlockage = 0;             /* Bytes received until the end of the blockage. */
+
+/*** Outage Variables ***/
+Time outageStart;                         /* Start of the current outage. */
+Time longestOutage;                       /* Longest outage since the start of the blockage. */
+bool inOutage = false;
+
+/*** Antenna Configuration Variables ***/
+Ptr<DmgAdhocWifiMac> westWifiMac, eastWifiMac, relayWestWifiMac, relayEastWifiMac;
+
+void
+SampleReception (void)
+{
+  uint64_t totalRx = sink->GetTotalRx ();
+  Time now = Simulator::Now ();
+  if (now > blockageStartTime)
+    {
+      if (totalRx == lastTotalRx)
+        {
+          if (!inOutage)
+            {
+              inOutage = true;
+              outageStart = now - sampleInterval;
+            }
+          longestOutage = std::max (longestOutage, now - outageStart);
+        }
+      else
+        {
+          inOutage = false;
+        }
+    }
+  lastTotalRx = totalRx;
+  Simulator::Schedule (sampleInterval, &SampleReception);
+}
+
+double
+DoInsertBlockage (void)
+{
+  return blockageValue;
+}
+
+void
+BlockLink (Ptr<DmgWifiPhy> srcWifiPhy, Ptr<DmgWifiPhy> dstWifiPhy)
+{
+  std::cout << "Blockage inserted at " << Simulator::Now ().GetSeconds () << std::endl;
+  rxBeforeBlockage = sink->GetTotalRx ();
+  mmWaveChannel->AddBlockage (&DoInsertBlockage, srcWifiPhy, dstWifiPhy);
+}
+
+void
+UnblockLink (void)
+{
+  std::cout << "Blockage removed at " << Simulator::Now ().GetSeconds () << std::endl;
+  rxAfterBlockage = sink->GetTotalRx ();
+  mmWaveChannel->RemoveBlockage ();
+}
+
+void
+PathSwitched (bool relayed)
+{
+  std::cout << "Traffic switched to the " << (relayed ? "relay path" : "direct link")
+            << " at " << Simulator::Now ().GetSeconds () << std::endl;
+  if (relayed)
+    {
+      westWifiMac->SteerAntennaToward (relayWestWifiMac->GetAddress ());
+      eastWifiMac->SteerAntennaToward (relayEastWifiMac->GetAddress ());
+    }
+  else
+    {
+      westWifiMac->SteerAntennaToward (eastWifiMac->GetAddress ());
+      eastWifiMac->SteerAntennaToward (westWifiMac->GetAddress ());
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool relay = true;                              /* Enable the relay operation. */
+  uint32_t payloadSize = 1448;                    /* Application payload size in bytes. */
+  string dataRate = "1000Mbps";                   /* Application data rate. */
+  string mcs = "12";                              /* The MCS of the DMG links. */
+  double distance = 2.0;                          /* Half of the distance between West and East DMG STAs in meters. */
+  double blockageStart = 1.0;                     /* The start of the blockage in seconds. */
+  double blockageEnd = 2.0;                       /* The end of the blockage in seconds. */
+  uint32_t failureThreshold = 3;                  /* The number of dropped MSDUs before switching to the relay. */
+  double retryInterval = 100;                     /* The time on the relay path before retrying the direct link in ms. */
+  double simulationTime = 3;                      /* Simulation time in seconds. */
+  bool pcapTracing = false;                       /* PCAP Tracing is enabled or not. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("relay", "Enable the link switching relay operation", relay);
+  cmd.AddValue ("payloadSize", "Application payload size in bytes", payloadSize);
+  cmd.AddValue ("dataRate", "The data rate of the OnOff application", dataRate);
+  cmd.AddValue ("mcs", "The MCS of the DMG links", mcs);
+  cmd.AddValue ("distance", "Half of the distance between West and East DMG STAs in meters", distance);
+  cmd.AddValue ("blockageStart", "The start of the blockage in seconds", blockageStart);
+  cmd.AddValue ("blockageEnd", "The end of the blockage in seconds", blockageEnd);
+  cmd.AddValue ("failureThreshold", "The number of dropped MSDUs before switching to the relay", failureThreshold);
+  cmd.AddValue ("retryInterval", "The time on the relay path before retrying the direct link in ms", retryInterval);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("pcap", "Enable PCAP Tracing", pcapTracing);
+  cmd.Parse (argc, argv);
+
+  /* Global params: no fragmentation, no RTS/CTS, fixed rate for all packets */
+  ConfigureRtsCtsAndFragmenatation ();
+  Config::SetDefault ("ns3::DmgRelayLinkSwitching::FailureThreshold", UintegerValue (failureThreshold));
+  Config::SetDefault ("ns3::DmgRelayLinkSwitching::RetryInterval", TimeValue (MilliSeconds (retryInterval)));
+
+  /**** DmgWifiHelper is a meta-helper: it helps creates helpers ****/
+  DmgWifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ad);
+
+  /**** Set up Channel ****/
+  DmgWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel", "Frequency", DoubleValue (60.48e9));
+
+  /**** Setup physical layer ****/
+  DmgWifiPhyHelper wifiPhy = DmgWifiPhyHelper::Default ();
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  wifiPhy.Set ("TxPowerStart", DoubleValue (10.0));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (10.0));
+  wifiPhy.Set ("TxPowerLevels", UintegerValue (1));
+  wifiPhy.Set ("ChannelNumber", UintegerValue (2));
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("DMG_MCS" + mcs));
+
+  /* Set Analytical Codebook for the DMG Devices */
+  wifi.SetCodebook ("ns3::CodebookAnalytical",
+                    "CodebookType", EnumValue (SIMPLE_CODEBOOK),
+                    "Antennas", UintegerValue (1),
+                    "Sectors", UintegerValue (8));
+
+  /* Make three nodes, the relay node has two DMG interfaces */
+  NodeContainer wifiNodes;
+  wifiNodes.Create (3);
+  Ptr<Node> westNode = wifiNodes.Get (0);
+  Ptr<Node> eastNode = wifiNodes.Get (1);
+  Ptr<Node> relayNode = wifiNodes.Get (2);
+
+  DmgWifiMacHelper wifiMac = DmgWifiMacHelper::Default ();
+  wifiMac.SetType ("ns3::DmgAdhocWifiMac",
+                   "BE_MaxAmpduSize", UintegerValue (262143),
+                   "BE_MaxAmsduSize", UintegerValue (7935));
+
+  NetDeviceContainer devices;
+  devices.Add (wifi.Install (wifiPhy, wifiMac, westNode));
+  devices.Add (wifi.Install (wifiPhy, wifiMac, eastNode));
+  devices.Add (wifi.Install (wifiPhy, wifiMac, relayNode));
+  devices.Add (wifi.Install (wifiPhy, wifiMac, relayNode));
+
+  Ptr<WifiNetDevice> westDevice = StaticCast<WifiNetDevice> (devices.Get (0));
+  Ptr<WifiNetDevice> eastDevice = StaticCast<WifiNetDevice> (devices.Get (1));
+  westWifiMac = StaticCast<DmgAdhocWifiMac> (westDevice->GetMac ());
+  eastWifiMac = StaticCast<DmgAdhocWifiMac> (eastDevice->GetMac ());
+  relayWestWifiMac = StaticCast<DmgAdhocWifiMac> (StaticCast<WifiNetDevice> (devices.Get (2))->GetMac ());
+  relayEastWifiMac = StaticCast<DmgAdhocWifiMac> (StaticCast<WifiNetDevice> (devices.Get (3))->GetMac ());
+
+  /* Antenna configurations of the direct link and of the relay path */
+  westWifiMac->AddAntennaConfig (1, 1, 1, 1, eastWifiMac->GetAddress ());
+  eastWifiMac->AddAntennaConfig (5, 1, 5, 1, westWifiMac->GetAddress ());
+  westWifiMac->AddAntennaConfig (2, 1, 2, 1, relayWestWifiMac->GetAddress ());
+  eastWifiMac->AddAntennaConfig (4, 1, 4, 1, relayEastWifiMac->GetAddress ());
+  relayWestWifiMac->AddAntennaConfig (6, 1, 6, 1, westWifiMac->GetAddress ());
+  relayEastWifiMac->AddAntennaConfig (8, 1, 8, 1, eastWifiMac->GetAddress ());
+  westWifiMac->SteerAntennaToward (eastWifiMac->GetAddress ());
+  eastWifiMac->SteerAntennaToward (westWifiMac->GetAddress ());
+  relayWestWifiMac->SteerAntennaToward (westWifiMac->GetAddress ());
+  relayEastWifiMac->SteerAntennaToward (eastWifiMac->GetAddress ());
+
+  /* Setting mobility model */
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (-distance, 0.0, 0.0));     /* West DMG STA */
+  positionAlloc->Add (Vector (distance, 0.0, 0.0));      /* East DMG STA */
+  positionAlloc->Add (Vector (0.0, distance, 0.0));      /* Relay DMG STA */
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiNodes);
+
+  /* Internet stack */
+  InternetStackHelper stack;
+  stack.Install (wifiNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* Both relay interfaces share the subnet, pin the interface facing each STA */
+  Ipv4StaticRoutingHelper staticRoutingHelper;
+  Ptr<Ipv4> relayIpv4 = relayNode->GetObject<Ipv4> ();
+  Ptr<Ipv4StaticRouting> relayRouting = staticRoutingHelper.GetStaticRouting (relayIpv4);
+  relayRouting->AddHostRouteTo (interfaces.GetAddress (0), relayIpv4->GetInterfaceForDevice (devices.Get (2)));
+  relayRouting->AddHostRouteTo (interfaces.GetAddress (1), relayIpv4->GetInterfaceForDevice (devices.Get (3)));
+
+  /* We do not want any ARP packets */
+  PopulateArpCache ();
+
+  /* Link switching relay operation of the source */
+  if (relay)
+    {
+      Ptr<DmgRelayLinkSwitching> relaySwitching = CreateObject<DmgRelayLinkSwitching> ();
+      relaySwitching->Setup (westDevice, eastWifiMac->GetAddress (), interfaces.GetAddress (1), interfaces.GetAddress (2));
+      westNode->AggregateObject (relaySwitching);
+      relaySwitching->TraceConnectWithoutContext ("PathSwitch", MakeCallback (&PathSwitched));
+    }
+
+  /* Install Simple UDP Server on the East DMG STA */
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9999));
+  ApplicationContainer sinkApp = sinkHelper.Install (eastNode);
+  sink = StaticCast<PacketSink> (sinkApp.Get (0));
+  sinkApp.Start (Seconds (0.0));
+
+  /* Install UDP Transmitter on the West DMG STA */
+  OnOffHelper src ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), 9999));
+  src.SetAttribute ("MaxBytes", UintegerValue (0));
+  src.SetAttribute ("PacketSize", UintegerValue (payloadSize));
+  src.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1e6]"));
+  src.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  src.SetAttribute ("DataRate", DataRateValue (DataRate (dataRate)));
+  ApplicationContainer srcApp = src.Install (westNode);
+  srcApp.Start (Seconds (0.0));
+  srcApp.Stop (Seconds (simulationTime));
+
+  /* Blockage of the direct link */
+  mmWaveChannel = StaticCast<DmgWifiChannel> (westDevice->GetChannel ());
+  blockageStartTime = Seconds (blockageStart);
+  blockageEndTime = Seconds (blockageEnd);
+  Simulator::Schedule (blockageStartTime, &BlockLink,
+                       StaticCast<DmgWifiPhy> (westDevice->GetPhy ()), StaticCast<DmgWifiPhy> (eastDevice->GetPhy ()));
+  Simulator::Schedule (blockageEndTime, &UnblockLink);
+
+  if (pcapTracing)
+    {
+      wifiPhy.SetPcapDataLinkType (YansWifiPhyHelper::DLT_IEEE802_11_RADIO);
+      wifiPhy.EnablePcap ("Traces/Relay", devices, false);
+    }
+
+  Simulator::Schedule (sampleInterval, &SampleReception);
+  Simulator::Stop (Seconds (simulationTime + 0.101));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  /* Print Results Summary */
+  uint64_t totalRx = sink->GetTotalRx ();
+  double afterDuration = simulationTime - blockageEnd;
+  std::cout << "\nResults Summary (relay " << (relay ? "enabled" : "disabled") << "):" << std::endl;
+  std::cout << "  Goodput before blockage: " << rxBeforeBlockage * 8.0 / (blockageStart * 1e6) << " Mbps" << std::endl;
+  std::cout << "  Goodput during blockage: "
+            << (rxAfterBlockage - rxBeforeBlockage) * 8.0 / ((blockageEnd - blockageStart) * 1e6) << " Mbps" << std::endl;
+  if (afterDuration > 0)
+    {
+      std::cout << "  Goodput after blockage:  " << (totalRx - rxAfterBlockage) * 8.0 / (afterDuration * 1e6)
+                << " Mbps" << std::endl;
+    }
+  std::cout << "  Longest outage: " << longestOutage.GetMicroSeconds () / 1e3 << " ms" << std::endl;
+
+  return 0;
+}
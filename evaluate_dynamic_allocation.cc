@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "common-functions.h"
+#include "dmg-dynamic-allocation.h"
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Compare static service periods with dynamic channel time allocation in IEEE 802.11ad for bursty traffic.
+ *
+ * Network Topology:
+ * The scenario consists of a single DMG PCP/AP and a number of DMG STAs placed on a circle of 1 meter radius around
+ * the DMG PCP/AP. Each DMG STA sends a bursty uplink UDP flow towards the DMG PCP/AP. The offered load of DMG STA i
+ * is (i + 1) / numSTAs times the dataRate during its ON periods.
+ *
+ * Simulation Description:
+ * Once all the DMG STAs are associated, the DMG PCP/AP allocates one SP per DMG STA in the DTI.
+ * With static allocation, the SPs have equal durations and never change. With dynamic allocation, the DMG PCP/AP
+ * polls the DMG STAs in a polling period at the end of each DTI, collects their queue state and grants SPs in the
+ * next DTI in proportion to the reported demand.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_dynamic_allocation --allocation=static"
+ * ./waf --run "evaluate_dynamic_allocation --allocation=dynamic"
+ *
+ * Simulation Output:
+ * The simulation prints the throughput and the average delay of each DMG STA. With dynamic allocation, it also
+ * generates a trace of the grants issued by the DMG PCP/AP (Traces/Grants.csv).
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateDynamicAllocation");
+
+using namespace ns3;
+using namespace std;
+
+/* Network Nodes */
+Ptr<DmgApWifiMac> apWifiMac;
+std::vector<Ptr<DmgStaWifiMac> > staWifiMacs;
+
+/*** Access Point Variables ***/
+uint32_t numSTAs = 4;                           /* The number of DMG STAs. */
+uint32_t assoicatedStations = 0;                /* Total number of assoicated stations with the AP. */
+Ptr<DmgDynamicAllocator> allocator;             /* Channel time allocator of the DMG PCP/AP. */
+
+/**
+ * The queue state reported by a DMG STA in its SPR: the bytes buffered in its SP queue and in its best effort EDCA
+ * queue, which holds the frames waiting for a CBAP.
+ */
+uint64_t
+GetQueueState (Ptr<DmgStaWifiMac> staWifiMac)
+{
+  PointerValue spQueue, beTxop;
+  staWifiMac->GetAttribute ("SPQueue", spQueue);
+  staWifiMac->GetAttribute ("BE_Txop", beTxop);
+  Ptr<WifiMacQueue> queue = spQueue.Get<WifiMacQueue> ();
+  Ptr<WifiMacQueue> beQueue = beTxop.Get<QosTxop> ()->GetWifiMacQueue ();
+  uint64_t bytes = queue->GetNBytes ();
+  if (beQueue != queue)
+    {
+      bytes += beQueue->GetNBytes ();
+    }
+  return bytes;
+}
+
+void
+GrantIssued (Ptr<OutputStreamWrapper> stream, uint8_t srcAid, uint8_t dstAid, uint64_t queueState, Time duration)
+{
+  *stream->GetStream () << Simulator::Now ().GetNanoSeconds () << "," << uint16_t (srcAid) << "," << uint16_t (dstAid)
+                        << "," << queueState << "," << duration.GetMicroSeconds () << std::endl;
+}
+
+void
+StationAssoicated (Ptr<DmgStaWifiMac> staWifiMac, Mac48Address address, uint16_t aid)
+{
+  std::cout << "DMG STA " << staWifiMac->GetAddress () << " associated with DMG PCP/AP " << address
+            << ", Association ID (AID) = " << aid << std::endl;
+  assoicatedStations++;
+  if (assoicatedStations == numSTAs)
+    {
+      std::cout << "All DMG STAs associated, allocating service periods" << std::endl;
+      for (uint32_t i = 0; i < numSTAs; i++)
+        {
+          allocator->AddStation (staWifiMacs[i]->GetAssociationID (), AID_AP, MakeBoundCallback (&GetQueueState, staWifiMacs[i]));
+        }
+      allocator->Start ();
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t payloadSize = 1448;                  /* Transport Layer Payload size in bytes. */
+  string dataRate = "1000Mbps";                 /* Application Layer Data Rate during the ON periods. */
+  double onTime = 0.01;                         /* Mean duration of the ON periods in seconds. */
+  double offTime = 0.03;                        /* Mean duration of the OFF periods in seconds. */
+  string allocation = "dynamic";                /* Channel time allocation scheme (static or dynamic). */
+  uint32_t beaconInterval = 20480;              /* The beacon interval in microseconds. */
+  string msduAggSize = MAX_DMG_AMSDU_LENGTH;    /* The maximum aggregation size for A-MSDU in Bytes. */
+  string mpduAggSize = "0";                     /* The maximum aggregation size for A-MPDU in Bytes. */
+  string queueSize = "10000p";                  /* Wifi MAC Queue Size. */
+  string phyMode = "DMG_MCS12";                 /* Type of the Physical Layer. */
+  bool verbose = false;                         /* Print Logging Information. */
+  double simulationTime = 10;                   /* Simulation time in seconds. */
+  bool pcapTracing = false;                     /* PCAP Tracing is enabled or not. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("payloadSize", "Payload size in bytes", payloadSize);
+  cmd.AddValue ("dataRate", "Data rate for OnOff Application during the ON periods", dataRate);
+  cmd.AddValue ("onTime", "Mean duration of the ON periods in seconds", onTime);
+  cmd.AddValue ("offTime", "Mean duration of the OFF periods in seconds", offTime);
+  cmd.AddValue ("numSTAs", "The number of DMG STAs", numSTAs);
+  cmd.AddValue ("allocation", "Channel time allocation scheme: static or dynamic", allocation);
+  cmd.AddValue ("beaconInterval", "The beacon interval in microseconds", beaconInterval);
+  cmd.AddValue ("msduAggSize", "The maximum aggregation size for A-MSDU in Bytes", msduAggSize);
+  cmd.AddValue ("queueSize", "The size of the Wifi Mac Queue", queueSize);
+  cmd.AddValue ("phyMode", "802.11ad PHY Mode", phyMode);
+  cmd.AddValue ("verbose", "turn on all WifiNetDevice log components", verbose);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("pcap", "Enable PCAP Tracing", pcapTracing);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF ((allocation != "static") && (allocation != "dynamic"), "Unknown allocation scheme " << allocation);
+
+  /* Validate A-MSDU and A-MPDU values */
+  ValidateFrameAggregationAttributes (msduAggSize, mpduAggSize);
+  /* Configure RTS/CTS and Fragmentation */
+  ConfigureRtsCtsAndFragmenatation ();
+  /* Wifi MAC Queue Parameters */
+  ChangeQueueSize (queueSize);
+
+  /**** DmgWifiHelper is a meta-helper ****/
+  DmgWifiHelper wifi;
+
+  /* Basic setup */
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ad);
+
+  /* Turn on logging */
+  if (verbose)
+    {
+      wifi.EnableLogComponents ();
+      LogComponentEnable ("EvaluateDynamicAllocation", LOG_LEVEL_ALL);
+    }
+
+  /**** Set up Channel ****/
+  DmgWifiChannelHelper wifiChannel ;
+  /* Simple propagation delay model */
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  /* Friis model with standard-specific wavelength */
+  wifiChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel", "Frequency", DoubleValue (60.48e9));
+
+  /**** Setup physical layer ****/
+  DmgWifiPhyHelper wifiPhy = DmgWifiPhyHelper::Default ();
+  /* Nodes will be added to the channel we set up earlier */
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  /* All nodes transmit at 10 dBm == 10 mW, no adaptation */
+  wifiPhy.Set ("TxPowerStart", DoubleValue (10.0));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (10.0));
+  wifiPhy.Set ("TxPowerLevels", UintegerValue (1));
+  /* Set operating channel */
+  wifiPhy.Set ("ChannelNumber", UintegerValue (2));
+  /* Set default algorithm for all nodes to be constant rate */
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue (phyMode));
+
+  /* Make the DMG PCP/AP and the DMG STAs */
+  Ptr<Node> apNode = CreateObject<Node> ();
+  NodeContainer staNodes;
+  staNodes.Create (numSTAs);
+
+  /* Add a DMG upper mac */
+  DmgWifiMacHelper wifiMac = DmgWifiMacHelper::Default ();
+
+  /* Install DMG PCP/AP Node */
+  Ssid ssid = Ssid ("DynamicAllocation");
+  wifiMac.SetType ("ns3::DmgApWifiMac",
+                   "Ssid", SsidValue(ssid),
+                   "BE_MaxAmpduSize", StringValue (mpduAggSize),
+                   "BE_MaxAmsduSize", StringValue (msduAggSize),
+                   "SSSlotsPerABFT", UintegerValue (8), "SSFramesPerSlot", UintegerValue (8),
+                   "BeaconInterval", TimeValue (MicroSeconds (beaconInterval)));
+
+  /* Set Analytical Codebook for the DMG Devices */
+  wifi.SetCodebook ("ns3::CodebookAnalytical",
+                    "CodebookType", EnumValue (SIMPLE_CODEBOOK),
+                    "Antennas", UintegerValue (1),
+                    "Sectors", UintegerValue (8));
+
+  NetDeviceContainer apDevice;
+  apDevice = wifi.Install (wifiPhy, wifiMac, apNode);
+
+  /* Install DMG STA Nodes */
+  wifiMac.SetType ("ns3::DmgStaWifiMac",
+                   "Ssid", SsidValue (ssid), "ActiveProbing", BooleanValue (false),
+                   "BE_MaxAmpduSize", StringValue (mpduAggSize),
+                   "BE_MaxAmsduSize", StringValue (msduAggSize));
+
+  NetDeviceContainer staDevices;
+  staDevices = wifi.Install (wifiPhy, wifiMac, staNodes);
+
+  /* Setting mobility model */
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));   /* DMG PCP/AP */
+  for (uint32_t i = 0; i < numSTAs; i++)
+    {
+      double angle = 2 * M_PI * i / numSTAs;
+      positionAlloc->Add (Vector (std::cos (angle), std::sin (angle), 0.0));
+    }
+
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (apNode);
+  mobility.Install (staNodes);
+
+  /* Internet stack*/
+  InternetStackHelper stack;
+  stack.Install (apNode);
+  stack.Install (staNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer apInterface;
+  apInterface = address.Assign (apDevice);
+  Ipv4InterfaceContainer staInterfaces;
+  staInterfaces = address.Assign (staDevices);
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* We do not want any ARP packets */
+  PopulateArpCache ();
+
+  /*** Install Applications ***/
+  for (uint32_t i = 0; i < numSTAs; i++)
+    {
+      /* Install Simple UDP Server on the DMG PCP/AP */
+      PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9000 + i));
+      sinkHelper.Install (apNode);
+
+      /* Install bursty UDP Transmitter on the DMG STA */
+      OnOffHelper src ("ns3::UdpSocketFactory", InetSocketAddress (apInterface.GetAddress (0), 9000 + i));
+      src.SetAttribute ("MaxPackets", UintegerValue (0));
+      src.SetAttribute ("PacketSize", UintegerValue (payloadSize));
+      src.SetAttribute ("OnTime", StringValue ("ns3::ExponentialRandomVariable[Mean=" + std::to_string (onTime) + "]"));
+      src.SetAttribute ("OffTime", StringValue ("ns3::ExponentialRandomVariable[Mean=" + std::to_string (offTime) + "]"));
+      src.SetAttribute ("DataRate", DataRateValue (DataRate (DataRate (dataRate).GetBitRate () * (i + 1) / numSTAs)));
+      ApplicationContainer srcApp = src.Install (staNodes.Get (i));
+      srcApp.Start (Seconds (1.0));
+    }
+
+  /* Enable Traces */
+  if (pcapTracing)
+    {
+      wifiPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
+      wifiPhy.EnablePcap ("Traces/AccessPoint", apDevice, false);
+      wifiPhy.EnablePcap ("Traces/STA", staDevices, false);
+    }
+
+  /* Stations */
+  apWifiMac = StaticCast<DmgApWifiMac> (StaticCast<WifiNetDevice> (apDevice.Get (0))->GetMac ());
+  for (uint32_t i = 0; i < numSTAs; i++)
+    {
+      Ptr<DmgStaWifiMac> staWifiMac = StaticCast<DmgStaWifiMac> (StaticCast<WifiNetDevice> (staDevices.Get (i))->GetMac ());
+      staWifiMac->TraceConnectWithoutContext ("Assoc", MakeBoundCallback (&StationAssoicated, staWifiMac));
+      staWifiMacs.push_back (staWifiMac);
+    }
+
+  /* Channel time allocation */
+  allocator = CreateObject<DmgDynamicAllocator> ();
+  allocator->SetAttribute ("Polling", BooleanValue (allocation == "dynamic"));
+  allocator->Setup (apWifiMac);
+  AsciiTraceHelper ascii;
+  Ptr<OutputStreamWrapper> grantStream = ascii.CreateFileStream ("Traces/Grants.csv");
+  *grantStream->GetStream () << "TIME,SRC_AID,DST_AID,QUEUE_STATE,DURATION" << std::endl;
+  allocator->TraceConnectWithoutContext ("Grant", MakeBoundCallback (&GrantIssued, grantStream));
+
+  /* Install FlowMonitor on all nodes */
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
+
+  Simulator::Stop (Seconds (simulationTime));
+  Simulator::Run ();
+
+  /* Print Results Summary */
+  monitor->CheckForLostPackets ();
+  FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
+  std::cout << "\nAllocation Scheme = " << allocation << ", Polling Periods = " << allocator->GetNPollingPeriods () << std::endl;
+  std::cout << std::left << std::setw (12) << "Flow"
+            << std::left << std::setw (20) << "Offered [Mbps]"
+            << std::left << std::setw (20) << "Throughput [Mbps]"
+            << std::left << std::setw (20) << "Avg Delay [ms]" << std::endl;
+  double totalThroughput = 0;
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator it = stats.begin (); it != stats.end (); ++it)
+    {
+      if (it->second.rxPackets == 0)
+        {
+          continue;
+        }
+      double throughput = it->second.rxBytes * 8.0 / ((simulationTime - 1) * 1e6);
+      totalThroughput += throughput;
+      std::cout << std::left << std::setw (12) << it->first
+                << std::left << std::setw (20) << it->second.txBytes * 8.0 / ((simulationTime - 1) * 1e6)
+                << std::left << std::setw (20) << throughput
+                << std::left << std::setw (20) << it->second.delaySum.GetSeconds () * 1e3 / it->second.rxPackets
+                << std::endl;
+    }
+  std::cout << "Total Throughput = " << totalThroughput << " [Mbps]" << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include "ns3/network-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "wifi-frame-descriptor.h"
 #include <complex>
 #include <iomanip>
 #include <string>
@@ -68,6 +69,7 @@ uint64_t receivedPacketsMac = 0;
 uint64_t transmittedPackets = 0;
 uint64_t droppedPackets = 0;
 uint64_t receivedPackets = 0;
+double phySnr = 0.0;
 
 void
 CalculateThroughput (void)
@@ -94,42 +96,22 @@ MacTxDataFailed (Mac48Address)
 }
 
 void
-PhyTxEnd (Ptr<const Packet> packet)
+PhyTx (const WifiFrameDescriptor &)
 {
-  WifiMacHeader hdr;
-  packet->PeekHeader (hdr);
-  if (hdr.IsData ())
-    {
-      transmittedPackets++;
-    }
+  transmittedPackets++;
 }
 
 void
-PhyRxDrop (Ptr<const Packet> packet)
+PhyRxDrop (const WifiFrameDescriptor &)
 {
-  WifiMacHeader hdr;
-  packet->PeekHeader (hdr);
-  SnrTag tag;
-  packet->PeekPacketTag (tag);
-  if (hdr.IsData ())
-    {
-      droppedPackets++;
-//      snr+=RatioToDb(tag.Get());
-    }
+  droppedPackets++;
 }
 
 void
-PhyRxEnd (Ptr<const Packet> packet)
+PhyRxOk (const WifiFrameDescriptor &descriptor)
 {
-  WifiMacHeader hdr;
-  packet->PeekHeader (hdr);
-  SnrTag tag;
-  packet->PeekPacketTag (tag);
-  if (hdr.IsData ())
-    {
-      receivedPackets++;
-//      snr+=RatioToDb(tag.Get());
-    }
+  receivedPackets++;
+  phySnr += DbToRatio (descriptor.snr);
 }
 
 void
@@ -309,10 +291,17 @@ main (int argc, char *argv[])
   staRemoteStationManager = staWifiNetDevice->GetRemoteStationManager ();
 
   /* Connect Traces */
-  apWifiPhy->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&PhyRxEnd));
-  apWifiPhy->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&PhyRxDrop));
+  /* The frame tracers hand over data frames only, without parsing the MAC header in the callbacks */
+  Ptr<WifiFrameTracer> apFrameTracer = CreateObject<WifiFrameTracer> ();
+  apFrameTracer->SetAttribute ("DataOnly", BooleanValue (true));
+  apFrameTracer->Install (apWifiPhy);
+  apFrameTracer->TraceConnectWithoutContext ("RxOk", MakeCallback (&PhyRxOk));
+  apFrameTracer->TraceConnectWithoutContext ("RxDrop", MakeCallback (&PhyRxDrop));
+  Ptr<WifiFrameTracer> staFrameTracer = CreateObject<WifiFrameTracer> ();
+  staFrameTracer->SetAttribute ("DataOnly", BooleanValue (true));
+  staFrameTracer->Install (staWifiPhy);
+  staFrameTracer->TraceConnectWithoutContext ("Tx", MakeCallback (&PhyTx));
   staWifiMac->TraceConnectWithoutContext ("Assoc", MakeBoundCallback (&StationAssoicated, staWifiMac));
-  staWifiPhy->TraceConnectWithoutContext ("PhyTxEnd", MakeCallback (&PhyTxEnd));
   staRemoteStationManager->TraceConnectWithoutContext ("MacTxDataFailed", MakeCallback (&MacTxDataFailed));
   staRemoteStationManager->TraceConnectWithoutContext ("MacRxOK", MakeCallback (&MacRxOk));
 
@@ -367,6 +356,10 @@ main (int argc, char *argv[])
   std::cout << "  Number of Tx Packets:         " << transmittedPackets << std::endl;
   std::cout << "  Number of Rx Packets:         " << receivedPackets << std::endl;
   std::cout << "  Number of Rx Dropped Packets: " << droppedPackets << std::endl;
+  if (receivedPackets > 0)
+    {
+      std::cout << "  Average PHY SNR [dB]:         " << RatioToDb (phySnr / double (receivedPackets)) << std::endl;
+    }
 
   std::cout << "  Average SNR: " << RatioToDb(snr / double(receivedPacketsMac)) << std::endl;
   AsciiTraceHelper ascii;
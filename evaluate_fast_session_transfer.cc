@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "common-functions.h"
+#include "fast-session-transfer.h"
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Evaluate the fast session transfer (FST) between the DMG band and a legacy 5 GHz band of multi-band devices.
+ * The session runs over the DMG link until a blockage breaks it. The FST manager detects the failure and moves
+ * the session to the IEEE 802.11ac link. When the blockage disappears, it moves the session back to the DMG link.
+ *
+ * Network Topology:
+ * The scenario consists of two multi-band devices, each one having a DMG Ad-Hoc interface and an IEEE 802.11ac
+ * Ad-Hoc interface.
+ *
+ *      Multi-Band Device (0,0)  ---- DMG (60 GHz) + 802.11ac (5 GHz) ---->  Multi-Band Device (+distance,0)
+ *
+ * Simulation Description:
+ * The right device sends UDP traffic to the DMG address of the left device. At blockageStart, the DMG link
+ * from the right to the left device is blocked (same blockage mechanism as test_beamformedlink_maintenance),
+ * and the blockage is removed at blockageEnd. The same scenario can be run with FST disabled to obtain the
+ * DMG-only baseline.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_fast_session_transfer --fst=1 --blockageStart=1 --blockageEnd=2"
+ * ./waf --run "evaluate_fast_session_transfer --fst=0 --blockageStart=1 --blockageEnd=2"
+ *
+ * Simulation Output:
+ * 1. The throughput every throughputInterval.
+ * 2. The session transfer events and their latency with respect to the blockage events.
+ * 3. The throughput before, during and after the blockage.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateFastSessionTransfer");
+
+using namespace ns3;
+using namespace std;
+
+/*** Application Layer Variables ***/
+Ptr<PacketSink> sink;
+uint64_t lastTotalRx = 0;
+double averageThroughput = 0;
+Time throughputInterval = MilliSeconds (10);
+
+/*** Blockage Variables ***/
+Ptr<DmgWifiChannel> mmWaveChannel;
+double blockageValue = -100;              /* Link loss due to blockage in dB. */
+Time blockageStartTime;
+Time blockageEndTime;
+Time transferToLegacyTime;
+Time transferToDmgTime;
+uint64_t rxBeforeBlockage = 0;            /* Bytes received before the blockage. */
+uint64_t rxAfterBlockage = 0;             /* Bytes received until the end of the blockage. */
+
+void
+CalculateThroughput (void)
+{
+  double thr = CalculateSingleStreamThroughput (sink, lastTotalRx, averageThroughput);
+  /* CalculateSingleStreamThroughput assumes an interval of 100 ms */
+  thr *= 0.1 / throughputInterval.GetSeconds ();
+  std::cout << std::left << std::setw (12) << Simulator::Now ().GetSeconds ()
+            << std::left << std::setw (12) << thr << std::endl;
+  Simulator::Schedule (throughputInterval, &CalculateThroughput);
+}
+
+double
+DoInsertBlockage (void)
+{
+  return blockageValue;
+}
+
+void
+BlockLink (Ptr<DmgWifiPhy> srcWifiPhy, Ptr<DmgWifiPhy> dstWifiPhy)
+{
+  std::cout << "Blockage inserted at " << Simulator::Now ().GetSeconds () << std::endl;
+  rxBeforeBlockage = sink->GetTotalRx ();
+  mmWaveChannel->AddBlockage (&DoInsertBlockage, srcWifiPhy, dstWifiPhy);
+}
+
+void
+UnblockLink (void)
+{
+  std::cout << "Blockage removed at " << Simulator::Now ().GetSeconds () << std::endl;
+  rxAfterBlockage = sink->GetTotalRx ();
+  mmWaveChannel->RemoveBlockage ();
+}
+
+void
+SessionTransferred (FstBand band)
+{
+  if (band == FST_LEGACY_BAND)
+    {
+      transferToLegacyTime = Simulator::Now ();
+      std::cout << "Session transferred to the legacy band at " << Simulator::Now ().GetSeconds () << std::endl;
+    }
+  else
+    {
+      transferToDmgTime = Simulator::Now ();
+      std::cout << "Session transferred to the DMG band at " << Simulator::Now ().GetSeconds () << std::endl;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool fst = true;                                /* Enable the fast session transfer. */
+  uint32_t payloadSize = 1448;                    /* Application payload size in bytes. */
+  string dataRate = "300Mbps";                    /* Application data rate. */
+  string dmgMcs = "12";                           /* The MCS of the DMG link. */
+  string legacyMcs = "VhtMcs7";                   /* The MCS of the IEEE 802.11ac link. */
+  double distance = 3.0;                          /* The distance between the two devices in meters. */
+  double blockageStart = 1.0;                     /* The start of the blockage in seconds. */
+  double blockageEnd = 2.0;                       /* The end of the blockage in seconds. */
+  uint32_t failureThreshold = 3;                  /* The number of dropped MSDUs before transferring the session. */
+  double probeInterval = 10;                      /* The interval between DMG link probes in milliseconds. */
+  double simulationTime = 3;                      /* Simulation time in seconds. */
+  bool pcapTracing = false;                       /* PCAP Tracing is enabled or not. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("fst", "Enable the fast session transfer to the legacy band", fst);
+  cmd.AddValue ("payloadSize", "Application payload size in bytes", payloadSize);
+  cmd.AddValue ("dataRate", "The data rate of the OnOff application", dataRate);
+  cmd.AddValue ("dmgMcs", "The MCS of the DMG link", dmgMcs);
+  cmd.AddValue ("legacyMcs", "The MCS of the IEEE 802.11ac link", legacyMcs);
+  cmd.AddValue ("distance", "The distance between the two devices in meters", distance);
+  cmd.AddValue ("blockageStart", "The start of the blockage in seconds", blockageStart);
+  cmd.AddValue ("blockageEnd", "The end of the blockage in seconds", blockageEnd);
+  cmd.AddValue ("failureThreshold", "The number of dropped MSDUs before transferring the session", failureThreshold);
+  cmd.AddValue ("probeInterval", "The interval between DMG link probes in milliseconds", probeInterval);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("pcap", "Enable PCAP Tracing", pcapTracing);
+  cmd.Parse (argc, argv);
+
+  /* Global params: no fragmentation, no RTS/CTS, fixed rate for all packets */
+  ConfigureRtsCtsAndFragmenatation ();
+  Config::SetDefault ("ns3::FastSessionTransfer::FailureThreshold", UintegerValue (failureThreshold));
+  Config::SetDefault ("ns3::FastSessionTransfer::ProbeInterval", TimeValue (MilliSeconds (probeInterval)));
+
+  /* Make two multi-band nodes */
+  NodeContainer wifiNodes;
+  wifiNodes.Create (2);
+  Ptr<Node> leftNode = wifiNodes.Get (0);
+  Ptr<Node> rightNode = wifiNodes.Get (1);
+
+  /**** Setup the DMG band ****/
+  DmgWifiHelper dmgWifi;
+  dmgWifi.SetStandard (WIFI_PHY_STANDARD_80211ad);
+
+  DmgWifiChannelHelper dmgChannel;
+  dmgChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  dmgChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel", "Frequency", DoubleValue (60.48e9));
+
+  DmgWifiPhyHelper dmgPhy = DmgWifiPhyHelper::Default ();
+  dmgPhy.SetChannel (dmgChannel.Create ());
+  dmgPhy.Set ("TxPowerStart", DoubleValue (10.0));
+  dmgPhy.Set ("TxPowerEnd", DoubleValue (10.0));
+  dmgPhy.Set ("TxPowerLevels", UintegerValue (1));
+  dmgPhy.Set ("ChannelNumber", UintegerValue (2));
+  dmgWifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("DMG_MCS" + dmgMcs));
+
+  /* Set Analytical Codebook for the DMG Devices */
+  dmgWifi.SetCodebook ("ns3::CodebookAnalytical",
+                       "CodebookType", EnumValue (SIMPLE_CODEBOOK),
+                       "Antennas", UintegerValue (1),
+                       "Sectors", UintegerValue (8));
+
+  DmgWifiMacHelper dmgMac = DmgWifiMacHelper::Default ();
+  dmgMac.SetType ("ns3::DmgAdhocWifiMac",
+                  "BE_MaxAmpduSize", UintegerValue (262143),
+                  "BE_MaxAmsduSize", UintegerValue (7935));
+
+  NetDeviceContainer dmgDevices;
+  dmgDevices.Add (dmgWifi.Install (dmgPhy, dmgMac, leftNode));
+  dmgDevices.Add (dmgWifi.Install (dmgPhy, dmgMac, rightNode));
+
+  /* Set the best antenna configurations */
+  Ptr<WifiNetDevice> leftDmgDevice = StaticCast<WifiNetDevice> (dmgDevices.Get (0));
+  Ptr<WifiNetDevice> rightDmgDevice = StaticCast<WifiNetDevice> (dmgDevices.Get (1));
+  Ptr<DmgAdhocWifiMac> leftDmgMac = StaticCast<DmgAdhocWifiMac> (leftDmgDevice->GetMac ());
+  Ptr<DmgAdhocWifiMac> rightDmgMac = StaticCast<DmgAdhocWifiMac> (rightDmgDevice->GetMac ());
+  leftDmgMac->AddAntennaConfig (1, 1, 1, 1, rightDmgMac->GetAddress ());
+  rightDmgMac->AddAntennaConfig (5, 1, 5, 1, leftDmgMac->GetAddress ());
+  leftDmgMac->SteerAntennaToward (rightDmgMac->GetAddress ());
+  rightDmgMac->SteerAntennaToward (leftDmgMac->GetAddress ());
+
+  /**** Setup the legacy band ****/
+  WifiHelper legacyWifi;
+  legacyWifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  legacyWifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                      "DataMode", StringValue (legacyMcs),
+                                      "ControlMode", StringValue ("VhtMcs0"));
+
+  YansWifiChannelHelper legacyChannel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper legacyPhy = YansWifiPhyHelper::Default ();
+  legacyPhy.SetChannel (legacyChannel.Create ());
+  legacyPhy.Set ("ChannelWidth", UintegerValue (80));
+
+  WifiMacHelper legacyMac;
+  legacyMac.SetType ("ns3::AdhocWifiMac");
+
+  NetDeviceContainer legacyDevices = legacyWifi.Install (legacyPhy, legacyMac, wifiNodes);
+
+  /* Setting mobility model */
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (distance, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiNodes);
+
+  /* Internet stack */
+  InternetStackHelper stack;
+  stack.Install (wifiNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer dmgInterfaces = address.Assign (dmgDevices);
+  address.SetBase ("10.0.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer legacyInterfaces = address.Assign (legacyDevices);
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* We do not want any ARP packets */
+  PopulateArpCache ();
+
+  /* Fast session transfer managers, one per session end */
+  if (fst)
+    {
+      Ptr<FastSessionTransfer> leftFst = CreateObject<FastSessionTransfer> ();
+      leftFst->Setup (leftDmgDevice, legacyDevices.Get (0), rightDmgMac->GetAddress (),
+                      dmgInterfaces.GetAddress (1), legacyInterfaces.GetAddress (1));
+      leftNode->AggregateObject (leftFst);
+      Ptr<FastSessionTransfer> rightFst = CreateObject<FastSessionTransfer> ();
+      rightFst->Setup (rightDmgDevice, legacyDevices.Get (1), leftDmgMac->GetAddress (),
+                       dmgInterfaces.GetAddress (0), legacyInterfaces.GetAddress (0));
+      rightNode->AggregateObject (rightFst);
+      rightFst->TraceConnectWithoutContext ("SessionTransfer", MakeCallback (&SessionTransferred));
+    }
+
+  /* Install Simple UDP Server on the left device */
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9999));
+  ApplicationContainer sinkApp = sinkHelper.Install (leftNode);
+  sink = StaticCast<PacketSink> (sinkApp.Get (0));
+  sinkApp.Start (Seconds (0.0));
+
+  /* Install UDP Transmitter on the right device, the session address is the DMG address of the left device */
+  OnOffHelper src ("ns3::UdpSocketFactory", InetSocketAddress (dmgInterfaces.GetAddress (0), 9999));
+  src.SetAttribute ("MaxBytes", UintegerValue (0));
+  src.SetAttribute ("PacketSize", UintegerValue (payloadSize));
+  src.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1e6]"));
+  src.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  src.SetAttribute ("DataRate", DataRateValue (DataRate (dataRate)));
+  ApplicationContainer srcApp = src.Install (rightNode);
+  srcApp.Start (Seconds (0.0));
+  srcApp.Stop (Seconds (simulationTime));
+
+  /* Blockage of the DMG link */
+  mmWaveChannel = StaticCast<DmgWifiChannel> (leftDmgDevice->GetChannel ());
+  blockageStartTime = Seconds (blockageStart);
+  blockageEndTime = Seconds (blockageEnd);
+  Simulator::Schedule (blockageStartTime, &BlockLink,
+                       StaticCast<DmgWifiPhy> (rightDmgDevice->GetPhy ()), StaticCast<DmgWifiPhy> (leftDmgDevice->GetPhy ()));
+  Simulator::Schedule (blockageEndTime, &UnblockLink);
+
+  if (pcapTracing)
+    {
+      dmgPhy.SetPcapDataLinkType (YansWifiPhyHelper::DLT_IEEE802_11_RADIO);
+      dmgPhy.EnablePcap ("Traces/FstDmg", dmgDevices, false);
+      legacyPhy.SetPcapDataLinkType (YansWifiPhyHelper::DLT_IEEE802_11_RADIO);
+      legacyPhy.EnablePcap ("Traces/FstLegacy", legacyDevices, false);
+    }
+
+  /* Print Output */
+  std::cout << std::left << std::setw (12) << "Time [s]"
+            << std::left << std::setw (12) << "Throughput [Mbps]" << std::endl;
+
+  Simulator::Schedule (throughputInterval, &CalculateThroughput);
+  Simulator::Stop (Seconds (simulationTime + 0.101));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  /* Print Results Summary */
+  uint64_t totalRx = sink->GetTotalRx ();
+  double afterDuration = simulationTime - blockageEnd;
+  std::cout << "\nResults Summary (FST " << (fst ? "enabled" : "disabled") << "):" << std::endl;
+  std::cout << "  Throughput before blockage: " << rxBeforeBlockage * 8.0 / (blockageStart * 1e6) << " Mbps" << std::endl;
+  std::cout << "  Throughput during blockage: "
+            << (rxAfterBlockage - rxBeforeBlockage) * 8.0 / ((blockageEnd - blockageStart) * 1e6) << " Mbps" << std::endl;
+  if (afterDuration > 0)
+    {
+      std::cout << "  Throughput after blockage:  " << (totalRx - rxAfterBlockage) * 8.0 / (afterDuration * 1e6)
+                << " Mbps" << std::endl;
+    }
+  if (fst && !transferToLegacyTime.IsZero ())
+    {
+      std::cout << "  DMG -> legacy switching latency: "
+                << (transferToLegacyTime - blockageStartTime).GetMicroSeconds () / 1e3 << " ms" << std::endl;
+    }
+  if (fst && (transferToDmgTime > blockageEndTime))
+    {
+      std::cout << "  Legacy -> DMG switching latency: "
+                << (transferToDmgTime - blockageEndTime).GetMicroSeconds () / 1e3 << " ms" << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "dmg-frame-template-cache.h"
+#include <chrono>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Micro-benchmark of the DMG frame template cache for the SSW frames of a sector sweep. Each SSW frame of a sweep
+ * differs only in its CDOWN, sector ID and DMG antenna ID, so the cache serializes the first frame of the sweep and
+ * patches the SSW field of the following ones.
+ *
+ * Simulation Description:
+ * The sweeps of numSweeps beacon intervals are generated twice: once by serializing the WifiMacHeader and the
+ * CtrlDMG_SSW header (SSW and SSW Feedback fields) for every frame, as the MAC does, and once through the cache,
+ * which is invalidated at the start of each beacon interval. Both sets of frames are compared byte by byte and the
+ * frames built from a template must carry the tags of the template.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_frame_template_cache --sectors=64 --numSweeps=10000"
+ *
+ * Simulation Output:
+ * The time per frame of both paths, the hits, misses and stores of the cache, and whether the frames are identical.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateFrameTemplateCache");
+
+using namespace ns3;
+using namespace std;
+
+/**
+ * Serialize an SSW frame as the MAC does: the CtrlDMG_SSW header with its SSW
+ * and SSW Feedback fields, then the MAC header.
+ */
+Ptr<Packet>
+SerializeSswFrame (const WifiMacHeader &hdr, uint16_t cdown, uint8_t sectorId, uint8_t antennaId,
+                   uint16_t totalSectors, uint8_t totalAntennas)
+{
+  DMG_SSW_Field ssw;
+  ssw.SetDirection (BeamformingInitiator);
+  ssw.SetCountDown (cdown);
+  ssw.SetSectorID (sectorId);
+  ssw.SetDMGAntennaID (antennaId);
+  DMG_SSW_FBCK_Field sswFeedback;
+  sswFeedback.IsPartOfISS (true);
+  sswFeedback.SetSector (totalSectors);
+  sswFeedback.SetDMGAntenna (totalAntennas);
+  sswFeedback.SetPollRequired (false);
+  CtrlDMG_SSW sswFrame;
+  sswFrame.SetSswField (ssw);
+  sswFrame.SetSswFeedbackField (sswFeedback);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (sswFrame);
+  packet->AddHeader (hdr);
+  packet->AddPacketTag (SnrTag ());
+  return packet;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t sectors = 64;                        /* The number of sectors swept per beacon interval. */
+  uint32_t antennas = 1;                        /* The number of DMG antennas. */
+  uint32_t numSweeps = 10000;                   /* The number of beacon intervals. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("sectors", "The number of sectors per DMG antenna", sectors);
+  cmd.AddValue ("antennas", "The number of DMG antennas", antennas);
+  cmd.AddValue ("numSweeps", "The number of sector sweeps, one per beacon interval", numSweeps);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (sectors > 64, "The Sector ID field is limited to 64 sectors");
+  NS_ABORT_MSG_IF (antennas > 4, "The DMG Antenna ID field is limited to 4 antennas");
+  NS_ABORT_MSG_IF (sectors * antennas > 512, "CDOWN is limited to 511");
+
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_CTL_DMG_SSW);
+  hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  hdr.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
+  hdr.SetDuration (MicroSeconds (100));
+  NS_ABORT_MSG_IF (hdr.GetSerializedSize () != DMG_SSW_FRAME_SSW_OFFSET,
+                   "The SSW field offset does not match the MAC header of the SSW frame");
+
+  uint32_t frames = sectors * antennas;
+  double total = double (frames) * numSweeps;
+
+  /* Reference: serialize every frame */
+  auto start = std::chrono::steady_clock::now ();
+  uint64_t referenceBytes = 0;
+  for (uint32_t sweep = 0; sweep < numSweeps; sweep++)
+    {
+      uint16_t cdown = frames - 1;
+      for (uint32_t antenna = 0; antenna < antennas; antenna++)
+        {
+          for (uint32_t sector = 0; sector < sectors; sector++, cdown--)
+            {
+              Ptr<Packet> packet = SerializeSswFrame (hdr, cdown, uint8_t (sector), uint8_t (antenna), frames, antennas);
+              referenceBytes += packet->GetSize ();
+            }
+        }
+    }
+  auto end = std::chrono::steady_clock::now ();
+  double referenceTime = std::chrono::duration<double, std::nano> (end - start).count () / total;
+
+  /* Cache: serialize the first frame of each beacon interval only */
+  DmgFrameTemplateCache cache;
+  start = std::chrono::steady_clock::now ();
+  uint64_t cacheBytes = 0;
+  for (uint32_t sweep = 0; sweep < numSweeps; sweep++)
+    {
+      cache.Invalidate ();
+      uint16_t cdown = frames - 1;
+      for (uint32_t antenna = 0; antenna < antennas; antenna++)
+        {
+          for (uint32_t sector = 0; sector < sectors; sector++, cdown--)
+            {
+              Ptr<Packet> packet = cache.CreateFrame (0, 0, cdown, uint8_t (sector), uint8_t (antenna));
+              if (packet == 0)
+                {
+                  packet = SerializeSswFrame (hdr, cdown, uint8_t (sector), uint8_t (antenna), frames, antennas);
+                  cache.StoreTemplate (0, packet, DMG_SSW_FRAME_SSW_OFFSET);
+                }
+              cacheBytes += packet->GetSize ();
+            }
+        }
+    }
+  end = std::chrono::steady_clock::now ();
+  double cacheTime = std::chrono::duration<double, std::nano> (end - start).count () / total;
+
+  /* Compare one sweep of both paths byte by byte */
+  bool identical = (referenceBytes == cacheBytes);
+  cache.Invalidate ();
+  uint16_t cdown = frames - 1;
+  for (uint32_t antenna = 0; antenna < antennas; antenna++)
+    {
+      for (uint32_t sector = 0; sector < sectors; sector++, cdown--)
+        {
+          Ptr<Packet> reference = SerializeSswFrame (hdr, cdown, uint8_t (sector), uint8_t (antenna), frames, antennas);
+          Ptr<Packet> packet = cache.CreateFrame (0, 0, cdown, uint8_t (sector), uint8_t (antenna));
+          if (packet == 0)
+            {
+              cache.StoreTemplate (0, reference, DMG_SSW_FRAME_SSW_OFFSET);
+              continue;
+            }
+          std::vector<uint8_t> a (reference->GetSize ()), b (packet->GetSize ());
+          reference->CopyData (a.data (), a.size ());
+          packet->CopyData (b.data (), b.size ());
+          SnrTag tag;
+          identical = identical && (a == b) && packet->PeekPacketTag (tag);
+        }
+    }
+
+  std::cout << std::left << std::setw (20) << "Serialize [ns]"
+            << std::left << std::setw (20) << "Template [ns]"
+            << std::left << std::setw (12) << "Speed-up"
+            << std::left << std::setw (12) << "Hits"
+            << std::left << std::setw (12) << "Misses"
+            << std::left << std::setw (12) << "Stores"
+            << std::left << std::setw (12) << "Identical" << std::endl;
+  std::cout << std::left << std::setw (20) << referenceTime
+            << std::left << std::setw (20) << cacheTime
+            << std::left << std::setw (12) << referenceTime / cacheTime
+            << std::left << std::setw (12) << cache.GetNHits ()
+            << std::left << std::setw (12) << cache.GetNMisses ()
+            << std::left << std::setw (12) << cache.GetNStores ()
+            << std::left << std::setw (12) << (identical ? "yes" : "no") << std::endl;
+
+  return 0;
+}
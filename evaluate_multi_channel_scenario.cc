@@ -11,6 +11,7 @@
 #include "ns3/spectrum-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "edmg-dynamic-bonding.h"
 #include <iomanip>
 #include <sstream>
 
@@ -63,6 +64,12 @@
  *
  * ./waf --run "evaluate_multi_channel_scenario --applicationType=onoff --socketType=ns3::UdpSocketFactory --csv=false --network1Channel=9 --dataRate=16Gbps --phyMode=EDMG_SC_MCS21 --qdChannelFolder=MultiChannelScenarioSingleLink --twoNetworks=false --pcap=1 --snapshotLength=120"
  *
+ * To let each network select its bandwidth dynamically within its channel according to the activity on its secondary
+ * channels, e.g. the first network falls back from 8.64 GHz (channel 25) to 4.32 GHz (channel 9) or 2.16 GHz (channel 1)
+ * when the second network transmits over channel 3 or 2, type the following commands and compare with static bonding:
+ * ./waf --run "evaluate_multi_channel_scenario --csv=false --network1Channel=25 --network2Channel=3 --dynamicBonding=false"
+ * ./waf --run "evaluate_multi_channel_scenario --csv=false --network1Channel=25 --network2Channel=3 --dynamicBonding=true"
+ *
  * Simulation Output:
  */
 
@@ -311,6 +318,7 @@ main (int argc, char *argv[])
   string qdChannelFolder = "MultiChannelScenario";        /* The name of the folder containing the QD-Channel files. */
   uint8_t network1Channel = 1;                            /* The channel number of the first network. */
   uint8_t network2Channel = 2;                            /* The channel number of the second network. */
+  bool dynamicBonding = false;                            /* Select the bandwidth from the activity on the secondary channels. */
 
   /* Command line argument parser setup. */
   CommandLine cmd;
@@ -330,6 +338,8 @@ main (int argc, char *argv[])
   cmd.AddValue ("phyMode", "802.11ad PHY Mode", phyMode);
   cmd.AddValue ("network1Channel", "The channel number of the first network", network1Channel);
   cmd.AddValue ("network2Channel", "The channel number of the second network", network2Channel);
+  cmd.AddValue ("dynamicBonding", "Select the bandwidth of each network within its channel from the activity "
+                "on the secondary channels", dynamicBonding);
   cmd.AddValue ("normalizeWeights", "Whether we normalize the antenna weights vector or not", normalizeWeights);
   cmd.AddValue ("enableJitter", "Enable Beacon Interval Jitter to randomize Beacon Interval start time", enableJitter);
   cmd.AddValue ("beaconJitter", "Beacon Jitter value in MicroSeconds", beaconJitter);
@@ -531,6 +541,26 @@ main (int argc, char *argv[])
       biCounter[dmgApWifiMac->GetAddress ()] = 0;
     }
 
+  /* Dynamic channel bonding, each network senses the devices of the other network */
+  std::vector<Ptr<EdmgDynamicBonding> > bondingList;
+  if (dynamicBonding)
+    {
+      for (uint32_t i = 0; i < parallelLinks; i++)
+        {
+          Ptr<EdmgDynamicBonding> bonding = CreateObject<EdmgDynamicBonding> ();
+          bonding->Setup (StaticCast<WifiNetDevice> (apDevices.Get (i)), StaticCast<WifiNetDevice> (staDevices.Get (i)));
+          for (uint32_t j = 0; j < parallelLinks; j++)
+            {
+              if (j != i)
+                {
+                  bonding->AddInterferer (StaticCast<WifiNetDevice> (apDevices.Get (j)));
+                  bonding->AddInterferer (StaticCast<WifiNetDevice> (staDevices.Get (j)));
+                }
+            }
+          bondingList.push_back (bonding);
+        }
+    }
+
   /* Enable Traces */
   if (pcapTracing)
     {
@@ -570,6 +600,26 @@ main (int argc, char *argv[])
     {
       PrintApplicationLayerAndFlowMonitorStatistics (flowmon, monitor, communicationPairList,
                                                      applicationType, simulationTime - 0.1);
+
+      if (dynamicBonding)
+        {
+          std::cout << "\nDynamic Channel Bonding: Fraction of Time per Bandwidth" << std::endl;
+          std::cout << std::left << std::setw (12) << "Network"
+                    << std::left << std::setw (12) << "2.16 GHz"
+                    << std::left << std::setw (12) << "4.32 GHz"
+                    << std::left << std::setw (12) << "6.48 GHz"
+                    << std::left << std::setw (12) << "8.64 GHz"
+                    << std::left << std::setw (12) << "Changes" << std::endl;
+          for (uint32_t i = 0; i < bondingList.size (); i++)
+            {
+              std::cout << std::left << std::setw (12) << i + 1;
+              for (uint8_t ncb = 1; ncb <= 4; ncb++)
+                {
+                  std::cout << std::left << std::setw (12) << bondingList[i]->GetTimeFraction (ncb);
+                }
+              std::cout << std::left << std::setw (12) << bondingList[i]->GetNChanges () << std::endl;
+            }
+        }
     }
 
   return 0;
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "common-functions.h"
+#include "multi-fidelity-sweep.h"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+/**
+ * Simulation Objective:
+ * Explore a wide design space (MCS, A-MSDU and A-MPDU aggregation sizes) of a DMG link with a
+ * multi-fidelity sweep. Most design points are clearly uninteresting, so every point is first
+ * evaluated with a cheap abstraction and the full simulation is only run where it matters.
+ *
+ * Network Topology:
+ * The scenario consists of two DMG AdHoc STAs.
+ *
+ *          DMG STA [1] (0,0)                       DMG STA [2] (+1,0)
+ *
+ * Simulation Description:
+ * The DMG STA[2] generates a saturating UDP traffic towards the DMG STA [1]. The sweep is done
+ * in two passes:
+ * 1. Low fidelity: every design point is evaluated either with an analytic model of the EDCA
+ *    transmission cycle (--lowFidelity=analytic) or with a short simulation where the Friis
+ *    channel is replaced by a constant loss matrix (--lowFidelity=short).
+ * 2. Full fidelity: the points are ranked on the low fidelity throughput, and only the top
+ *    fraction (--topFraction) plus the points within a relative margin (--boundaryMargin) of
+ *    the cut-off throughput are simulated for --simulationTime seconds.
+ *
+ * Running Simulation:
+ * ./waf --run "evaluate_multi_fidelity_sweep"
+ *
+ * To use short simulations as the low fidelity model and fully simulate the best 10% of the points:
+ * ./waf --run "evaluate_multi_fidelity_sweep --lowFidelity=short --topFraction=0.1"
+ *
+ * To sweep other values, give comma separated lists:
+ * ./waf --run "evaluate_multi_fidelity_sweep --mcsList=4,8,12 --msduAggSizes=0,7935 --mpduAggSizes=0,65535,262143"
+ *
+ * Simulation Output:
+ * The simulation generates the following traces:
+ * 1. A table with the two fidelities side by side and the wall clock time of each pass.
+ * 2. The same table in MultiFidelitySweep.csv.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateMultiFidelitySweep");
+
+using namespace ns3;
+using namespace std;
+
+/* Sweep parameters */
+uint32_t payloadSize = 1472;                    /* Application payload size in bytes. */
+bool verbose = false;                           /* Print the progress of the sweep. */
+
+void
+SetAntennaConfigurations (NetDeviceContainer &apDevice, NetDeviceContainer &staDevice)
+{
+  Ptr<WifiNetDevice> apWifiNetDevice = DynamicCast<WifiNetDevice> (apDevice.Get (0));
+  Ptr<WifiNetDevice> staWifiNetDevice = DynamicCast<WifiNetDevice> (staDevice.Get (0));
+  Ptr<DmgAdhocWifiMac> apWifiMac = DynamicCast<DmgAdhocWifiMac> (apWifiNetDevice->GetMac ());
+  Ptr<DmgAdhocWifiMac> staWifiMac = DynamicCast<DmgAdhocWifiMac> (staWifiNetDevice->GetMac ());
+  apWifiMac->AddAntennaConfig (1, 1, staWifiMac->GetAddress ());
+  staWifiMac->AddAntennaConfig (5, 1, apWifiMac->GetAddress ());
+  apWifiMac->SteerAntennaToward (staWifiMac->GetAddress ());
+  staWifiMac->SteerAntennaToward (apWifiMac->GetAddress ());
+}
+
+/**
+ * Parse a comma separated list of unsigned integers.
+ * \param list The list.
+ * \return The values.
+ */
+vector<uint32_t>
+ParseList (string list)
+{
+  vector<uint32_t> values;
+  istringstream iss (list);
+  string value;
+  while (getline (iss, value, ','))
+    {
+      values.push_back (std::stoul (value));
+    }
+  NS_ABORT_MSG_IF (values.empty (), "Empty list of values");
+  return values;
+}
+
+/**
+ * Simulate one design point.
+ * \param mcs The DMG MCS index.
+ * \param msduAggSize The maximum A-MSDU size in bytes.
+ * \param mpduAggSize The maximum A-MPDU size in bytes.
+ * \param simulationTime The simulation time in seconds.
+ * \param matrixChannel Whether to replace the Friis model with a constant loss matrix.
+ * \return The throughput in Mbps.
+ */
+double
+SimulateDesignPoint (uint32_t mcs, uint32_t msduAggSize, uint32_t mpduAggSize,
+                     double simulationTime, bool matrixChannel)
+{
+  WifiMode mode = WifiMode ("DMG_MCS" + std::to_string (mcs));
+
+  /**** DmgWifiHelper is a meta-helper: it helps creates helpers ****/
+  DmgWifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ad);
+
+  /**** Set up Channel ****/
+  DmgWifiChannelHelper wifiChannel ;
+  /* Simple propagation delay model */
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  if (matrixChannel)
+    {
+      /* Constant loss equal to the Friis loss at 1 m and 60.48 GHz, no geometry to evaluate */
+      wifiChannel.AddPropagationLoss ("ns3::MatrixPropagationLossModel", "DefaultLoss", DoubleValue (68.07));
+    }
+  else
+    {
+      /* Friis model with standard-specific wavelength */
+      wifiChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel", "Frequency", DoubleValue (60.48e9));
+    }
+
+  /**** Setup physical layer ****/
+  DmgWifiPhyHelper wifiPhy = DmgWifiPhyHelper::Default ();
+  /* Nodes will be added to the channel we set up earlier */
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  /* All nodes transmit at 0 dBm == 1 mW, no adaptation */
+  wifiPhy.Set ("TxPowerStart", DoubleValue (0.0));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (0.0));
+  wifiPhy.Set ("TxPowerLevels", UintegerValue (1));
+  /* Set operating channel */
+  wifiPhy.Set ("ChannelNumber", UintegerValue (2));
+  /* Add support for the OFDM PHY */
+  wifiPhy.Set ("SupportOfdmPhy", BooleanValue (true));
+  /* Set default algorithm for all nodes to be constant rate */
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue (mode.GetUniqueName ()));
+
+  /* Make two nodes and set them up with the PHY and the MAC */
+  NodeContainer wifiNodes;
+  wifiNodes.Create (2);
+  Ptr<Node> apWifiNode = wifiNodes.Get (0);
+  Ptr<Node> staWifiNode = wifiNodes.Get (1);
+
+  /* Add a DMG upper mac */
+  DmgWifiMacHelper wifiMac = DmgWifiMacHelper::Default ();
+
+  /* Set Analytical Codebook for the WiGig Devices */
+  wifi.SetCodebook ("ns3::CodebookAnalytical",
+                    "CodebookType", EnumValue (SIMPLE_CODEBOOK),
+                    "Antennas", UintegerValue (1),
+                    "Sectors", UintegerValue (8));
+
+  /* Create Wifi Network Devices (WifiNetDevice) */
+  wifiMac.SetType ("ns3::DmgAdhocWifiMac",
+                   "BE_MaxAmpduSize", UintegerValue (mpduAggSize),
+                   "BE_MaxAmsduSize", UintegerValue (msduAggSize));
+
+  NetDeviceContainer apDevice;
+  apDevice = wifi.Install (wifiPhy, wifiMac, apWifiNode);
+
+  NetDeviceContainer staDevice;
+  staDevice = wifi.Install (wifiPhy, wifiMac, staWifiNode);
+
+  /* Set the best antenna configurations */
+  Simulator::ScheduleNow (&SetAntennaConfigurations, apDevice, staDevice);
+
+  /* Setting mobility model */
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));        /* DMG STA [1] */
+  positionAlloc->Add (Vector (1.0, 0.0, 0.0));        /* DMG STA [2] */
+
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiNodes);
+
+  /* Internet stack*/
+  InternetStackHelper stack;
+  stack.Install (wifiNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer apInterface;
+  apInterface = address.Assign (apDevice);
+  Ipv4InterfaceContainer staInterface;
+  staInterface = address.Assign (staDevice);
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* We do not want any ARP packets */
+  PopulateArpCache ();
+
+  /* Install Simple UDP Server on the DMG STA [1] */
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9999));
+  ApplicationContainer sinkApp = sinkHelper.Install (apWifiNode);
+  Ptr<PacketSink> packetSink = StaticCast<PacketSink> (sinkApp.Get (0));
+  sinkApp.Start (Seconds (0.0));
+
+  /* Install UDP Transmitter on the DMG STA [2], saturated at the nominal PHY rate */
+  ApplicationContainer srcApp;
+  OnOffHelper src ("ns3::UdpSocketFactory", InetSocketAddress (apInterface.GetAddress (0), 9999));
+  src.SetAttribute ("MaxPackets", UintegerValue (0));
+  src.SetAttribute ("PacketSize", UintegerValue (payloadSize));
+  src.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1e6]"));
+  src.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  src.SetAttribute ("DataRate", DataRateValue (DataRate (mode.GetPhyRate ())));
+  srcApp = src.Install (staWifiNode);
+  srcApp.Start (Seconds (0.0));
+  srcApp.Stop (Seconds (simulationTime));
+
+  Simulator::Stop (Seconds (simulationTime));
+  Simulator::Run ();
+  double throughput = packetSink->GetTotalRx () * (double) 8 / (simulationTime * 1e6);
+  Simulator::Destroy ();
+  return throughput;
+}
+
+int
+main (int argc, char *argv[])
+{
+  string mcsList = "1,4,6,8,10,12";             /* The DMG MCS indices to sweep. */
+  string msduAggSizes = "0,3839,7935";          /* The maximum A-MSDU sizes to sweep in Bytes. */
+  string mpduAggSizes = "0,65535,262143";       /* The maximum A-MPDU sizes to sweep in Bytes. */
+  string queueSize = "4000p";                   /* Wifi MAC Queue Size. */
+  string lowFidelity = "analytic";              /* The low fidelity model (analytic/short). */
+  double shortSimulationTime = 0.05;            /* Simulation time in seconds of the low fidelity simulations. */
+  double simulationTime = 1;                    /* Simulation time in seconds of the full fidelity simulations. */
+  double topFraction = 0.2;                     /* Fraction of the best design points to simulate with full fidelity. */
+  double boundaryMargin = 0.05;                 /* Relative margin below the cut-off throughput to also simulate. */
+  bool csv = false;                             /* Enable CSV output. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("payloadSize", "Application payload size in bytes", payloadSize);
+  cmd.AddValue ("mcsList", "Comma separated list of the DMG MCS indices to sweep", mcsList);
+  cmd.AddValue ("msduAggSizes", "Comma separated list of the maximum A-MSDU sizes to sweep in Bytes", msduAggSizes);
+  cmd.AddValue ("mpduAggSizes", "Comma separated list of the maximum A-MPDU sizes to sweep in Bytes", mpduAggSizes);
+  cmd.AddValue ("queueSize", "The maximum size of the Wifi MAC Queue", queueSize);
+  cmd.AddValue ("lowFidelity", "The low fidelity model: analytic or short (short simulation with a matrix channel)", lowFidelity);
+  cmd.AddValue ("shortSimulationTime", "Simulation time in seconds of the low fidelity simulations", shortSimulationTime);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds of the full fidelity simulations", simulationTime);
+  cmd.AddValue ("topFraction", "Fraction of the best design points to simulate with full fidelity", topFraction);
+  cmd.AddValue ("boundaryMargin", "Relative margin below the cut-off throughput within which points are also simulated", boundaryMargin);
+  cmd.AddValue ("verbose", "Print the progress of the sweep", verbose);
+  cmd.AddValue ("csv", "Enable CSV output instead of plain text", csv);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF ((lowFidelity != "analytic") && (lowFidelity != "short"), "Wrong low fidelity model");
+
+  /* Wifi MAC Queue Parameters */
+  ChangeQueueSize (queueSize);
+
+  /* Build the design space */
+  struct DesignPoint {
+    uint32_t mcs;
+    uint32_t msduAggSize;
+    uint32_t mpduAggSize;
+  };
+  vector<DesignPoint> points;
+  MultiFidelitySweep sweep;
+  vector<uint32_t> mcsValues = ParseList (mcsList);
+  vector<uint32_t> msduValues = ParseList (msduAggSizes);
+  vector<uint32_t> mpduValues = ParseList (mpduAggSizes);
+  for (vector<uint32_t>::const_iterator mcs = mcsValues.begin (); mcs != mcsValues.end (); mcs++)
+    {
+      for (vector<uint32_t>::const_iterator msdu = msduValues.begin (); msdu != msduValues.end (); msdu++)
+        {
+          for (vector<uint32_t>::const_iterator mpdu = mpduValues.begin (); mpdu != mpduValues.end (); mpdu++)
+            {
+              string msduValue = std::to_string (*msdu);
+              string mpduValue = std::to_string (*mpdu);
+              ValidateFrameAggregationAttributes (msduValue, mpduValue);
+              DesignPoint point = {*mcs, *msdu, *mpdu};
+              points.push_back (point);
+              ostringstream name;
+              name << "MCS" << *mcs << "/" << *msdu << "/" << *mpdu;
+              sweep.AddPoint (name.str ());
+            }
+        }
+    }
+
+  /* Low fidelity pass over the whole design space */
+  for (uint32_t i = 0; i < points.size (); i++)
+    {
+      std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now ();
+      double throughput;
+      if (lowFidelity == "analytic")
+        {
+          throughput = AnalyticDmgThroughput (WifiMode ("DMG_MCS" + std::to_string (points[i].mcs)),
+                                              payloadSize, points[i].msduAggSize, points[i].mpduAggSize);
+        }
+      else
+        {
+          throughput = SimulateDesignPoint (points[i].mcs, points[i].msduAggSize, points[i].mpduAggSize,
+                                            shortSimulationTime, true);
+        }
+      std::chrono::duration<double> wallTime = std::chrono::steady_clock::now () - wallStart;
+      sweep.SetLowFidelity (i, throughput, wallTime.count ());
+      if (verbose)
+        {
+          std::cout << "Low fidelity " << sweep.GetName (i) << " = " << throughput << " Mbps" << std::endl;
+        }
+    }
+
+  /* Full fidelity pass over the best points and the decision boundary */
+  vector<uint32_t> selected = sweep.Select (topFraction, boundaryMargin);
+  for (vector<uint32_t>::const_iterator it = selected.begin (); it != selected.end (); it++)
+    {
+      std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now ();
+      double throughput = SimulateDesignPoint (points[*it].mcs, points[*it].msduAggSize, points[*it].mpduAggSize,
+                                               simulationTime, false);
+      std::chrono::duration<double> wallTime = std::chrono::steady_clock::now () - wallStart;
+      sweep.SetHighFidelity (*it, throughput, wallTime.count ());
+      if (verbose)
+        {
+          std::cout << "Full fidelity " << sweep.GetName (*it) << " = " << throughput << " Mbps" << std::endl;
+        }
+    }
+
+  /* Print the results, the design point names are MCS/A-MSDU/A-MPDU */
+  sweep.Print (std::cout, csv);
+  AsciiTraceHelper ascii;
+  Ptr<OutputStreamWrapper> outputFile = ascii.CreateFileStream ("MultiFidelitySweep.csv");
+  sweep.Print (*outputFile->GetStream (), true);
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "ns3/spectrum-module.h"
+#include "dmg-spectrum-resolution.h"
+#include "parallel-fan-out.h"
+#include <chrono>
+#include <complex>
+#include <cstring>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Evaluate the wall-clock gain of computing the received PSDs of a transmission on a pool of worker threads.
+ * In dense Q-D scenarios (e.g. evaluate_qd_dense_scenario_single_ap with many STAs), every transmission computes
+ * a frequency-selective beamformed PSD for each receiver in sequence inside a single event. These computations
+ * are independent, so they are distributed over a ParallelFanOut pool when the number of receivers reaches the
+ * threshold, and the receptions are then handled in receiver order.
+ *
+ * Each receiver gets its own multipath channel (the beamforming gains are folded into the ray gains). The
+ * per-receiver SpectrumValue objects are allocated in the simulator thread beforehand, since the reference
+ * counting of ns-3 objects is not thread-safe; the jobs only fill their values in place.
+ *
+ * The script checks that the parallel PSDs are bitwise identical to the sequential ones.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_parallel_fan_out --numReceivers=64 --numRays=50 --binsPerChannel=256 --threads=0"
+ *
+ * Simulation Output:
+ * A table with the time per transmission for an increasing number of receivers.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateParallelFanOut");
+
+using namespace ns3;
+using namespace std;
+
+struct Ray {
+  double delay;
+  std::complex<double> gain;
+};
+
+/**
+ * Fill the received PSD of a single receiver: rxPsd = txPsd * |H(f)|^2.
+ * The values are passed by reference so that the jobs do not touch any reference count.
+ */
+void
+CalculateRxPsd (const std::vector<Ray> &rays, const SpectrumValue &txPsd, double centerFrequency,
+                SpectrumValue &rxPsd)
+{
+  Values::iterator value = rxPsd.ValuesBegin ();
+  Values::const_iterator tx = txPsd.ConstValuesBegin ();
+  for (Bands::const_iterator band = txPsd.ConstBandsBegin (); band != txPsd.ConstBandsEnd (); band++, value++, tx++)
+    {
+      std::complex<double> h = 0;
+      for (std::vector<Ray>::const_iterator ray = rays.begin (); ray != rays.end (); ray++)
+        {
+          h += ray->gain * std::polar (1.0, -2 * M_PI * (band->fc - centerFrequency) * ray->delay);
+        }
+      *value = (*tx) * std::norm (h);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  double centerFrequency = 60.48e9;   /* The center frequency of the channel in Hz. */
+  uint16_t channelWidth = 2160;       /* The channel width in MHz. */
+  uint32_t numReceivers = 64;         /* The maximum number of receivers per transmission. */
+  uint32_t numRays = 50;              /* The number of rays per receiver. */
+  uint32_t binsPerChannel = 256;      /* The number of bins per 2.16 GHz channel. */
+  uint32_t threads = 0;               /* The number of threads (0 for the number of hardware threads). */
+  uint32_t threshold = 8;             /* The minimum number of receivers to use the worker threads. */
+  uint32_t iterations = 100;          /* The number of transmissions used to time each configuration. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("numReceivers", "The maximum number of receivers per transmission", numReceivers);
+  cmd.AddValue ("numRays", "The number of rays per receiver", numRays);
+  cmd.AddValue ("channelWidth", "The channel width in MHz: 2160, 4320, 6480 or 8640", channelWidth);
+  cmd.AddValue ("binsPerChannel", "The number of bins per 2.16 GHz channel", binsPerChannel);
+  cmd.AddValue ("threads", "The number of threads, 0 for the number of hardware threads", threads);
+  cmd.AddValue ("threshold", "The minimum number of receivers to use the worker threads", threshold);
+  cmd.AddValue ("iterations", "The number of transmissions used to time each configuration", iterations);
+  cmd.Parse (argc, argv);
+
+  Ptr<DmgSpectrumResolution> resolution = CreateObject<DmgSpectrumResolution> ();
+  resolution->SetAttribute ("BinsPerChannel", UintegerValue (binsPerChannel));
+  Ptr<SpectrumModel> model = resolution->GetSpectrumModel (centerFrequency, channelWidth);
+  Ptr<SpectrumValue> txPsd = CreateDmgTxPowerSpectralDensity (0.01, model);
+
+  /* Multipath channel of each receiver */
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  std::vector<std::vector<Ray> > channels (numReceivers);
+  for (uint32_t i = 0; i < numReceivers; i++)
+    {
+      for (uint32_t r = 0; r < numRays; r++)
+        {
+          Ray ray;
+          ray.delay = uniform->GetValue (0, 100e-9);
+          ray.gain = std::polar (std::pow (10.0, -uniform->GetValue (60, 110) / 20), uniform->GetValue (0, 2 * M_PI));
+          channels[i].push_back (ray);
+        }
+    }
+
+  /* Per-receiver output slots, allocated in the simulator thread */
+  std::vector<Ptr<SpectrumValue> > sequential (numReceivers);
+  std::vector<Ptr<SpectrumValue> > parallel (numReceivers);
+  for (uint32_t i = 0; i < numReceivers; i++)
+    {
+      sequential[i] = Create<SpectrumValue> (model);
+      parallel[i] = Create<SpectrumValue> (model);
+    }
+
+  ParallelFanOut pool (threads, threshold);
+  std::cout << "Threads: " << pool.GetNThreads () << ", threshold: " << threshold
+            << ", bins: " << model->GetNumBands () << ", rays: " << numRays << std::endl;
+  std::cout << std::left << std::setw (12) << "Receivers"
+            << std::left << std::setw (20) << "Sequential [us]"
+            << std::left << std::setw (20) << "Parallel [us]"
+            << std::left << std::setw (12) << "Speed-up"
+            << std::left << std::setw (12) << "Identical" << std::endl;
+
+  for (uint32_t receivers = 1; receivers <= numReceivers; receivers *= 2)
+    {
+      auto start = std::chrono::steady_clock::now ();
+      for (uint32_t n = 0; n < iterations; n++)
+        {
+          for (uint32_t i = 0; i < receivers; i++)
+            {
+              CalculateRxPsd (channels[i], *txPsd, centerFrequency, *sequential[i]);
+            }
+        }
+      auto end = std::chrono::steady_clock::now ();
+      double sequentialTime = std::chrono::duration<double, std::micro> (end - start).count () / iterations;
+
+      start = std::chrono::steady_clock::now ();
+      for (uint32_t n = 0; n < iterations; n++)
+        {
+          pool.Run (receivers, [&] (uint32_t i) {
+            CalculateRxPsd (channels[i], *txPsd, centerFrequency, *parallel[i]);
+          });
+        }
+      end = std::chrono::steady_clock::now ();
+      double parallelTime = std::chrono::duration<double, std::micro> (end - start).count () / iterations;
+
+      bool identical = true;
+      for (uint32_t i = 0; i < receivers; i++)
+        {
+          identical &= (std::memcmp (&(*sequential[i]->ConstValuesBegin ()), &(*parallel[i]->ConstValuesBegin ()),
+                                     model->GetNumBands () * sizeof (double)) == 0);
+        }
+
+      std::cout << std::left << std::setw (12) << receivers
+                << std::left << std::setw (20) << sequentialTime
+                << std::left << std::setw (20) << parallelTime
+                << std::left << std::setw (12) << sequentialTime / parallelTime
+                << std::left << std::setw (12) << (identical ? "yes" : "no") << std::endl;
+    }
+
+  return 0;
+}
@@ -218,6 +218,8 @@ main (int argc, char *argv[])
   string directory = "";                          /* Path to the directory where to store the results. */
   bool pcapTracing = false;                       /* Fla to indicate if PCAP tracing is enabled or not. */
   string arrayConfig = "28";                      /* Phased antenna array configuration. */
+  string qdChannelFolder = "L-ShapedRoom";        /* The name of the folder containing the QD-Channel files. */
+  uint32_t qdInterval = 100;                      /* The time between two consecutive Q-D trace indices in MilliSeconds. */
 
   /* Command line argument parser setup. */
   CommandLine cmd;
@@ -243,6 +245,8 @@ main (int argc, char *argv[])
   cmd.AddValue ("directory", "Path to the directory where we store the results", directory);
   cmd.AddValue ("pcap", "Enable PCAP Tracing", pcapTracing);
   cmd.AddValue ("arrayConfig", "Antenna array configuration", arrayConfig);
+  cmd.AddValue ("qdChannelFolder", "The name of the folder containing the QD-Channel files", qdChannelFolder);
+  cmd.AddValue ("qdInterval", "The time between two consecutive Q-D trace indices in MilliSeconds", qdInterval);
   cmd.AddValue ("csv", "Enable CSV output instead of plain text. This mode will suppress all the messages related statistics and events.", csv);
   cmd.Parse (argc, argv);
 
@@ -272,14 +276,14 @@ main (int argc, char *argv[])
   /**** Setup mmWave Q-D Channel ****/
   Ptr<MultiModelSpectrumChannel> spectrumChannel = CreateObject<MultiModelSpectrumChannel> ();
   qdPropagationEngine = CreateObject<QdPropagationEngine> ();
-  qdPropagationEngine->SetAttribute ("QDModelFolder", StringValue ("DmgFiles/QdChannel/L-ShapedRoom/"));
+  qdPropagationEngine->SetAttribute ("QDModelFolder", StringValue ("DmgFiles/QdChannel/" + qdChannelFolder + "/"));
   Ptr<QdPropagationLossModel> lossModelRaytracing = CreateObject<QdPropagationLossModel> (qdPropagationEngine);
   Ptr<QdPropagationDelayModel> propagationDelayRayTracing = CreateObject<QdPropagationDelayModel> (qdPropagationEngine);
   spectrumChannel->AddSpectrumPropagationLossModel (lossModelRaytracing);
   spectrumChannel->SetPropagationDelayModel (propagationDelayRayTracing);
   if (enableMobility)
     {
-      qdPropagationEngine->SetAttribute ("Interval", TimeValue (MilliSeconds (100)));
+      qdPropagationEngine->SetAttribute ("Interval", TimeValue (MilliSeconds (qdInterval)));
     }
 
   /**** Setup physical layer ****/
@@ -11,6 +11,9 @@
 #include "ns3/spectrum-module.h"
 #include "ns3/wifi-module.h"
 #include "common-functions.h"
+#include "dmg-bi-coordination.h"
+#include "dmg-run-cache.h"
+#include "dmg-simulation-statistics.h"
 #include <iomanip>
 #include <sstream>
 
@@ -45,6 +48,24 @@
  * To use this script simply type the following run command:
  * ./waf --run "qd_channel_spatial_sharing --enableMobility=false"
  *
+ * Beacon Interval Coordination:
+ * By default, each DMG PCP/AP randomizes the start of its first BI with a small jitter, so the BHIs and the data
+ * transmissions of co-channel PCP/APs can collide. With --coordinateBi=true, each DMG PCP/AP delays its first BI by
+ * a random time within one BI, learns the BHIs of its neighbours from the DMG Beacons it overhears, shifts its own
+ * BHI into an idle gap and allocates the uplink SP of its DMG STA in the quiet periods of the neighbours. To see the
+ * aggregate throughput gain as the number of links grows, compare:
+ * ./waf --run "qd_channel_spatial_sharing --csv=false --parallelLinks=4 --coordinateBi=false"
+ * ./waf --run "qd_channel_spatial_sharing --csv=false --parallelLinks=4 --coordinateBi=true"
+ *
+ * Run Cache:
+ * With --runCache=true, the outputs of a run are stored under RunCache/ and keyed by the hash of the arguments, the
+ * attribute defaults, the global values, the Q-D files, the codebooks and the error model tables. Re-running the same
+ * configuration restores the stored outputs right after parsing the arguments, without building the topology and the
+ * Q-D channel. Entries of a different code version are ignored: by default the version is the hash of the script
+ * executable and of the ns-3 libraries, --runCacheVersion overrides it (e.g. with the git revision of the tree). The
+ * cache is disabled when PCAP tracing is enabled.
+ * ./waf --run "qd_channel_spatial_sharing --csv=false --runCache=true"
+ *
  * Simulation Output:
  */
 
@@ -72,6 +93,10 @@ double simulationTime = 10;                   /* Simulation time in seconds. */
 bool csv = true;                              /* Enable CSV output. */
 bool enableJitter = true;                     /* Enable Beacon Interval Jitter to randomize Beacon Interval start time. */
 string beaconJitter = "ns3::UniformRandomVariable[Min=0|Max=10]";
+bool coordinateBi = false;                    /* Coordinate the beacon intervals of the DMG PCP/APs. */
+
+/** Beacon Interval Coordination **/
+std::map<Mac48Address, Ptr<DmgBeaconIntervalCoordination> > biCoordinators; /* Coordination per DMG PCP/AP. */
 
 /**  Applications **/
 CommunicationPairList communicationPairList;  /* List of communicating devices. */
@@ -160,6 +185,11 @@ StationAssoicated (Ptr<Node> node, Ptr<DmgWifiMac> staWifiMac, Mac48Address addr
       std::cout << "DMG STA " << staWifiMac->GetAddress () << " associated with DMG PCP/AP " << address
                 << ", Association ID (AID) = " << aid << std::endl;
     }
+  if (coordinateBi)
+    {
+      /* Uplink SP from the DMG STA to its DMG PCP/AP */
+      biCoordinators[address]->RequestServicePeriod (aid, AID_AP);
+    }
   CommunicationPairList_I it = communicationPairList.find (node->GetId ());
   if (it != communicationPairList.end ())
     {
@@ -250,7 +280,8 @@ DataTransmissionIntervalStarted (Ptr<DmgApWifiMac> apWifiMac, Ptr<DmgStaWifiMac>
     {
       uint16_t counter = biCounter[address];
       counter++;
-      if (counter == biThreshold)
+      /* The DTI is made of SPs once the beacon intervals are coordinated */
+      if ((counter == biThreshold) && !(coordinateBi && biCoordinators[apWifiMac->GetAddress ()]->IsAligned ()))
         {
           staWifiMac->Perform_TXSS_TXOP (address);
           counter = 0;
@@ -289,6 +320,9 @@ main (int argc, char *argv[])
   bool enableMobility = false;                            /* Enable mobility. */
   string arrayConfig = "28";                         /* Phased antenna array configuration. */
   string qdChannelFolder = "SpatialSharingMobility"; /* The name of the folder containing the QD-Channel files. */
+  bool runCache = false;                                  /* Reuse the outputs of identical runs. */
+  string runCacheFolder = "RunCache/";                    /* The folder of the run cache. */
+  string runCacheVersion = "";                            /* The code version of the run cache, empty for the build hash. */
 
   /* Command line argument parser setup. */
   CommandLine cmd;
@@ -309,6 +343,7 @@ main (int argc, char *argv[])
   cmd.AddValue ("normalizeWeights", "Whether we normalize the antenna weights vector or not", normalizeWeights);
   cmd.AddValue ("enableJitter", "Enable Beacon Interval Jitter to randomize Beacon Interval start time", enableJitter);
   cmd.AddValue ("beaconJitter", "Beacon Jitter value in MicroSeconds", beaconJitter);
+  cmd.AddValue ("coordinateBi", "Coordinate the beacon intervals and the SPs of the DMG PCP/APs", coordinateBi);
   cmd.AddValue ("parallelLinks", "The number of parallel links", parallelLinks);
   cmd.AddValue ("biThreshold", "BI Threshold to trigger beamforming training", biThreshold);
   cmd.AddValue ("verbose", "turn on all WifiNetDevice log components", verbose);
@@ -318,9 +353,39 @@ main (int argc, char *argv[])
   cmd.AddValue ("snapshotLength", "The maximum PCAP Snapshot Length", snapshotLength);
   cmd.AddValue ("arrayConfig", "Antenna array configuration", arrayConfig);
   cmd.AddValue ("enableMobility", "Whether to enable mobility or simulate static scenario", enableMobility);
+  cmd.AddValue ("runCache", "Reuse the stored outputs of an identical run instead of simulating", runCache);
+  cmd.AddValue ("runCacheFolder", "The folder of the run cache", runCacheFolder);
+  cmd.AddValue ("runCacheVersion", "The code version of the run cache, by default the hash of the build", runCacheVersion);
   cmd.AddValue ("csv", "Enable CSV output instead of plain text. This mode will suppress all the messages related statistics and events.", csv);
   cmd.Parse (argc, argv);
 
+  /* Run cache, looked up before building anything: the rest of the run only depends on the key */
+  DmgRunCache cache (runCacheFolder, runCacheVersion);
+  runCache = runCache && !pcapTracing;
+  if (runCache)
+    {
+      cache.AddArguments (argc, argv);
+      cache.AddConfigDefaults ();
+      cache.AddAsset ("DmgFiles/QdChannel/" + qdChannelFolder + "/");
+      cache.AddAsset ("DmgFiles/Codebook/CODEBOOK_URA_AP_" + arrayConfig + "x.txt");
+      cache.AddAsset ("DmgFiles/Codebook/CODEBOOK_URA_STA_" + arrayConfig + "x.txt");
+      cache.AddAsset ("DmgFiles/ErrorModel/");
+      cache.AddOutput ("slsResults" + arrayConfig + ".csv");
+      cache.AddOutput ("snrValues.csv");
+      if (cache.Lookup ())
+        {
+          return 0;
+        }
+      cache.Start ();
+    }
+
+  if (coordinateBi)
+    {
+      /* Listen to the neighbours during up to one BI before the first BTI */
+      enableJitter = true;
+      beaconJitter = "ns3::UniformRandomVariable[Min=0|Max=102400]";
+    }
+
   /* Validate A-MSDU and A-MPDU values */
   ValidateFrameAggregationAttributes (msduAggSize, mpduAggSize);
   /* Configure RTS/CTS and Fragmentation */
@@ -495,6 +560,13 @@ main (int argc, char *argv[])
       apRemoteStationManager->TraceConnectWithoutContext ("MacRxOK", MakeBoundCallback (&MacRxOk, dmgApWifiMac, snrStream));
 
       biCounter[dmgApWifiMac->GetAddress ()] = 0;
+
+      if (coordinateBi)
+        {
+          Ptr<DmgBeaconIntervalCoordination> coordination = CreateObject<DmgBeaconIntervalCoordination> ();
+          coordination->Setup (wifiNetDevice);
+          biCoordinators[dmgApWifiMac->GetAddress ()] = coordination;
+        }
     }
 
   /* Enable Traces */
@@ -536,6 +608,35 @@ main (int argc, char *argv[])
     {
       PrintApplicationLayerAndFlowMonitorStatistics (flowmon, monitor, communicationPairList,
                                                      applicationType, simulationTime - 0.1);
+
+      /* Aggregate throughput of the parallel links */
+      double aggregateThroughput = CalculateAggregateThroughput (communicationPairList, simulationTime - 0.1);
+      std::cout << "\nAggregate Throughput of " << parallelLinks << " Links [Mbps] = " << aggregateThroughput << std::endl;
+
+      if (coordinateBi)
+        {
+          std::cout << "\nBeacon Interval Coordination" << std::endl;
+          std::cout << std::left << std::setw (20) << "DMG PCP/AP"
+                    << std::left << std::setw (12) << "Neighbours"
+                    << std::left << std::setw (12) << "Shifts"
+                    << std::left << std::setw (12) << "SP/BI [ms]" << std::endl;
+          for (std::map<Mac48Address, Ptr<DmgBeaconIntervalCoordination> >::iterator it = biCoordinators.begin ();
+               it != biCoordinators.end (); it++)
+            {
+              std::ostringstream apAddress;
+              apAddress << it->first;
+              std::cout << std::left << std::setw (20) << apAddress.str ()
+                        << std::left << std::setw (12) << it->second->GetNNeighbours ()
+                        << std::left << std::setw (12) << it->second->GetNShifts ()
+                        << std::left << std::setw (12) << it->second->GetAllocatedDuration ().GetMicroSeconds () / 1e3
+                        << std::endl;
+            }
+        }
+    }
+
+  if (runCache)
+    {
+      cache.Store ();
     }
 
   return 0;
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "qd-channel-trace.h"
+#include <chrono>
+#include <complex>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Evaluate the accuracy/speed trade-off of pruning weak rays from Q-D realizations. Higher order reflections
+ * often arrive far below the strongest ray, yet each of them enters the per-frame summation of the channel
+ * frequency response. For each pruning policy, the script reports the average number of rays kept, the error
+ * of the channel frequency response with respect to the unpruned channel, and the speed-up of the summation.
+ *
+ * Pruning Policies:
+ * 1. Dynamic range: keep the rays within X dB of the strongest ray at one trace index at least.
+ * 2. Top-K: keep the K rays with the largest path gain over the trace.
+ * The same rays are kept at every trace index, so the pruned traces can still be interpolated.
+ *
+ * The channel frequency response H(f) = sum_r sqrt(g_r) exp(j (phase_r - 2 pi f delay_r)) is computed over
+ * numBins frequency bins spanning the 2.16 GHz channel. The errors are reported as the mean absolute per-bin
+ * power error and the wideband power error, both in dB. Antenna patterns are not applied, so the errors
+ * represent the worst case where beamforming does not attenuate the pruned rays.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_qd_ray_pruning --qdChannelFolder=L-ShapedRoom --numNodes=2"
+ *
+ * To store a pruned Q-D folder (the output folder must contain a "QdFiles" sub-folder):
+ * ./waf --run "evaluate_qd_ray_pruning --qdChannelFolder=L-ShapedRoom --numNodes=2 --policy=range --value=30 --output=DmgFiles/QdChannel/L-ShapedRoom-30dB/"
+ *
+ * Simulation Output:
+ * A table with one line per pruning policy.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateQdRayPruning");
+
+using namespace ns3;
+using namespace std;
+
+typedef std::vector<std::complex<double> > FrequencyResponse;
+
+/**
+ * Compute the channel frequency response of a realization.
+ */
+void
+CalculateFrequencyResponse (const QdRealization &realization, const std::vector<double> &frequencies,
+                            FrequencyResponse &response)
+{
+  response.assign (frequencies.size (), std::complex<double> (0, 0));
+  for (QdRealization::const_iterator ray = realization.begin (); ray != realization.end (); ray++)
+    {
+      double amplitude = std::pow (10.0, ray->pathGain / 20.0);
+      for (size_t k = 0; k < frequencies.size (); k++)
+        {
+          response[k] += std::polar (amplitude, ray->phase - 2 * M_PI * frequencies[k] * ray->delay);
+        }
+    }
+}
+
+struct PruningResult {
+  string name;
+  double rays = 0;              //!< Total number of rays kept.
+  double binError = 0;          //!< Sum of the mean absolute per-bin power errors in dB.
+  double widebandError = 0;     //!< Sum of the absolute wideband power errors in dB.
+  double maxWidebandError = 0;  //!< Maximum absolute wideband power error in dB.
+  double time = 0;              //!< Time spent in the summation in seconds.
+};
+
+int
+main (int argc, char *argv[])
+{
+  string qdChannelFolder = "L-ShapedRoom";      /* The name of the folder containing the QD-Channel files. */
+  uint16_t numNodes = 2;                        /* The number of nodes in the Q-D scenario. */
+  uint32_t numBins = 512;                       /* The number of frequency bins over the channel. */
+  double frequency = 60.48e9;                   /* The carrier frequency in Hz. */
+  double bandwidth = 2.16e9;                    /* The channel bandwidth in Hz. */
+  string policy = "";                           /* The policy applied to generate a pruned folder (range or topk). */
+  double value = 30;                            /* The dynamic range in dB or the number of rays K. */
+  string output = "";                           /* The Q-D model folder where to store the pruned traces. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("qdChannelFolder", "The name of the folder containing the QD-Channel files", qdChannelFolder);
+  cmd.AddValue ("numNodes", "The number of nodes in the Q-D scenario", numNodes);
+  cmd.AddValue ("numBins", "The number of frequency bins over the channel", numBins);
+  cmd.AddValue ("frequency", "The carrier frequency in Hz", frequency);
+  cmd.AddValue ("bandwidth", "The channel bandwidth in Hz", bandwidth);
+  cmd.AddValue ("policy", "The pruning policy used to generate a pruned folder: range or topk", policy);
+  cmd.AddValue ("value", "The dynamic range in dB (range) or the number of rays (topk)", value);
+  cmd.AddValue ("output", "The Q-D model folder where to store the pruned traces", output);
+  cmd.Parse (argc, argv);
+
+  /* Load all the Q-D files of the scenario */
+  string folder = "DmgFiles/QdChannel/" + qdChannelFolder + "/";
+  std::vector<QdTrace> traces;
+  std::vector<std::pair<uint16_t, uint16_t> > pairs;
+  QdTrace trace;
+  for (uint16_t src = 0; src < numNodes; src++)
+    {
+      for (uint16_t dst = 0; dst < numNodes; dst++)
+        {
+          if ((src != dst) && ReadQdTraceFile (GetQdTraceFileName (folder, src, dst), trace))
+            {
+              traces.push_back (trace);
+              pairs.push_back (std::make_pair (src, dst));
+            }
+        }
+    }
+  NS_ABORT_MSG_IF (traces.empty (), "No Q-D files found in " << folder);
+
+  /* Generate the pruned folder if requested */
+  if (!output.empty ())
+    {
+      QdRayPruningPolicy pruningPolicy = (policy == "topk") ? PRUNE_TOP_K : PRUNE_DYNAMIC_RANGE;
+      for (size_t i = 0; i < traces.size (); i++)
+        {
+          WriteQdTraceFile (GetQdTraceFileName (output, pairs[i].first, pairs[i].second),
+                            PruneQdTrace (traces[i], pruningPolicy, value));
+        }
+      std::cout << "Pruned Q-D files written to " << output << std::endl;
+    }
+
+  /* Baseband frequencies of the bins */
+  std::vector<double> frequencies (numBins);
+  for (uint32_t k = 0; k < numBins; k++)
+    {
+      frequencies[k] = frequency - bandwidth / 2 + (k + 0.5) * bandwidth / numBins;
+    }
+
+  /* Policies to evaluate */
+  std::vector<std::pair<QdRayPruningPolicy, double> > policies;
+  std::vector<PruningResult> results;
+  policies.push_back (std::make_pair (PRUNE_NONE, 0));
+  for (double range : {10.0, 20.0, 30.0, 40.0})
+    {
+      policies.push_back (std::make_pair (PRUNE_DYNAMIC_RANGE, range));
+    }
+  for (double k : {1.0, 2.0, 5.0, 10.0, 20.0})
+    {
+      policies.push_back (std::make_pair (PRUNE_TOP_K, k));
+    }
+
+  uint64_t realizations = 0;
+  FrequencyResponse reference, response;
+  for (size_t p = 0; p < policies.size (); p++)
+    {
+      PruningResult result;
+      if (policies[p].first == PRUNE_NONE)
+        {
+          result.name = "None";
+        }
+      else if (policies[p].first == PRUNE_DYNAMIC_RANGE)
+        {
+          result.name = "Range " + std::to_string (int (policies[p].second)) + " dB";
+        }
+      else
+        {
+          result.name = "Top-" + std::to_string (int (policies[p].second));
+        }
+      realizations = 0;
+      for (size_t t = 0; t < traces.size (); t++)
+        {
+          /* Pruning is done once at load time, only the summation is timed */
+          QdTrace pruned = PruneQdTrace (traces[t], policies[p].first, policies[p].second);
+          for (size_t index = 0; index < pruned.size (); index++)
+            {
+              if (traces[t][index].empty ())
+                {
+                  continue;
+                }
+              CalculateFrequencyResponse (traces[t][index], frequencies, reference);
+              auto start = std::chrono::steady_clock::now ();
+              CalculateFrequencyResponse (pruned[index], frequencies, response);
+              auto end = std::chrono::steady_clock::now ();
+              result.time += std::chrono::duration<double> (end - start).count ();
+              result.rays += pruned[index].size ();
+
+              double binError = 0;
+              double referencePower = 0;
+              double power = 0;
+              for (uint32_t k = 0; k < numBins; k++)
+                {
+                  double a = std::max (std::norm (reference[k]), 1e-30);
+                  double b = std::max (std::norm (response[k]), 1e-30);
+                  binError += std::abs (10 * std::log10 (b / a));
+                  referencePower += a;
+                  power += b;
+                }
+              double widebandError = std::abs (10 * std::log10 (power / referencePower));
+              result.binError += binError / numBins;
+              result.widebandError += widebandError;
+              result.maxWidebandError = std::max (result.maxWidebandError, widebandError);
+              realizations++;
+            }
+        }
+      results.push_back (result);
+    }
+
+  /* Print Results Summary */
+  std::cout << "Q-D folder: " << folder << ", " << traces.size () << " Tx/Rx pairs, "
+            << realizations << " realizations, " << numBins << " bins" << std::endl;
+  std::cout << std::left << std::setw (16) << "Policy"
+            << std::left << std::setw (12) << "Avg Rays"
+            << std::left << std::setw (16) << "Bin Err [dB]"
+            << std::left << std::setw (16) << "WB Err [dB]"
+            << std::left << std::setw (16) << "Max WB Err [dB]"
+            << std::left << std::setw (12) << "Speed-up" << std::endl;
+  for (size_t p = 0; p < results.size (); p++)
+    {
+      std::cout << std::left << std::setw (16) << results[p].name
+                << std::left << std::setw (12) << results[p].rays / realizations
+                << std::left << std::setw (16) << results[p].binError / realizations
+                << std::left << std::setw (16) << results[p].widebandError / realizations
+                << std::left << std::setw (16) << results[p].maxWidebandError
+                << std::left << std::setw (12) << results[0].time / std::max (results[p].time, 1e-12)
+                << std::endl;
+    }
+
+  return 0;
+}
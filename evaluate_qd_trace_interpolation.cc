@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "qd-channel-trace.h"
+#include <chrono>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Evaluate the lookup-time interpolation of Q-D traces. The Q-D Realization software can emit traces at a coarse
+ * time resolution (e.g. one trace index every 400 ms); the QdTraceLoader stores and parses only these coarse files
+ * and interpolates the ray parameters between the two enclosing trace indices on every lookup, so a fine
+ * resolution (e.g. 100 ms) is seen without generating, storing or parsing a dense dataset.
+ *
+ * Simulation Description:
+ * The coarse traces of every Tx/Rx pair are loaded through the QdTraceLoader and looked up every lookupInterval
+ * over the duration of the trace. When a dense folder generated at lookupInterval is given as reference, every
+ * lookup is compared with the reference realization of the same time, matching the rays by their position.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_qd_trace_interpolation --qdChannelFolder=L-ShapedRoom-400ms --qdInterval=400 --lookupInterval=100"
+ *
+ * To check the accuracy against a dense folder generated every 100 ms:
+ * ./waf --run "evaluate_qd_trace_interpolation --qdChannelFolder=L-ShapedRoom-400ms --qdInterval=400 --lookupInterval=100 --reference=L-ShapedRoom"
+ *
+ * Simulation Output:
+ * The number of trace indices parsed, the load time, the time per interpolated lookup and, with a reference folder,
+ * the mean absolute path gain error in dB and the mean absolute delay error in ns.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateQdTraceInterpolation");
+
+using namespace ns3;
+using namespace std;
+
+int
+main (int argc, char *argv[])
+{
+  string qdChannelFolder = "L-ShapedRoom";      /* The name of the folder containing the coarse QD-Channel files. */
+  string reference = "";                        /* The name of the folder containing the dense QD-Channel files. */
+  uint16_t numNodes = 2;                        /* The number of nodes in the Q-D scenario. */
+  uint32_t qdInterval = 400;                    /* The time between two trace indices of the coarse files in MilliSeconds. */
+  uint32_t lookupInterval = 100;                /* The time between two lookups in MilliSeconds. */
+  double frequency = 60.48e9;                   /* The carrier frequency in Hz. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("qdChannelFolder", "The name of the folder containing the coarse QD-Channel files", qdChannelFolder);
+  cmd.AddValue ("reference", "The name of the folder containing dense QD-Channel files generated every lookupInterval", reference);
+  cmd.AddValue ("numNodes", "The number of nodes in the Q-D scenario", numNodes);
+  cmd.AddValue ("qdInterval", "The time between two trace indices of the coarse files in MilliSeconds", qdInterval);
+  cmd.AddValue ("lookupInterval", "The time between two lookups in MilliSeconds", lookupInterval);
+  cmd.AddValue ("frequency", "The carrier frequency in Hz", frequency);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (lookupInterval == 0, "The lookup interval cannot be zero");
+
+  Ptr<QdTraceLoader> loader = CreateObject<QdTraceLoader> ();
+  loader->SetAttribute ("QDModelFolder", StringValue ("DmgFiles/QdChannel/" + qdChannelFolder + "/"));
+  loader->SetAttribute ("Interval", TimeValue (MilliSeconds (qdInterval)));
+  loader->SetAttribute ("Frequency", DoubleValue (frequency));
+
+  /* Load the coarse files */
+  std::vector<std::pair<uint16_t, uint16_t> > pairs;
+  auto start = std::chrono::steady_clock::now ();
+  for (uint16_t src = 0; src < numNodes; src++)
+    {
+      for (uint16_t dst = 0; dst < numNodes; dst++)
+        {
+          if ((src != dst) && loader->HasTrace (src, dst))
+            {
+              pairs.push_back (std::make_pair (src, dst));
+            }
+        }
+    }
+  auto end = std::chrono::steady_clock::now ();
+  double loadTime = std::chrono::duration<double, std::milli> (end - start).count ();
+  NS_ABORT_MSG_IF (pairs.empty (), "No Q-D files found for " << qdChannelFolder);
+
+  /* Look up every pair over the duration of its coarse trace */
+  uint64_t totalLookups = 0;
+  uint64_t rays = 0;
+  uint64_t comparedRays = 0;
+  double gainError = 0;
+  double delayError = 0;
+  double lookupTime = 0;
+  QdTrace dense;
+  for (size_t p = 0; p < pairs.size (); p++)
+    {
+      uint64_t lookups = uint64_t (loader->GetNTraceIndices (pairs[p].first, pairs[p].second) - 1)
+                       * qdInterval / lookupInterval + 1;
+      totalLookups += lookups;
+      bool compare = !reference.empty ()
+        && ReadQdTraceFile (GetQdTraceFileName ("DmgFiles/QdChannel/" + reference + "/", pairs[p].first, pairs[p].second), dense);
+      for (uint64_t lookup = 0; lookup < lookups; lookup++)
+        {
+          start = std::chrono::steady_clock::now ();
+          QdRealization realization = loader->GetRealization (pairs[p].first, pairs[p].second,
+                                                              MilliSeconds (lookup * lookupInterval));
+          end = std::chrono::steady_clock::now ();
+          lookupTime += std::chrono::duration<double, std::micro> (end - start).count ();
+          rays += realization.size ();
+          if (compare && (lookup < dense.size ()))
+            {
+              size_t matched = std::min (realization.size (), dense[lookup].size ());
+              for (size_t ray = 0; ray < matched; ray++)
+                {
+                  gainError += std::abs (realization[ray].pathGain - dense[lookup][ray].pathGain);
+                  delayError += std::abs (realization[ray].delay - dense[lookup][ray].delay) * 1e9;
+                }
+              comparedRays += matched;
+            }
+        }
+    }
+
+  std::cout << std::left << std::setw (12) << "Pairs"
+            << std::left << std::setw (16) << "Parsed Indices"
+            << std::left << std::setw (16) << "Dense Indices"
+            << std::left << std::setw (16) << "Load [ms]"
+            << std::left << std::setw (16) << "Lookup [us]"
+            << std::left << std::setw (16) << "Rays/Lookup"
+            << std::left << std::setw (16) << "Gain Err [dB]"
+            << std::left << std::setw (16) << "Delay Err [ns]" << std::endl;
+  std::cout << std::left << std::setw (12) << pairs.size ()
+            << std::left << std::setw (16) << loader->GetNParsedIndices ()
+            << std::left << std::setw (16) << totalLookups
+            << std::left << std::setw (16) << loadTime
+            << std::left << std::setw (16) << lookupTime / totalLookups
+            << std::left << std::setw (16) << double (rays) / totalLookups;
+  if (comparedRays > 0)
+    {
+      std::cout << std::left << std::setw (16) << gainError / comparedRays
+                << std::left << std::setw (16) << delayError / comparedRays;
+    }
+  else
+    {
+      std::cout << std::left << std::setw (16) << "-"
+                << std::left << std::setw (16) << "-";
+    }
+  std::cout << std::endl;
+
+  return 0;
+}
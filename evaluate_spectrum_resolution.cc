@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "ns3/spectrum-module.h"
+#include "dmg-spectrum-resolution.h"
+#include <chrono>
+#include <complex>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Produce the speed/accuracy table of the spectral resolution used for DMG/EDMG power spectral densities.
+ * Every SpectrumValue operation (applying the frequency-selective channel, summing interference, integrating
+ * the received power) costs proportionally to the number of bins, which grows with the bonded channel width
+ * (8.64 GHz for channel 25). A coarse resolution is sufficient for MAC studies, while PHY studies over
+ * frequency-selective Q-D channels need a fine one.
+ *
+ * For each channel width (2.16, 4.32, 6.48 and 8.64 GHz) and each resolution (bins per 2.16 GHz channel),
+ * the script measures:
+ * 1. The wall-clock time of the per-reception SpectrumValue operations.
+ * 2. The error of the effective SNR (capacity-based mapping over the bins) with respect to the finest
+ *    resolution, averaged over random multipath channels with an exponential power delay profile.
+ *
+ * Running the Simulation:
+ * ./waf --run "evaluate_spectrum_resolution --numChannels=100 --delaySpread=10"
+ *
+ * Simulation Output:
+ * A table with one line per channel width and resolution.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateSpectrumResolution");
+
+using namespace ns3;
+using namespace std;
+
+struct Ray {
+  double delay;
+  std::complex<double> gain;
+};
+
+/**
+ * Generate a random multipath channel with an exponential power delay profile.
+ */
+std::vector<Ray>
+GenerateChannel (Ptr<UniformRandomVariable> uniform, uint32_t numRays, double delaySpread)
+{
+  std::vector<Ray> rays;
+  Ray los;
+  los.delay = 0;
+  los.gain = 1;
+  rays.push_back (los);
+  for (uint32_t i = 1; i < numRays; i++)
+    {
+      Ray ray;
+      ray.delay = uniform->GetValue (0, 5 * delaySpread);
+      double amplitude = std::sqrt (std::exp (-ray.delay / delaySpread) * uniform->GetValue (0.1, 1.0));
+      ray.gain = std::polar (amplitude, uniform->GetValue (0, 2 * M_PI));
+      rays.push_back (ray);
+    }
+  return rays;
+}
+
+/**
+ * Compute the channel power gain at the center of each bin of the spectrum model.
+ */
+Ptr<SpectrumValue>
+CalculateChannelGain (const std::vector<Ray> &rays, Ptr<const SpectrumModel> model, double centerFrequency,
+                      double pathLossDb)
+{
+  Ptr<SpectrumValue> gain = Create<SpectrumValue> (model);
+  double pathLoss = std::pow (10.0, -pathLossDb / 10);
+  Values::iterator value = gain->ValuesBegin ();
+  for (Bands::const_iterator band = model->Begin (); band != model->End (); band++, value++)
+    {
+      std::complex<double> h = 0;
+      for (std::vector<Ray>::const_iterator ray = rays.begin (); ray != rays.end (); ray++)
+        {
+          h += ray->gain * std::polar (1.0, -2 * M_PI * (band->fc - centerFrequency) * ray->delay);
+        }
+      *value = pathLoss * std::norm (h);
+    }
+  return gain;
+}
+
+/**
+ * Map the per-bin SNR to an effective SNR through the average capacity.
+ * \return The effective SNR in dB.
+ */
+double
+CalculateEffectiveSnr (Ptr<const SpectrumValue> rxPsd, Ptr<const SpectrumValue> noisePsd)
+{
+  double capacity = 0;
+  double width = 0;
+  Values::const_iterator rx = rxPsd->ConstValuesBegin ();
+  Values::const_iterator noise = noisePsd->ConstValuesBegin ();
+  for (Bands::const_iterator band = rxPsd->ConstBandsBegin (); band != rxPsd->ConstBandsEnd (); band++, rx++, noise++)
+    {
+      double binWidth = band->fh - band->fl;
+      capacity += binWidth * std::log2 (1 + (*rx) / (*noise));
+      width += binWidth;
+    }
+  return 10 * std::log10 (std::pow (2.0, capacity / width) - 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  double centerFrequency = 60.48e9;   /* The center frequency of the bonded channel in Hz. */
+  double txPowerDbm = 10;             /* The transmit power in dBm. */
+  double pathLossDb = 80;             /* The path loss (including antenna gains) in dB. */
+  double noiseFigure = 10;            /* The noise figure of the receiver in dB. */
+  uint32_t numChannels = 100;         /* The number of random channel realizations. */
+  uint32_t numRays = 10;              /* The number of rays per channel realization. */
+  double delaySpread = 10;            /* The delay spread of the power delay profile in nanoseconds. */
+  uint32_t referenceBins = 1024;      /* The number of bins per 2.16 GHz channel of the reference. */
+  uint32_t iterations = 1000;         /* The number of repetitions used to time the operations. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("txPower", "The transmit power in dBm", txPowerDbm);
+  cmd.AddValue ("pathLoss", "The path loss including the antenna gains in dB", pathLossDb);
+  cmd.AddValue ("noiseFigure", "The noise figure of the receiver in dB", noiseFigure);
+  cmd.AddValue ("numChannels", "The number of random channel realizations", numChannels);
+  cmd.AddValue ("numRays", "The number of rays per channel realization", numRays);
+  cmd.AddValue ("delaySpread", "The delay spread of the channel in nanoseconds", delaySpread);
+  cmd.AddValue ("referenceBins", "The number of bins per 2.16 GHz channel of the reference resolution", referenceBins);
+  cmd.AddValue ("iterations", "The number of repetitions used to time the SpectrumValue operations", iterations);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  std::vector<std::vector<Ray> > channels;
+  for (uint32_t i = 0; i < numChannels; i++)
+    {
+      channels.push_back (GenerateChannel (uniform, numRays, delaySpread * 1e-9));
+    }
+
+  std::vector<uint32_t> resolutions = {8, 16, 32, 64, 128, 256, 512};
+  double txPowerW = std::pow (10.0, (txPowerDbm - 30) / 10);
+  double noisePsdValue = 1.380649e-23 * 290 * std::pow (10.0, noiseFigure / 10);
+
+  std::cout << std::left << std::setw (12) << "Width [GHz]"
+            << std::left << std::setw (12) << "Bins/2.16"
+            << std::left << std::setw (12) << "Bins"
+            << std::left << std::setw (16) << "Time/Rx [us]"
+            << std::left << std::setw (12) << "Speed-up"
+            << std::left << std::setw (16) << "Mean Err [dB]"
+            << std::left << std::setw (16) << "Max Err [dB]" << std::endl;
+
+  for (uint8_t bonded = 1; bonded <= 4; bonded++)
+    {
+      /* Reference effective SNR of each channel realization at the finest resolution */
+      Ptr<SpectrumModel> referenceModel = GetDmgSpectrumModel (centerFrequency, bonded, referenceBins);
+      Ptr<SpectrumValue> referenceTxPsd = CreateDmgTxPowerSpectralDensity (txPowerW, referenceModel);
+      Ptr<SpectrumValue> referenceNoisePsd = Create<SpectrumValue> (referenceModel);
+      (*referenceNoisePsd) = noisePsdValue;
+      std::vector<double> referenceSnr;
+      for (uint32_t i = 0; i < numChannels; i++)
+        {
+          Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (referenceTxPsd);
+          (*rxPsd) *= (*CalculateChannelGain (channels[i], referenceModel, centerFrequency, pathLossDb));
+          referenceSnr.push_back (CalculateEffectiveSnr (rxPsd, referenceNoisePsd));
+        }
+
+      double finestTime = 0;
+      for (std::vector<uint32_t>::const_reverse_iterator resolution = resolutions.rbegin ();
+           resolution != resolutions.rend (); resolution++)
+        {
+          Ptr<SpectrumModel> model = GetDmgSpectrumModel (centerFrequency, bonded, *resolution);
+          Ptr<SpectrumValue> txPsd = CreateDmgTxPowerSpectralDensity (txPowerW, model);
+          Ptr<SpectrumValue> noisePsd = Create<SpectrumValue> (model);
+          (*noisePsd) = noisePsdValue;
+
+          /* Accuracy */
+          double meanError = 0;
+          double maxError = 0;
+          Ptr<SpectrumValue> channelGain;
+          for (uint32_t i = 0; i < numChannels; i++)
+            {
+              channelGain = CalculateChannelGain (channels[i], model, centerFrequency, pathLossDb);
+              Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
+              (*rxPsd) *= (*channelGain);
+              double error = std::abs (CalculateEffectiveSnr (rxPsd, noisePsd) - referenceSnr[i]);
+              meanError += error / numChannels;
+              maxError = std::max (maxError, error);
+            }
+
+          /* Speed: per-reception operations done by the spectrum PHY and its interference helper */
+          double power = 0;
+          auto start = std::chrono::steady_clock::now ();
+          for (uint32_t n = 0; n < iterations; n++)
+            {
+              Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
+              (*rxPsd) *= (*channelGain);
+              SpectrumValue interference = (*rxPsd) + (*noisePsd);
+              SpectrumValue sinr = (*rxPsd) / interference;
+              power += Integral (*rxPsd) + Sum (sinr);
+            }
+          auto end = std::chrono::steady_clock::now ();
+          double time = std::chrono::duration<double, std::micro> (end - start).count () / iterations;
+          NS_ABORT_IF (std::isnan (power));
+          if (resolution == resolutions.rbegin ())
+            {
+              finestTime = time;
+            }
+
+          std::cout << std::left << std::setw (12) << bonded * DMG_CHANNEL_WIDTH / 1e9
+                    << std::left << std::setw (12) << *resolution
+                    << std::left << std::setw (12) << bonded * (*resolution)
+                    << std::left << std::setw (16) << time
+                    << std::left << std::setw (12) << finestTime / time
+                    << std::left << std::setw (16) << meanError
+                    << std::left << std::setw (16) << maxError << std::endl;
+        }
+    }
+
+  return 0;
+}
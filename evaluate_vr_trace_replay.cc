@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "common-functions.h"
+#include "dmg-simulation-statistics.h"
+#include "trace-replay-application.h"
+#include <cmath>
+#include <iomanip>
+
+/**
+ * Simulation Objective:
+ * Evaluate the delivery of a VR stream with tight per-frame deadlines over an IEEE 802.11ad link. The traffic
+ * is replayed from a packet trace (packet sizes, inter-arrival times and frame boundaries) instead of the CBR
+ * traffic of the OnOffApplication, so that MAC features can be evaluated on a realistic workload.
+ *
+ * Network Topology:
+ * The scenario consists of a single DMG PCP/AP (the VR server) and a single DMG STA (the headset).
+ *
+ *          DMG PCP/AP (0,0)                       DMG STA (+1,0)
+ *
+ * Simulation Description:
+ * Once the DMG STA has associated, the DMG PCP/AP replays the trace towards it. The trace is memory mapped and
+ * replayed with a batched timer, so traces with millions of packets can be used. The sink rebuilds the frames
+ * and classifies each of them as delivered on time, delivered late or lost.
+ *
+ * If no trace file is given, a synthetic VR trace is generated: frames at a constant frame rate whose size
+ * follows the target bitrate with a random variation, every GOP starting with a larger I-frame. Each frame
+ * is split into packets of at most payloadSize bytes sent back to back.
+ *
+ * Running Simulation:
+ * ./waf --run "evaluate_vr_trace_replay"
+ *
+ * To replay a recorded trace with a 10 ms deadline and a SP allocation:
+ * ./waf --run "evaluate_vr_trace_replay --traceFile=vr.bin --deadline=10 --scheme=0"
+ *
+ * Simulation Output:
+ * The simulation generates the following traces:
+ * 1. The frames sent, delivered on time, delivered late and lost, and the average frame latency.
+ * 2. Optionally, the latency of every frame in FrameLatency.csv.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("EvaluateVrTraceReplay");
+
+using namespace ns3;
+using namespace std;
+
+/* Network Nodes */
+Ptr<DmgApWifiMac> apWifiMac;
+Ptr<DmgStaWifiMac> staWifiMac;
+
+/* Access Period Parameters */
+uint32_t allocationType = CBAP_ALLOCATION;      /* The type of channel access scheme during DTI (CBAP is the default). */
+
+void
+StationAssoicated (Ptr<DmgStaWifiMac> staWifiMac, Mac48Address address, uint16_t aid)
+{
+  std::cout << "DMG STA " << staWifiMac->GetAddress () << " associated with DMG AP " << address << std::endl;
+  std::cout << "Association ID (AID) = " << aid << std::endl;
+  if (allocationType == SERVICE_PERIOD_ALLOCATION)
+    {
+      std::cout << "Allocate DTI as Service Period" << std::endl;
+      apWifiMac->AllocateDTIAsServicePeriod (1, AID_AP, staWifiMac->GetAssociationID ());
+    }
+}
+
+void
+FrameDelivered (Ptr<OutputStreamWrapper> stream, uint32_t frameId, Time latency, bool onTime)
+{
+  *stream->GetStream () << frameId << "," << latency.GetMicroSeconds () << "," << onTime << std::endl;
+}
+
+/**
+ * Generate a synthetic VR trace.
+ * \param fileName The path to the binary trace file.
+ * \param frames The number of frames.
+ * \param frameRate The number of frames per second.
+ * \param bitrate The average bitrate in bps.
+ * \param gopSize The number of frames of a group of pictures.
+ * \param iFrameRatio The size of an I-frame relative to a P-frame.
+ * \param sizeVariation The relative standard deviation of the frame size.
+ * \param maxPacketSize The maximum packet size in bytes.
+ */
+void
+GenerateVrTrace (string fileName, uint32_t frames, double frameRate, double bitrate,
+                 uint32_t gopSize, double iFrameRatio, double sizeVariation, uint32_t maxPacketSize)
+{
+  /* Average P-frame size such that a GOP carries the target bitrate */
+  double pFrameSize = bitrate / 8 / frameRate * gopSize / (gopSize - 1 + iFrameRatio);
+  Ptr<NormalRandomVariable> variation = CreateObject<NormalRandomVariable> ();
+  variation->SetAttribute ("Mean", DoubleValue (1));
+  variation->SetAttribute ("Variance", DoubleValue (sizeVariation * sizeVariation));
+  variation->SetAttribute ("Bound", DoubleValue (3 * sizeVariation));
+  Time framePeriod = Seconds (1 / frameRate);
+
+  TraceReplayFileWriter writer (fileName);
+  for (uint32_t frame = 0; frame < frames; frame++)
+    {
+      double mean = (frame % gopSize == 0) ? iFrameRatio * pFrameSize : pFrameSize;
+      uint32_t size = std::max (1.0, mean * variation->GetValue ());
+      Time interArrival = (frame == 0) ? Seconds (0) : framePeriod;
+      while (size > 0)
+        {
+          uint32_t packet = std::min (size, maxPacketSize);
+          writer.Add (interArrival, packet, frame);
+          interArrival = Seconds (0);
+          size -= packet;
+        }
+    }
+  writer.Close ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  string traceFile = "";                        /* The binary traffic trace file, empty to generate a synthetic VR trace. */
+  uint32_t payloadSize = 1472;                  /* Maximum application payload size in bytes of the synthetic trace. */
+  double frameRate = 90;                        /* Frame rate of the synthetic trace. */
+  string bitrate = "1Gbps";                     /* Average bitrate of the synthetic trace. */
+  uint32_t gopSize = 30;                        /* Group of pictures size of the synthetic trace. */
+  double iFrameRatio = 3;                       /* Size of an I-frame relative to a P-frame in the synthetic trace. */
+  double sizeVariation = 0.2;                   /* Relative standard deviation of the frame size in the synthetic trace. */
+  uint32_t deadline = 20;                       /* The frame deadline in milliseconds. */
+  uint32_t batchWindow = 0;                     /* The batch window of the replay timer in microseconds. */
+  string msduAggSize = "max";                   /* The maximum aggregation size for A-MSDU in Bytes. */
+  string mpduAggSize = "max";                   /* The maximum aggregation size for A-MPDU in Bytes. */
+  string queueSize = "4000p";                   /* Wifi MAC Queue Size. */
+  string phyMode = "DMG_MCS12";                 /* Type of the Physical Layer. */
+  bool verbose = false;                         /* Print Logging Information. */
+  double simulationTime = 10;                   /* Simulation time in seconds. */
+  bool frameTracing = false;                    /* Write the latency of every frame. */
+  bool pcapTracing = false;                     /* PCAP Tracing is enabled. */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("traceFile", "The binary traffic trace file, leave empty to generate a synthetic VR trace", traceFile);
+  cmd.AddValue ("payloadSize", "Maximum application payload size in bytes of the synthetic trace", payloadSize);
+  cmd.AddValue ("frameRate", "Frame rate of the synthetic trace", frameRate);
+  cmd.AddValue ("bitrate", "Average bitrate of the synthetic trace", bitrate);
+  cmd.AddValue ("gopSize", "Group of pictures size of the synthetic trace", gopSize);
+  cmd.AddValue ("iFrameRatio", "Size of an I-frame relative to a P-frame in the synthetic trace", iFrameRatio);
+  cmd.AddValue ("sizeVariation", "Relative standard deviation of the frame size in the synthetic trace", sizeVariation);
+  cmd.AddValue ("deadline", "The frame deadline in milliseconds", deadline);
+  cmd.AddValue ("batchWindow", "Packets due within this window in microseconds are sent by the same timer event", batchWindow);
+  cmd.AddValue ("msduAggSize", "The maximum aggregation size for A-MSDU in Bytes", msduAggSize);
+  cmd.AddValue ("mpduAggSize", "The maximum aggregation size for A-MPDU in Bytes", mpduAggSize);
+  cmd.AddValue ("scheme", "The access scheme used for channel access (0: SP allocation, 1: CBAP allocation)", allocationType);
+  cmd.AddValue ("queueSize", "The maximum size of the Wifi MAC Queue", queueSize);
+  cmd.AddValue ("phyMode", "The WiGig PHY Mode", phyMode);
+  cmd.AddValue ("verbose", "Turn on all WifiNetDevice log components", verbose);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("frameTracing", "Write the latency of every frame to FrameLatency.csv", frameTracing);
+  cmd.AddValue ("pcap", "Enable PCAP Tracing", pcapTracing);
+  cmd.Parse (argc, argv);
+
+  /* Validate A-MSDU and A-MPDU values */
+  ValidateFrameAggregationAttributes (msduAggSize, mpduAggSize);
+  /* Configure RTS/CTS and Fragmentation */
+  ConfigureRtsCtsAndFragmenatation ();
+  /* Wifi MAC Queue Parameters */
+  ChangeQueueSize (queueSize);
+
+  if (traceFile.empty ())
+    {
+      traceFile = "VrTrace.bin";
+      GenerateVrTrace (traceFile, std::ceil ((simulationTime - 1) * frameRate), frameRate,
+                       DataRate (bitrate).GetBitRate (), gopSize, iFrameRatio, sizeVariation, payloadSize);
+    }
+
+  /**** WifiHelper is a meta-helper: it helps creates helpers ****/
+  DmgWifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ad);
+
+  /* Turn on logging */
+  if (verbose)
+    {
+      wifi.EnableLogComponents ();
+      LogComponentEnable ("EvaluateVrTraceReplay", LOG_LEVEL_ALL);
+    }
+
+  /**** Set up Channel ****/
+  DmgWifiChannelHelper wifiChannel ;
+  /* Simple propagation delay model */
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  /* Friis model with standard-specific wavelength */
+  wifiChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel", "Frequency", DoubleValue (60.48e9));
+
+  /**** Setup physical layer ****/
+  DmgWifiPhyHelper wifiPhy = DmgWifiPhyHelper::Default ();
+  /* Nodes will be added to the channel we set up earlier */
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  /* All nodes transmit at 10 dBm == 10 mW, no adaptation */
+  wifiPhy.Set ("TxPowerStart", DoubleValue (10.0));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (10.0));
+  wifiPhy.Set ("TxPowerLevels", UintegerValue (1));
+  /* Set operating channel */
+  wifiPhy.Set ("ChannelNumber", UintegerValue (2));
+  /* Set default algorithm for all nodes to be constant rate */
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue (phyMode));
+
+  /* Make two nodes and set them up with the PHY and the MAC */
+  NodeContainer wifiNodes;
+  wifiNodes.Create (2);
+  Ptr<Node> apWifiNode = wifiNodes.Get (0);
+  Ptr<Node> staWifiNode = wifiNodes.Get (1);
+
+  /* Add a DMG upper mac */
+  DmgWifiMacHelper wifiMac = DmgWifiMacHelper::Default ();
+
+  Ssid ssid = Ssid ("VR");
+  wifiMac.SetType ("ns3::DmgApWifiMac",
+                   "Ssid", SsidValue(ssid),
+                   "BE_MaxAmpduSize", StringValue (mpduAggSize),
+                   "BE_MaxAmsduSize", StringValue (msduAggSize),
+                   "SSSlotsPerABFT", UintegerValue (8), "SSFramesPerSlot", UintegerValue (8),
+                   "BeaconInterval", TimeValue (MicroSeconds (102400)));
+
+  /* Set Analytical Codebook for the DMG Devices */
+  wifi.SetCodebook ("ns3::CodebookAnalytical",
+                    "CodebookType", EnumValue (SIMPLE_CODEBOOK),
+                    "Antennas", UintegerValue (1),
+                    "Sectors", UintegerValue (8));
+
+  /* Create Wifi Network Devices (WifiNetDevice) */
+  NetDeviceContainer apDevice;
+  apDevice = wifi.Install (wifiPhy, wifiMac, apWifiNode);
+
+  wifiMac.SetType ("ns3::DmgStaWifiMac",
+                   "Ssid", SsidValue (ssid), "ActiveProbing", BooleanValue (false),
+                   "BE_MaxAmpduSize", StringValue (mpduAggSize),
+                   "BE_MaxAmsduSize", StringValue (msduAggSize));
+
+  NetDeviceContainer staDevice;
+  staDevice = wifi.Install (wifiPhy, wifiMac, staWifiNode);
+
+  /* Setting mobility model */
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));  /* PCP/AP */
+  positionAlloc->Add (Vector (1.0, 0.0, 0.0));  /* DMG STA */
+
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiNodes);
+
+  /* Internet stack*/
+  InternetStackHelper stack;
+  stack.Install (wifiNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer apInterface;
+  apInterface = address.Assign (apDevice);
+  Ipv4InterfaceContainer staInterface;
+  staInterface = address.Assign (staDevice);
+
+  /* Populate routing table */
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* We do not want any ARP packets */
+  PopulateArpCache ();
+
+  /* Install the VR sink on the DMG STA */
+  Ptr<TraceReplaySink> replaySink = CreateObject<TraceReplaySink> ();
+  replaySink->SetAttribute ("Local", AddressValue (InetSocketAddress (Ipv4Address::GetAny (), 9999)));
+  replaySink->SetAttribute ("Deadline", TimeValue (MilliSeconds (deadline)));
+  staWifiNode->AddApplication (replaySink);
+  replaySink->SetStartTime (Seconds (0.0));
+
+  /* Install the VR source on the DMG PCP/AP, the last frames are given their deadline before the end */
+  Ptr<TraceReplayApplication> replayApp = CreateObject<TraceReplayApplication> ();
+  replayApp->SetAttribute ("TraceFile", StringValue (traceFile));
+  replayApp->SetAttribute ("Remote", AddressValue (InetSocketAddress (staInterface.GetAddress (0), 9999)));
+  replayApp->SetAttribute ("BatchWindow", TimeValue (MicroSeconds (batchWindow)));
+  replayApp->SetStartTime (Seconds (1.0));
+  replayApp->SetStopTime (Seconds (simulationTime) - MilliSeconds (deadline));
+  apWifiNode->AddApplication (replayApp);
+
+  /* Print Traces */
+  if (pcapTracing)
+    {
+      wifiPhy.SetPcapDataLinkType (YansWifiPhyHelper::DLT_IEEE802_11_RADIO);
+      wifiPhy.EnablePcap ("Traces/AccessPoint", apDevice, false);
+      wifiPhy.EnablePcap ("Traces/Station", staDevice, false);
+    }
+
+  /* Stations */
+  apWifiMac = StaticCast<DmgApWifiMac> (StaticCast<WifiNetDevice> (apDevice.Get (0))->GetMac ());
+  staWifiMac = StaticCast<DmgStaWifiMac> (StaticCast<WifiNetDevice> (staDevice.Get (0))->GetMac ());
+
+  /* Connect Traces */
+  staWifiMac->TraceConnectWithoutContext ("Assoc", MakeBoundCallback (&StationAssoicated, staWifiMac));
+  if (frameTracing)
+    {
+      AsciiTraceHelper ascii;
+      Ptr<OutputStreamWrapper> frameStream = ascii.CreateFileStream ("FrameLatency.csv");
+      *frameStream->GetStream () << "FRAME_ID,LATENCY_US,ON_TIME" << std::endl;
+      replaySink->TraceConnectWithoutContext ("Frame", MakeBoundCallback (&FrameDelivered, frameStream));
+    }
+
+  Simulator::Stop (Seconds (simulationTime));
+  SimulationCost cost = RunSimulation ();
+
+  /* Print Results Summary */
+  uint64_t sentFrames = replayApp->GetTotalTxFrames ();
+  std::cout << "\nTrace File = " << traceFile << ", Deadline = " << deadline << " ms" << std::endl;
+  std::cout << "  Packets Sent = " << replayApp->GetTotalTxPackets ()
+            << ", Refused by the Socket = " << replayApp->GetTotalDroppedPackets () << std::endl;
+  std::cout << std::left << std::setw (12) << "Sent"
+            << std::left << std::setw (12) << "On Time"
+            << std::left << std::setw (12) << "Late"
+            << std::left << std::setw (12) << "Lost"
+            << std::left << std::setw (16) << "Latency [ms]" << std::endl;
+  std::cout << std::left << std::setw (12) << sentFrames
+            << std::left << std::setw (12) << replaySink->GetTotalOnTimeFrames ()
+            << std::left << std::setw (12) << replaySink->GetTotalLateFrames ()
+            << std::left << std::setw (12) << replaySink->GetTotalLostFrames (sentFrames)
+            << std::left << std::setw (16) << replaySink->GetAverageFrameLatency ().GetSeconds () * 1e3 << std::endl;
+  std::cout << "  Received Bytes = " << replaySink->GetTotalRx () << std::endl;
+  PrintSimulationCost (std::cout, cost);
+
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef EVENT_STREAM_DIGEST_H
+#define EVENT_STREAM_DIGEST_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * Type of the events mixed into the digest.
+ */
+enum DigestEventType {
+  DIGEST_PHY_TX_BEGIN = 1,
+  DIGEST_PHY_RX_END,
+  DIGEST_PHY_RX_DROP,
+  DIGEST_MAC_RX_SNR,
+  DIGEST_SLS_COMPLETED,
+};
+
+/**
+ * Rolling digest of the key events of a simulation. The digest is used to
+ * check that an optimised build (e.g. a faster propagation or error model)
+ * still produces the same simulation as the reference build, without storing
+ * and diffing full traces.
+ *
+ * Every event is reduced to a canonical record: the simulation time in
+ * nanoseconds, the node, the event type and a few fields of the event. The
+ * packet UIDs are not part of the record, since they depend on the number of
+ * packets allocated and not on the behaviour of the network. The SNR is
+ * rounded to SnrTolerance so that floating point noise does not change the
+ * digest. The records are hashed with FNV-1a.
+ *
+ * The digest is restarted every Interval of simulation time and one line is
+ * written per interval:
+ *
+ *   Interval,Start,Events,Digest
+ *
+ * Comparing the files of two builds gives the first divergent interval, see
+ * FindFirstDivergentInterval. Intervals are closed lazily by the first event
+ * after their end, so the digest does not schedule any event itself.
+ */
+class EventStreamDigest : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  EventStreamDigest ();
+  virtual ~EventStreamDigest ();
+
+  /**
+   * Open the output file, the header line is written immediately.
+   * \param fileName The name of the output file.
+   */
+  void Open (std::string fileName);
+  /**
+   * Connect the PHY, remote station manager and MAC traces of the devices.
+   * \param devices The WifiNetDevices to monitor.
+   */
+  void Install (NetDeviceContainer devices);
+  /**
+   * Close the intervals up to the current simulation time, including the
+   * ongoing one. Called once at the end of the simulation.
+   */
+  void Flush (void);
+
+  /**
+   * \return The digest of all the closed intervals.
+   */
+  uint64_t GetTotalDigest (void) const;
+  /**
+   * \return The number of events mixed into the digest.
+   */
+  uint64_t GetTotalEvents (void) const;
+  /**
+   * \return The number of closed intervals.
+   */
+  uint32_t GetNIntervals (void) const;
+
+  /**
+   * Compare two digest files line by line.
+   * \param fileA The first digest file.
+   * \param fileB The second digest file.
+   * \return The index of the first interval whose digest differs, -1 if the
+   * files match. If one file is a prefix of the other, the index of the first
+   * missing interval is returned.
+   */
+  static int64_t FindFirstDivergentInterval (std::string fileA, std::string fileB);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void PhyTxBegin (std::string context, Ptr<const Packet> packet, double txPowerW);
+  void PhyRxEnd (std::string context, Ptr<const Packet> packet);
+  void PhyRxDrop (std::string context, Ptr<const Packet> packet, WifiPhyRxfailureReason reason);
+  void MacRxOk (std::string context, WifiMacType type, Mac48Address address, double snr);
+  void SlsCompleted (std::string context, SlsCompletionAttrbitutes attributes);
+
+  /**
+   * Start the record of an event, closing the elapsed intervals first.
+   * \param context The trace context, i.e. the node identifier.
+   * \param type The type of the event.
+   */
+  void BeginEvent (const std::string &context, DigestEventType type);
+  void Mix (uint64_t value);
+  void Mix (const std::string &value);
+  void CloseInterval (void);
+
+  Time m_interval;                      //!< Duration of an interval.
+  double m_snrTolerance;                //!< Rounding step of the SNR in dB.
+  std::ofstream m_file;                 //!< Output file.
+  uint32_t m_index;                     //!< Index of the ongoing interval.
+  uint64_t m_digest;                    //!< Digest of the ongoing interval.
+  uint64_t m_events;                    //!< Number of events in the ongoing interval.
+  uint64_t m_totalDigest;               //!< Digest chaining the digests of the closed intervals.
+  uint64_t m_totalEvents;               //!< Number of events in all the intervals.
+
+};
+
+#define DIGEST_FNV_OFFSET 14695981039346656037ULL   //!< FNV-1a offset basis.
+#define DIGEST_FNV_PRIME  1099511628211ULL          //!< FNV-1a prime.
+
+NS_OBJECT_ENSURE_REGISTERED (EventStreamDigest);
+
+TypeId
+EventStreamDigest::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EventStreamDigest")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<EventStreamDigest> ()
+    .AddAttribute ("Interval", "The simulation time covered by one digest.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&EventStreamDigest::m_interval),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("SnrTolerance", "The rounding step of the SNR values in dB.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&EventStreamDigest::m_snrTolerance),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+EventStreamDigest::EventStreamDigest ()
+  : m_index (0),
+    m_digest (DIGEST_FNV_OFFSET),
+    m_events (0),
+    m_totalDigest (DIGEST_FNV_OFFSET),
+    m_totalEvents (0)
+{
+}
+
+EventStreamDigest::~EventStreamDigest ()
+{
+}
+
+void
+EventStreamDigest::DoDispose (void)
+{
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  Object::DoDispose ();
+}
+
+void
+EventStreamDigest::Open (std::string fileName)
+{
+  m_file.open (fileName.c_str (), std::ofstream::out | std::ofstream::trunc);
+  NS_ABORT_MSG_IF (!m_file.is_open (), "Cannot open the digest file " << fileName);
+  m_file << "Interval,Start,Events,Digest" << std::endl;
+}
+
+void
+EventStreamDigest::Install (NetDeviceContainer devices)
+{
+  for (NetDeviceContainer::Iterator it = devices.Begin (); it != devices.End (); it++)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (*it);
+      NS_ABORT_MSG_IF (device == 0, "The event stream digest only supports WifiNetDevices");
+      /* The context identifies the node in the records */
+      std::ostringstream context;
+      context << device->GetNode ()->GetId ();
+      device->GetPhy ()->TraceConnect ("PhyTxBegin", context.str (),
+                                       MakeCallback (&EventStreamDigest::PhyTxBegin, this));
+      device->GetPhy ()->TraceConnect ("PhyRxEnd", context.str (),
+                                       MakeCallback (&EventStreamDigest::PhyRxEnd, this));
+      device->GetPhy ()->TraceConnect ("PhyRxDrop", context.str (),
+                                       MakeCallback (&EventStreamDigest::PhyRxDrop, this));
+      device->GetRemoteStationManager ()->TraceConnect ("MacRxOK", context.str (),
+                                                        MakeCallback (&EventStreamDigest::MacRxOk, this));
+      Ptr<DmgWifiMac> mac = DynamicCast<DmgWifiMac> (device->GetMac ());
+      if (mac)
+        {
+          mac->TraceConnect ("SLSCompleted", context.str (),
+                             MakeCallback (&EventStreamDigest::SlsCompleted, this));
+        }
+    }
+}
+
+void
+EventStreamDigest::Mix (uint64_t value)
+{
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      m_digest ^= (value >> (8 * i)) & 0xff;
+      m_digest *= DIGEST_FNV_PRIME;
+    }
+}
+
+void
+EventStreamDigest::Mix (const std::string &value)
+{
+  for (std::string::const_iterator it = value.begin (); it != value.end (); it++)
+    {
+      m_digest ^= static_cast<uint8_t> (*it);
+      m_digest *= DIGEST_FNV_PRIME;
+    }
+  /* Separator, so that ("1", "2") and ("12") differ */
+  m_digest ^= 0xff;
+  m_digest *= DIGEST_FNV_PRIME;
+}
+
+void
+EventStreamDigest::CloseInterval (void)
+{
+  if (m_file.is_open ())
+    {
+      m_file << m_index << "," << (m_interval * m_index).GetSeconds () << "," << m_events << ","
+             << std::hex << std::setw (16) << std::setfill ('0') << m_digest
+             << std::dec << std::setfill (' ') << std::endl;
+    }
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      m_totalDigest ^= (m_digest >> (8 * i)) & 0xff;
+      m_totalDigest *= DIGEST_FNV_PRIME;
+    }
+  m_index++;
+  m_digest = DIGEST_FNV_OFFSET;
+  m_events = 0;
+}
+
+void
+EventStreamDigest::BeginEvent (const std::string &context, DigestEventType type)
+{
+  Time now = Simulator::Now ();
+  while (now >= m_interval * (m_index + 1))
+    {
+      CloseInterval ();
+    }
+  m_events++;
+  m_totalEvents++;
+  Mix (static_cast<uint64_t> (now.GetNanoSeconds ()));
+  Mix (context);
+  Mix (static_cast<uint64_t> (type));
+}
+
+void
+EventStreamDigest::PhyTxBegin (std::string context, Ptr<const Packet> packet, double)
+{
+  BeginEvent (context, DIGEST_PHY_TX_BEGIN);
+  Mix (static_cast<uint64_t> (packet->GetSize ()));
+}
+
+void
+EventStreamDigest::PhyRxEnd (std::string context, Ptr<const Packet> packet)
+{
+  BeginEvent (context, DIGEST_PHY_RX_END);
+  Mix (static_cast<uint64_t> (packet->GetSize ()));
+}
+
+void
+EventStreamDigest::PhyRxDrop (std::string context, Ptr<const Packet> packet, WifiPhyRxfailureReason reason)
+{
+  BeginEvent (context, DIGEST_PHY_RX_DROP);
+  Mix (static_cast<uint64_t> (packet->GetSize ()));
+  Mix (static_cast<uint64_t> (reason));
+}
+
+void
+EventStreamDigest::MacRxOk (std::string context, WifiMacType type, Mac48Address address, double snr)
+{
+  BeginEvent (context, DIGEST_MAC_RX_SNR);
+  Mix (static_cast<uint64_t> (type));
+  std::ostringstream peer;
+  peer << address;
+  Mix (peer.str ());
+  /* Round the SNR in dB to the tolerance */
+  int64_t snrSteps = 0;
+  if ((snr > 0) && (m_snrTolerance > 0))
+    {
+      snrSteps = static_cast<int64_t> (std::floor (RatioToDb (snr) / m_snrTolerance + 0.5));
+    }
+  Mix (static_cast<uint64_t> (snrSteps));
+}
+
+void
+EventStreamDigest::SlsCompleted (std::string context, SlsCompletionAttrbitutes attributes)
+{
+  BeginEvent (context, DIGEST_SLS_COMPLETED);
+  std::ostringstream peer;
+  peer << attributes.peerStation;
+  Mix (peer.str ());
+  Mix (static_cast<uint64_t> (attributes.accessPeriod));
+  Mix (static_cast<uint64_t> (attributes.antennaID));
+  Mix (static_cast<uint64_t> (attributes.sectorID));
+}
+
+void
+EventStreamDigest::Flush (void)
+{
+  Time now = Simulator::Now ();
+  while (now >= m_interval * m_index)
+    {
+      CloseInterval ();
+    }
+  if (m_file.is_open ())
+    {
+      m_file.flush ();
+    }
+}
+
+uint64_t
+EventStreamDigest::GetTotalDigest (void) const
+{
+  return m_totalDigest;
+}
+
+uint64_t
+EventStreamDigest::GetTotalEvents (void) const
+{
+  return m_totalEvents;
+}
+
+uint32_t
+EventStreamDigest::GetNIntervals (void) const
+{
+  return m_index;
+}
+
+int64_t
+EventStreamDigest::FindFirstDivergentInterval (std::string fileA, std::string fileB)
+{
+  std::ifstream a (fileA.c_str ());
+  std::ifstream b (fileB.c_str ());
+  NS_ABORT_MSG_IF (!a.is_open (), "Cannot open the digest file " << fileA);
+  NS_ABORT_MSG_IF (!b.is_open (), "Cannot open the digest file " << fileB);
+  std::string lineA, lineB;
+  /* Skip the header lines */
+  std::getline (a, lineA);
+  std::getline (b, lineB);
+  int64_t index = 0;
+  while (true)
+    {
+      bool moreA = static_cast<bool> (std::getline (a, lineA));
+      bool moreB = static_cast<bool> (std::getline (b, lineB));
+      if (!moreA && !moreB)
+        {
+          return -1;
+        }
+      if ((moreA != moreB) || (lineA != lineB))
+        {
+          return index;
+        }
+      index++;
+    }
+}
+
+} // namespace ns3
+
+#endif // EVENT_STREAM_DIGEST_H
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef FAST_SESSION_TRANSFER_H
+#define FAST_SESSION_TRANSFER_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "dmg-link-failover.h"
+
+namespace ns3 {
+
+/********************************************************
+ *          Multi-Band Fast Session Transfer
+ ********************************************************/
+
+/**
+ * The band currently carrying the session.
+ */
+enum FstBand {
+  FST_DMG_BAND = 0,
+  FST_LEGACY_BAND = 1,
+};
+
+/**
+ * Ethertype of the probes exchanged over the DMG link (local experimental).
+ */
+static const uint16_t FST_PROBE_PROTOCOL = 0x88B5;
+
+/**
+ * Fast session transfer (FST) between the DMG interface and a legacy (sub-6
+ * GHz) interface of a multi-band node, in the spirit of IEEE 802.11ad 10.32.
+ * The session is bound to the IP address of the peer DMG interface. When the
+ * DMG link fails (FailureThreshold consecutive MSDUs dropped after exhausting
+ * their retries, an MSDU acknowledged by the peer resets the count), the
+ * manager installs a host route towards the peer DMG address through the
+ * legacy interface, so the session continues on the legacy band without any
+ * change at the transport layer. While on the legacy band, it
+ * probes the DMG link every ProbeInterval and removes the host route as soon as
+ * a probe from the peer is received, i.e. when the link has recovered. Each
+ * end of the session needs its own manager. The failure detection and the
+ * host route are handled by DmgLinkFailover.
+ */
+class FastSessionTransfer : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  FastSessionTransfer ();
+  virtual ~FastSessionTransfer ();
+
+  /**
+   * Setup the session between this node and the peer node.
+   * \param dmgDevice The DMG interface of this node.
+   * \param legacyDevice The legacy interface of this node.
+   * \param peerDmgAddress The MAC address of the DMG interface of the peer.
+   * \param peerDmgIp The IP address of the DMG interface of the peer, used as the session address.
+   * \param peerLegacyIp The IP address of the legacy interface of the peer.
+   */
+  void Setup (Ptr<WifiNetDevice> dmgDevice, Ptr<NetDevice> legacyDevice,
+              Mac48Address peerDmgAddress, Ipv4Address peerDmgIp, Ipv4Address peerLegacyIp);
+  /**
+   * \return The band currently carrying the session.
+   */
+  FstBand GetActiveBand (void) const;
+  /**
+   * \return The number of session transfers so far.
+   */
+  uint32_t GetNTransfers (void) const;
+
+  /**
+   * TracedCallback signature for session transfers.
+   * \param band The new band carrying the session.
+   */
+  typedef void (* SessionTransferCallback)(FstBand band);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  enum ProbeType {
+    PROBE_REQUEST = 0,
+    PROBE_RESPONSE = 1,
+  };
+
+  void TransferToLegacy (void);
+  void TransferToDmg (void);
+  void SendProbe (ProbeType type);
+  void ProbeTimeout (void);
+  void ReceiveProbe (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                     const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  uint32_t m_failureThreshold;                    //!< Consecutive dropped MSDUs before transferring the session.
+  Time m_probeInterval;                           //!< Interval between probes of the DMG link.
+  Ptr<WifiNetDevice> m_dmgDevice;                 //!< DMG interface.
+  Ptr<NetDevice> m_legacyDevice;                  //!< Legacy interface.
+  DmgLinkFailover m_failover;                     //!< Failure detection of the DMG link and legacy host route.
+  Mac48Address m_peerDmgAddress;                  //!< MAC address of the peer DMG interface.
+  FstBand m_band;                                 //!< Band carrying the session.
+  uint32_t m_transfers;                           //!< Number of session transfers.
+  EventId m_probeEvent;                           //!< Next probe.
+  TracedCallback<FstBand> m_sessionTransfer;      //!< Trace fired upon a session transfer.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (FastSessionTransfer);
+
+TypeId
+FastSessionTransfer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FastSessionTransfer")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<FastSessionTransfer> ()
+    .AddAttribute ("FailureThreshold", "The number of consecutive MSDUs dropped on the DMG band "
+                   "before transferring the session to the legacy band.",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&FastSessionTransfer::m_failureThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ProbeInterval", "The interval between two probes of the DMG link while on the legacy band.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&FastSessionTransfer::m_probeInterval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("SessionTransfer", "The session has been transferred to another band.",
+                     MakeTraceSourceAccessor (&FastSessionTransfer::m_sessionTransfer),
+                     "ns3::FastSessionTransfer::SessionTransferCallback")
+  ;
+  return tid;
+}
+
+FastSessionTransfer::FastSessionTransfer ()
+  : m_band (FST_DMG_BAND),
+    m_transfers (0)
+{
+}
+
+FastSessionTransfer::~FastSessionTransfer ()
+{
+}
+
+void
+FastSessionTransfer::DoDispose (void)
+{
+  m_probeEvent.Cancel ();
+  m_dmgDevice = 0;
+  m_legacyDevice = 0;
+  m_failover.Dispose ();
+  Object::DoDispose ();
+}
+
+void
+FastSessionTransfer::Setup (Ptr<WifiNetDevice> dmgDevice, Ptr<NetDevice> legacyDevice,
+                            Mac48Address peerDmgAddress, Ipv4Address peerDmgIp, Ipv4Address peerLegacyIp)
+{
+  m_dmgDevice = dmgDevice;
+  m_legacyDevice = legacyDevice;
+  m_peerDmgAddress = peerDmgAddress;
+
+  m_failover.Setup (dmgDevice, peerDmgAddress, m_failureThreshold,
+                     MakeCallback (&FastSessionTransfer::TransferToLegacy, this));
+  m_failover.SetHostRoute (peerDmgIp, peerLegacyIp, legacyDevice);
+  dmgDevice->GetNode ()->RegisterProtocolHandler (MakeCallback (&FastSessionTransfer::ReceiveProbe, this),
+                                                  FST_PROBE_PROTOCOL, dmgDevice);
+}
+
+FstBand
+FastSessionTransfer::GetActiveBand (void) const
+{
+  return m_band;
+}
+
+uint32_t
+FastSessionTransfer::GetNTransfers (void) const
+{
+  return m_transfers;
+}
+
+void
+FastSessionTransfer::TransferToLegacy (void)
+{
+  m_failover.AddHostRoute ();
+  m_failover.SetMonitoring (false);
+  m_band = FST_LEGACY_BAND;
+  m_transfers++;
+  m_sessionTransfer (m_band);
+  m_probeEvent = Simulator::Schedule (m_probeInterval, &FastSessionTransfer::ProbeTimeout, this);
+}
+
+void
+FastSessionTransfer::TransferToDmg (void)
+{
+  m_failover.RemoveHostRoute ();
+  m_failover.SetMonitoring (true);
+  m_probeEvent.Cancel ();
+  m_band = FST_DMG_BAND;
+  m_transfers++;
+  m_sessionTransfer (m_band);
+}
+
+void
+FastSessionTransfer::SendProbe (ProbeType type)
+{
+  uint8_t payload = type;
+  m_dmgDevice->Send (Create<Packet> (&payload, 1), m_peerDmgAddress, FST_PROBE_PROTOCOL);
+}
+
+void
+FastSessionTransfer::ProbeTimeout (void)
+{
+  SendProbe (PROBE_REQUEST);
+  m_probeEvent = Simulator::Schedule (m_probeInterval, &FastSessionTransfer::ProbeTimeout, this);
+}
+
+void
+FastSessionTransfer::ReceiveProbe (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                   const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  if (Mac48Address::ConvertFrom (from) != m_peerDmgAddress)
+    {
+      return;
+    }
+  uint8_t type;
+  packet->CopyData (&type, 1);
+  /* The DMG link works again, bring the session back to the DMG band */
+  if (m_band == FST_LEGACY_BAND)
+    {
+      TransferToDmg ();
+    }
+  /* Let the peer know in case it is still on the legacy band */
+  if (type == PROBE_REQUEST)
+    {
+      SendProbe (PROBE_RESPONSE);
+    }
+}
+
+} // namespace ns3
+
+#endif // FAST_SESSION_TRANSFER_H
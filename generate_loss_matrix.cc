@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "geometry-loss-matrix-builder.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+/**
+ * Simulation Objective:
+ * Generate the loss matrix of a large deployment from its floor plan. The loss between each pair of nodes is the
+ * Friis free-space loss at the carrier frequency plus the penetration loss of every wall crossed by the direct path.
+ * The output is a binary matrix file which can be loaded into a DenseMatrixPropagationLossModel using
+ * GeometryLossMatrixBuilder::LoadBinaryFile instead of calling SetLoss for every pair.
+ *
+ * Input Files:
+ * 1. Positions file: one node per line given as "x y z" in meters.
+ * 2. Floor plan file: one wall per line given as "x1 y1 x2 y2 zMin zMax lossDb".
+ *
+ * Running the Simulation:
+ * ./waf --run "generate_loss_matrix --positions=positions.txt --walls=walls.txt --output=lossMatrix.bin --threads=8"
+ *
+ * Simulation Output:
+ * The binary loss matrix file and the time spent to compute it.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("GenerateLossMatrix");
+
+using namespace ns3;
+using namespace std;
+
+int
+main (int argc, char *argv[])
+{
+  string positionsFile = "positions.txt";       /* The file containing the positions of the nodes. */
+  string wallsFile = "walls.txt";               /* The file containing the walls of the floor plan. */
+  string outputFile = "lossMatrix.bin";         /* The binary loss matrix file. */
+  double frequency = 60.48e9;                   /* The carrier frequency in Hz. */
+  uint32_t threads = 0;                         /* The number of worker threads (0 = hardware threads). */
+
+  /* Command line argument parser setup. */
+  CommandLine cmd;
+  cmd.AddValue ("positions", "The file containing the positions of the nodes", positionsFile);
+  cmd.AddValue ("walls", "The file containing the walls of the floor plan", wallsFile);
+  cmd.AddValue ("output", "The binary loss matrix file", outputFile);
+  cmd.AddValue ("frequency", "The carrier frequency in Hz", frequency);
+  cmd.AddValue ("threads", "The number of worker threads, 0 to use all the hardware threads", threads);
+  cmd.Parse (argc, argv);
+
+  /* Read node positions */
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  ifstream file (positionsFile.c_str ());
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("Positions file " << positionsFile << " not found");
+    }
+  string line;
+  uint32_t numNodes = 0;
+  while (getline (file, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      istringstream iss (line);
+      Vector position;
+      if (!(iss >> position.x >> position.y >> position.z))
+        {
+          NS_FATAL_ERROR ("Malformed line in positions file: " << line);
+        }
+      positionAlloc->Add (position);
+      numNodes++;
+    }
+  file.close ();
+
+  NodeContainer nodes;
+  nodes.Create (numNodes);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  GeometryLossMatrixBuilder builder;
+  builder.SetFrequency (frequency);
+  builder.SetNumberOfThreads (threads);
+  builder.LoadWalls (wallsFile);
+
+  std::cout << "Computing loss matrix for " << numNodes << " nodes and "
+            << builder.GetNWalls () << " walls" << std::endl;
+  auto start = std::chrono::steady_clock::now ();
+  builder.WriteBinaryFile (nodes, outputFile);
+  auto end = std::chrono::steady_clock::now ();
+  std::cout << "Loss matrix written to " << outputFile << " in "
+            << std::chrono::duration<double> (end - start).count () << " s" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef GEOMETRY_LOSS_MATRIX_BUILDER_H
+#define GEOMETRY_LOSS_MATRIX_BUILDER_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/vector.h"
+#include "dense-matrix-propagation-loss-model.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace ns3 {
+
+/********************************************************
+ *            Geometry Loss Matrix Builder
+ ********************************************************/
+
+/**
+ * A wall (or any planar obstacle) modelled as a vertical rectangle standing on
+ * the segment [start, end] of the XY plane between the heights zMin and zMax.
+ */
+struct Wall {
+  Vector start;               //!< First end point of the wall in the XY plane.
+  Vector end;                 //!< Second end point of the wall in the XY plane.
+  double zMin;                //!< Bottom of the wall in meters.
+  double zMax;                //!< Top of the wall in meters.
+  double penetrationLoss;     //!< Penetration loss of the wall material in dB.
+};
+
+/**
+ * Compute the pairwise losses of a set of nodes from a floor plan: free-space
+ * (Friis) loss at the carrier frequency plus the penetration loss of every
+ * wall crossed by the direct path. The walls are stored in a bounding volume
+ * hierarchy so that each ray is tested against O(log W) walls, and the rows of
+ * the matrix are distributed over a pool of worker threads.
+ *
+ * The result can be written directly into a DenseMatrixPropagationLossModel
+ * or into a binary matrix file which can be loaded back with LoadBinaryFile.
+ */
+class GeometryLossMatrixBuilder
+{
+public:
+  GeometryLossMatrixBuilder ();
+
+  /**
+   * \param frequency The carrier frequency in Hz.
+   */
+  void SetFrequency (double frequency);
+  /**
+   * \param threads The number of worker threads. Zero selects the number of hardware threads.
+   */
+  void SetNumberOfThreads (uint32_t threads);
+  /**
+   * Add a wall to the floor plan.
+   * \param wall The wall description.
+   */
+  void AddWall (const Wall &wall);
+  /**
+   * Load walls from a file. Each line describes one wall as
+   * "x1 y1 x2 y2 zMin zMax lossDb"; empty lines and lines starting with '#' are ignored.
+   * \param fileName The path to the floor plan file.
+   */
+  void LoadWalls (std::string fileName);
+  /**
+   * \return The number of walls in the floor plan.
+   */
+  uint32_t GetNWalls (void) const;
+  /**
+   * Compute the loss between every pair of positions.
+   * \param positions The positions of the nodes.
+   * \return Row-major N x N matrix of losses in dB, with zeros on the diagonal.
+   */
+  std::vector<double> Compute (const std::vector<Vector> &positions);
+  /**
+   * Compute the losses between all the nodes and write them into the loss model.
+   * \param nodes The nodes with their mobility models installed.
+   * \param model The loss model to populate.
+   */
+  void Install (NodeContainer nodes, Ptr<DenseMatrixPropagationLossModel> model);
+  /**
+   * Compute the losses between all the nodes and store them in a binary file.
+   * The file starts with the number of nodes N (uint32_t) followed by the
+   * N x N row-major matrix of losses (double).
+   * \param nodes The nodes with their mobility models installed.
+   * \param fileName The path to the binary matrix file.
+   */
+  void WriteBinaryFile (NodeContainer nodes, std::string fileName);
+  /**
+   * Populate a loss model from a binary matrix file generated by WriteBinaryFile.
+   * \param fileName The path to the binary matrix file.
+   * \param nodes The nodes in the same order as the ones used to generate the file.
+   * \param model The loss model to populate.
+   */
+  static void LoadBinaryFile (std::string fileName, NodeContainer nodes, Ptr<DenseMatrixPropagationLossModel> model);
+
+private:
+  /**
+   * Node of the bounding volume hierarchy. Inner nodes reference their two
+   * children, leaves reference a contiguous range of m_wallOrder.
+   */
+  struct BvhNode {
+    double min[3];
+    double max[3];
+    uint32_t left;        //!< Index of the left child, or of the first wall for a leaf.
+    uint32_t right;       //!< Index of the right child, or the number of walls for a leaf.
+    bool leaf;
+  };
+
+  void BuildHierarchy (void);
+  uint32_t BuildNode (uint32_t first, uint32_t last);
+  double CalculatePenetrationLoss (const Vector &a, const Vector &b) const;
+  bool IntersectsBox (const BvhNode &node, const Vector &origin, const Vector &direction) const;
+  bool IntersectsWall (const Wall &wall, const Vector &origin, const Vector &direction) const;
+  double CalculateFriisLoss (double distance) const;
+  std::vector<Vector> GetPositions (NodeContainer nodes) const;
+
+  static const uint32_t LEAF_SIZE = 4;
+
+  double m_lambda;                        //!< Wavelength in meters.
+  uint32_t m_threads;                     //!< Number of worker threads.
+  std::vector<Wall> m_walls;              //!< The walls of the floor plan.
+  std::vector<uint32_t> m_wallOrder;      //!< Wall indices ordered by BVH leaf.
+  std::vector<BvhNode> m_hierarchy;       //!< Flattened BVH, the root is the first node.
+  bool m_hierarchyValid;                  //!< False when walls were added since the last build.
+
+};
+
+const uint32_t GeometryLossMatrixBuilder::LEAF_SIZE;
+
+GeometryLossMatrixBuilder::GeometryLossMatrixBuilder ()
+  : m_lambda (299792458.0 / 60.48e9),
+    m_threads (0),
+    m_hierarchyValid (false)
+{
+}
+
+void
+GeometryLossMatrixBuilder::SetFrequency (double frequency)
+{
+  m_lambda = 299792458.0 / frequency;
+}
+
+void
+GeometryLossMatrixBuilder::SetNumberOfThreads (uint32_t threads)
+{
+  m_threads = threads;
+}
+
+void
+GeometryLossMatrixBuilder::AddWall (const Wall &wall)
+{
+  m_walls.push_back (wall);
+  m_hierarchyValid = false;
+}
+
+void
+GeometryLossMatrixBuilder::LoadWalls (std::string fileName)
+{
+  std::ifstream file;
+  file.open (fileName.c_str (), std::ifstream::in);
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("Floor plan file " << fileName << " not found");
+    }
+  std::string line;
+  while (std::getline (file, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream iss (line);
+      Wall wall;
+      if (!(iss >> wall.start.x >> wall.start.y >> wall.end.x >> wall.end.y
+                >> wall.zMin >> wall.zMax >> wall.penetrationLoss))
+        {
+          NS_FATAL_ERROR ("Malformed line in floor plan file: " << line);
+        }
+      wall.start.z = wall.end.z = 0;
+      AddWall (wall);
+    }
+  file.close ();
+}
+
+uint32_t
+GeometryLossMatrixBuilder::GetNWalls (void) const
+{
+  return m_walls.size ();
+}
+
+std::vector<double>
+GeometryLossMatrixBuilder::Compute (const std::vector<Vector> &positions)
+{
+  if (!m_hierarchyValid)
+    {
+      BuildHierarchy ();
+    }
+
+  const uint32_t nodes = positions.size ();
+  std::vector<double> loss (static_cast<size_t> (nodes) * nodes, 0);
+  uint32_t threads = (m_threads == 0) ? std::max<uint32_t> (1, std::thread::hardware_concurrency ()) : m_threads;
+  threads = std::min (threads, std::max<uint32_t> (1, nodes));
+
+  /* Rows are handed out dynamically since row i only computes the pairs (i, j > i) */
+  std::atomic<uint32_t> nextRow (0);
+  auto worker = [&] ()
+    {
+      uint32_t i;
+      while ((i = nextRow.fetch_add (1)) < nodes)
+        {
+          for (uint32_t j = i + 1; j < nodes; j++)
+            {
+              double value = CalculateFriisLoss (CalculateDistance (positions[i], positions[j]))
+                           + CalculatePenetrationLoss (positions[i], positions[j]);
+              loss[static_cast<size_t> (i) * nodes + j] = value;
+              loss[static_cast<size_t> (j) * nodes + i] = value;
+            }
+        }
+    };
+
+  std::vector<std::thread> pool;
+  for (uint32_t t = 1; t < threads; t++)
+    {
+      pool.push_back (std::thread (worker));
+    }
+  worker ();
+  for (std::vector<std::thread>::iterator it = pool.begin (); it != pool.end (); it++)
+    {
+      it->join ();
+    }
+  return loss;
+}
+
+void
+GeometryLossMatrixBuilder::Install (NodeContainer nodes, Ptr<DenseMatrixPropagationLossModel> model)
+{
+  std::vector<double> loss = Compute (GetPositions (nodes));
+  std::vector<uint32_t> index (nodes.GetN ());
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      index[i] = model->AddReceiver (nodes.Get (i)->GetObject<MobilityModel> ());
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      for (uint32_t j = 0; j < nodes.GetN (); j++)
+        {
+          if (i != j)
+            {
+              model->SetLoss (index[i], index[j], loss[static_cast<size_t> (i) * nodes.GetN () + j]);
+            }
+        }
+    }
+}
+
+void
+GeometryLossMatrixBuilder::WriteBinaryFile (NodeContainer nodes, std::string fileName)
+{
+  std::vector<double> loss = Compute (GetPositions (nodes));
+  std::ofstream file (fileName.c_str (), std::ofstream::out | std::ofstream::binary);
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("Cannot create loss matrix file " << fileName);
+    }
+  uint32_t size = nodes.GetN ();
+  file.write (reinterpret_cast<const char *> (&size), sizeof (size));
+  file.write (reinterpret_cast<const char *> (loss.data ()), loss.size () * sizeof (double));
+  file.close ();
+}
+
+void
+GeometryLossMatrixBuilder::LoadBinaryFile (std::string fileName, NodeContainer nodes,
+                                           Ptr<DenseMatrixPropagationLossModel> model)
+{
+  std::ifstream file (fileName.c_str (), std::ifstream::in | std::ifstream::binary);
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("Loss matrix file " << fileName << " not found");
+    }
+  uint32_t size;
+  file.read (reinterpret_cast<char *> (&size), sizeof (size));
+  NS_ABORT_MSG_IF (size != nodes.GetN (), "Loss matrix file " << fileName << " describes " << size
+                   << " nodes but " << nodes.GetN () << " were given");
+  std::vector<double> row (size);
+  std::vector<uint32_t> index (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      index[i] = model->AddReceiver (nodes.Get (i)->GetObject<MobilityModel> ());
+    }
+  for (uint32_t i = 0; i < size; i++)
+    {
+      file.read (reinterpret_cast<char *> (row.data ()), size * sizeof (double));
+      NS_ABORT_MSG_IF (!file, "Truncated loss matrix file " << fileName);
+      for (uint32_t j = 0; j < size; j++)
+        {
+          if (i != j)
+            {
+              model->SetLoss (index[i], index[j], row[j]);
+            }
+        }
+    }
+  file.close ();
+}
+
+void
+GeometryLossMatrixBuilder::BuildHierarchy (void)
+{
+  m_hierarchy.clear ();
+  m_wallOrder.resize (m_walls.size ());
+  for (uint32_t i = 0; i < m_walls.size (); i++)
+    {
+      m_wallOrder[i] = i;
+    }
+  if (!m_walls.empty ())
+    {
+      m_hierarchy.reserve (2 * m_walls.size ());
+      BuildNode (0, m_walls.size ());
+    }
+  m_hierarchyValid = true;
+}
+
+uint32_t
+GeometryLossMatrixBuilder::BuildNode (uint32_t first, uint32_t last)
+{
+  uint32_t nodeIndex = m_hierarchy.size ();
+  m_hierarchy.push_back (BvhNode ());
+
+  /* Bounding box of the walls in [first, last) */
+  BvhNode node;
+  for (uint8_t k = 0; k < 3; k++)
+    {
+      node.min[k] = std::numeric_limits<double>::max ();
+      node.max[k] = -std::numeric_limits<double>::max ();
+    }
+  for (uint32_t i = first; i < last; i++)
+    {
+      const Wall &wall = m_walls[m_wallOrder[i]];
+      node.min[0] = std::min (node.min[0], std::min (wall.start.x, wall.end.x));
+      node.max[0] = std::max (node.max[0], std::max (wall.start.x, wall.end.x));
+      node.min[1] = std::min (node.min[1], std::min (wall.start.y, wall.end.y));
+      node.max[1] = std::max (node.max[1], std::max (wall.start.y, wall.end.y));
+      node.min[2] = std::min (node.min[2], wall.zMin);
+      node.max[2] = std::max (node.max[2], wall.zMax);
+    }
+
+  if (last - first <= LEAF_SIZE)
+    {
+      node.leaf = true;
+      node.left = first;
+      node.right = last - first;
+    }
+  else
+    {
+      /* Median split of the wall centers along the longest axis of the box */
+      uint8_t axis = 0;
+      for (uint8_t k = 1; k < 3; k++)
+        {
+          if (node.max[k] - node.min[k] > node.max[axis] - node.min[axis])
+            {
+              axis = k;
+            }
+        }
+      auto center = [this, axis] (uint32_t wallIndex)
+        {
+          const Wall &wall = m_walls[wallIndex];
+          switch (axis)
+            {
+            case 0:
+              return wall.start.x + wall.end.x;
+            case 1:
+              return wall.start.y + wall.end.y;
+            default:
+              return wall.zMin + wall.zMax;
+            }
+        };
+      uint32_t middle = first + (last - first) / 2;
+      std::nth_element (m_wallOrder.begin () + first, m_wallOrder.begin () + middle, m_wallOrder.begin () + last,
+                        [&center] (uint32_t a, uint32_t b) { return center (a) < center (b); });
+      node.leaf = false;
+      node.left = BuildNode (first, middle);
+      node.right = BuildNode (middle, last);
+    }
+  m_hierarchy[nodeIndex] = node;
+  return nodeIndex;
+}
+
+double
+GeometryLossMatrixBuilder::CalculatePenetrationLoss (const Vector &a, const Vector &b) const
+{
+  if (m_hierarchy.empty ())
+    {
+      return 0;
+    }
+  Vector direction = b - a;
+  double loss = 0;
+  uint32_t stack[64];
+  uint32_t top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+    {
+      const BvhNode &node = m_hierarchy[stack[--top]];
+      if (!IntersectsBox (node, a, direction))
+        {
+          continue;
+        }
+      if (node.leaf)
+        {
+          for (uint32_t i = node.left; i < node.left + node.right; i++)
+            {
+              const Wall &wall = m_walls[m_wallOrder[i]];
+              if (IntersectsWall (wall, a, direction))
+                {
+                  loss += wall.penetrationLoss;
+                }
+            }
+        }
+      else
+        {
+          stack[top++] = node.left;
+          stack[top++] = node.right;
+        }
+    }
+  return loss;
+}
+
+bool
+GeometryLossMatrixBuilder::IntersectsBox (const BvhNode &node, const Vector &origin, const Vector &direction) const
+{
+  /* Slab test restricted to the segment, i.e. t in [0, 1] */
+  const double o[3] = {origin.x, origin.y, origin.z};
+  const double d[3] = {direction.x, direction.y, direction.z};
+  double tMin = 0;
+  double tMax = 1;
+  for (uint8_t k = 0; k < 3; k++)
+    {
+      if (std::abs (d[k]) < 1e-12)
+        {
+          if ((o[k] < node.min[k]) || (o[k] > node.max[k]))
+            {
+              return false;
+            }
+        }
+      else
+        {
+          double t1 = (node.min[k] - o[k]) / d[k];
+          double t2 = (node.max[k] - o[k]) / d[k];
+          tMin = std::max (tMin, std::min (t1, t2));
+          tMax = std::min (tMax, std::max (t1, t2));
+          if (tMin > tMax)
+            {
+              return false;
+            }
+        }
+    }
+  return true;
+}
+
+bool
+GeometryLossMatrixBuilder::IntersectsWall (const Wall &wall, const Vector &origin, const Vector &direction) const
+{
+  /* Intersect the projection of the path with the wall segment in the XY plane */
+  double sx = wall.end.x - wall.start.x;
+  double sy = wall.end.y - wall.start.y;
+  double denominator = direction.x * sy - direction.y * sx;
+  if (std::abs (denominator) < 1e-12)
+    {
+      /* Path parallel to the wall */
+      return false;
+    }
+  double qx = wall.start.x - origin.x;
+  double qy = wall.start.y - origin.y;
+  double t = (qx * sy - qy * sx) / denominator;            /* Position along the path */
+  double u = (qx * direction.y - qy * direction.x) / denominator;  /* Position along the wall */
+  /* Nodes standing exactly on a wall are not considered to be behind it */
+  if ((t <= 1e-9) || (t >= 1 - 1e-9) || (u < 0) || (u > 1))
+    {
+      return false;
+    }
+  double z = origin.z + t * direction.z;
+  return (z >= wall.zMin) && (z <= wall.zMax);
+}
+
+double
+GeometryLossMatrixBuilder::CalculateFriisLoss (double distance) const
+{
+  if (distance <= 0)
+    {
+      return 0;
+    }
+  return 20 * std::log10 (4 * M_PI * distance / m_lambda);
+}
+
+std::vector<Vector>
+GeometryLossMatrixBuilder::GetPositions (NodeContainer nodes) const
+{
+  /* Positions are read on the main thread, mobility models are not thread-safe */
+  std::vector<Vector> positions;
+  positions.reserve (nodes.GetN ());
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel> ();
+      NS_ABORT_MSG_IF (mobility == 0, "Node " << (*i)->GetId () << " has no mobility model");
+      positions.push_back (mobility->GetPosition ());
+    }
+  return positions;
+}
+
+} // namespace ns3
+
+#endif // GEOMETRY_LOSS_MATRIX_BUILDER_H
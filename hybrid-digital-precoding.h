@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef HYBRID_DIGITAL_PRECODING_H
+#define HYBRID_DIGITAL_PRECODING_H
+
+#include "ns3/core-module.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Small Complex Matrix Kernels
+ ********************************************************/
+
+#define SMALL_MATRIX_MAX_SIZE 4   //!< Maximum number of antenna arrays per EDMG device.
+
+typedef std::complex<double> SmallComplex;
+
+/**
+ * Fixed-size complex matrix used for the per subcarrier group baseband
+ * processing. The effective channel after analog beamforming is at most 4x4
+ * (one row per Rx array, one column per Tx array), so the storage lives on the
+ * stack and the kernels below avoid any heap allocation.
+ */
+struct SmallMatrix {
+  uint8_t rows;                                                         //!< Number of rows.
+  uint8_t cols;                                                         //!< Number of columns.
+  SmallComplex m[SMALL_MATRIX_MAX_SIZE][SMALL_MATRIX_MAX_SIZE];         //!< Matrix entries.
+};
+
+/**
+ * Compute the Gram matrix G = H^H H.
+ * \param h The input matrix.
+ * \return The cols x cols Hermitian Gram matrix.
+ */
+SmallMatrix
+SmallMatrixGram (const SmallMatrix &h)
+{
+  SmallMatrix g;
+  g.rows = h.cols;
+  g.cols = h.cols;
+  for (uint8_t i = 0; i < h.cols; i++)
+    {
+      for (uint8_t j = i; j < h.cols; j++)
+        {
+          SmallComplex sum = 0;
+          for (uint8_t k = 0; k < h.rows; k++)
+            {
+              sum += std::conj (h.m[k][i]) * h.m[k][j];
+            }
+          g.m[i][j] = sum;
+          g.m[j][i] = std::conj (sum);
+        }
+    }
+  return g;
+}
+
+/**
+ * Compute the eigenvalues of a Hermitian matrix with the cyclic Jacobi method.
+ * Each off-diagonal entry is first made real by a diagonal unitary similarity,
+ * then annihilated by a real Givens rotation.
+ * \param a The Hermitian matrix, passed by value as it is reduced in place.
+ * \param eigenvalues The output eigenvalues sorted in decreasing order.
+ */
+void
+SmallMatrixHermitianEigenvalues (SmallMatrix a, double *eigenvalues)
+{
+  const uint8_t n = a.rows;
+  for (uint8_t sweep = 0; sweep < 16; sweep++)
+    {
+      double off = 0;
+      double diag = 0;
+      for (uint8_t p = 0; p < n; p++)
+        {
+          diag += std::norm (a.m[p][p]);
+          for (uint8_t q = p + 1; q < n; q++)
+            {
+              off += std::norm (a.m[p][q]);
+            }
+        }
+      if (off <= 1e-24 * diag)
+        {
+          break;
+        }
+      for (uint8_t p = 0; p < n; p++)
+        {
+          for (uint8_t q = p + 1; q < n; q++)
+            {
+              double magnitude = std::abs (a.m[p][q]);
+              if (magnitude < 1e-300)
+                {
+                  continue;
+                }
+              /* Make a[p][q] real and positive */
+              SmallComplex phase = a.m[p][q] / magnitude;
+              for (uint8_t k = 0; k < n; k++)
+                {
+                  a.m[q][k] *= phase;
+                  a.m[k][q] *= std::conj (phase);
+                }
+              /* Real Jacobi rotation */
+              double theta = (a.m[q][q].real () - a.m[p][p].real ()) / (2 * magnitude);
+              double t = ((theta >= 0) ? 1.0 : -1.0) / (std::abs (theta) + std::sqrt (theta * theta + 1));
+              double c = 1 / std::sqrt (t * t + 1);
+              double s = t * c;
+              for (uint8_t k = 0; k < n; k++)
+                {
+                  SmallComplex kp = a.m[k][p];
+                  SmallComplex kq = a.m[k][q];
+                  a.m[k][p] = c * kp - s * kq;
+                  a.m[k][q] = s * kp + c * kq;
+                }
+              for (uint8_t k = 0; k < n; k++)
+                {
+                  SmallComplex pk = a.m[p][k];
+                  SmallComplex qk = a.m[q][k];
+                  a.m[p][k] = c * pk - s * qk;
+                  a.m[q][k] = s * pk + c * qk;
+                }
+            }
+        }
+    }
+  for (uint8_t i = 0; i < n; i++)
+    {
+      eigenvalues[i] = std::max (a.m[i][i].real (), 0.0);
+    }
+  std::sort (eigenvalues, eigenvalues + n);
+  std::reverse (eigenvalues, eigenvalues + n);
+}
+
+/**
+ * Invert a square matrix with Gauss-Jordan elimination and partial pivoting.
+ * \param a The matrix to invert.
+ * \param inverse The output inverse.
+ * \return False if the matrix is singular.
+ */
+bool
+SmallMatrixInverse (SmallMatrix a, SmallMatrix &inverse)
+{
+  const uint8_t n = a.rows;
+  inverse.rows = n;
+  inverse.cols = n;
+  for (uint8_t i = 0; i < n; i++)
+    {
+      for (uint8_t j = 0; j < n; j++)
+        {
+          inverse.m[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+  for (uint8_t col = 0; col < n; col++)
+    {
+      uint8_t pivot = col;
+      for (uint8_t row = col + 1; row < n; row++)
+        {
+          if (std::abs (a.m[row][col]) > std::abs (a.m[pivot][col]))
+            {
+              pivot = row;
+            }
+        }
+      if (std::abs (a.m[pivot][col]) < 1e-12)
+        {
+          return false;
+        }
+      for (uint8_t k = 0; k < n; k++)
+        {
+          std::swap (a.m[col][k], a.m[pivot][k]);
+          std::swap (inverse.m[col][k], inverse.m[pivot][k]);
+        }
+      SmallComplex scale = 1.0 / a.m[col][col];
+      for (uint8_t k = 0; k < n; k++)
+        {
+          a.m[col][k] *= scale;
+          inverse.m[col][k] *= scale;
+        }
+      for (uint8_t row = 0; row < n; row++)
+        {
+          if (row != col)
+            {
+              SmallComplex factor = a.m[row][col];
+              for (uint8_t k = 0; k < n; k++)
+                {
+                  a.m[row][k] -= factor * a.m[col][k];
+                  inverse.m[row][k] -= factor * inverse.m[col][k];
+                }
+            }
+        }
+    }
+  return true;
+}
+
+/********************************************************
+ *              Hybrid Digital Precoding
+ ********************************************************/
+
+/**
+ * Baseband processing applied on top of the analog beams.
+ */
+enum DigitalPrecoder {
+  DIGITAL_PRECODER_NONE = 0,    //!< Analog beamforming only, residual inter-stream interference.
+  DIGITAL_PRECODER_SVD,         //!< SVD precoder/combiner, parallel interference-free streams.
+  DIGITAL_PRECODER_ZF,          //!< Zero-forcing combiner.
+};
+
+/**
+ * Outcome of the link adaptation of one spatial stream.
+ */
+struct StreamRate {
+  double snr;                   //!< Effective SINR of the stream (linear).
+  uint8_t mcs;                  //!< Selected EDMG SC MCS (0 if the stream is not usable).
+  double rate;                  //!< PHY rate of the stream in Mbps per 2.16 GHz channel.
+};
+
+typedef std::vector<StreamRate> StreamRateList;
+
+/**
+ * EDMG SC MCS table: PHY rate (normal GI, one 2.16 GHz channel) and the
+ * approximate AWGN SNR required for 1% PER.
+ */
+const uint8_t EDMG_SC_NUM_MCS = 21;
+const double EDMG_SC_MCS_RATE[EDMG_SC_NUM_MCS] = {
+  385, 770, 962.5, 1155, 1251.25, 1540, 1925, 2310, 2502.5, 2695, 3080,
+  3850, 4620, 5005, 5390, 5775, 6160, 6930, 7700, 8085, 8662.5
+};
+const double EDMG_SC_MCS_SNR[EDMG_SC_NUM_MCS] = {
+  -1.0, 1.5, 2.5, 3.5, 4.5, 5.5, 7.0, 8.5, 9.5, 10.5, 11.5,
+  13.5, 15.5, 16.5, 17.5, 19.0, 20.0, 21.5, 23.0, 24.0, 25.5
+};
+
+/**
+ * Select the highest EDMG SC MCS supported by a given SINR.
+ * \param snr The SINR (linear).
+ * \return The selected stream rate.
+ */
+StreamRate
+SelectStreamMcs (double snr)
+{
+  StreamRate stream;
+  stream.snr = snr;
+  stream.mcs = 0;
+  stream.rate = 0;
+  double snrDb = 10 * std::log10 (std::max (snr, 1e-30));
+  for (uint8_t i = 0; i < EDMG_SC_NUM_MCS; i++)
+    {
+      if (snrDb >= EDMG_SC_MCS_SNR[i])
+        {
+          stream.mcs = i + 1;
+          stream.rate = EDMG_SC_MCS_RATE[i];
+        }
+    }
+  return stream;
+}
+
+/**
+ * Evaluate digital baseband precoding on top of the SU-MIMO analog beams.
+ *
+ * The MIMO phase of the SU-MIMO BFT reports, for the selected analog
+ * configuration, the SNR of every Tx/Rx array pair. This gives the magnitude of
+ * the effective channel after analog beamforming but not its phase, so the
+ * channel is synthetic: each entry is given a residual delay drawn within
+ * DelaySpread and a random phase. The gains of SVD and ZF are therefore those
+ * of this random matrix with the measured magnitudes, not those of the Q-D
+ * channel, whose rays and AWVs live in the wifi module. The channel is built
+ * for every subcarrier group of the SC-FDE receiver, the precoder is computed
+ * per group, and the per-stream SINR is averaged over the groups
+ * (capacity-equivalent mean) before MCS selection.
+ */
+class HybridDigitalPrecoding : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  HybridDigitalPrecoding ();
+  virtual ~HybridDigitalPrecoding ();
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   * \param stream First stream index to use.
+   * \return The number of stream indices assigned by this model.
+   */
+  int64_t AssignStreams (int64_t stream);
+  /**
+   * Set a synthetic effective channel after analog beamforming: the measured
+   * magnitudes with a random phase and residual delay per array pair.
+   * \param snr The SNR (linear) of each array pair, indexed [rxArray][txArray].
+   */
+  void SetSyntheticChannel (const std::vector<std::vector<double> > &snr);
+  /**
+   * Compute the per-stream SINR and MCS for a given precoder.
+   * \param precoder The digital baseband processing.
+   * \return The per-stream rates.
+   */
+  StreamRateList Evaluate (DigitalPrecoder precoder);
+  /**
+   * \return The wall-clock time spent in the last Evaluate call per subcarrier group.
+   */
+  Time GetComputeTimePerGroup (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Build the effective channel of a subcarrier group.
+   * \param group The subcarrier group index.
+   * \return The effective channel matrix.
+   */
+  SmallMatrix GetGroupChannel (uint32_t group) const;
+
+  uint32_t m_groups;                            //!< Number of subcarrier groups.
+  Time m_delaySpread;                           //!< Maximum residual delay of an array pair.
+  Ptr<UniformRandomVariable> m_random;          //!< Random variable for residual delays and phases.
+  std::vector<std::vector<double> > m_snr;      //!< Per array pair SNR.
+  std::vector<std::vector<double> > m_delay;    //!< Per array pair residual delay in seconds.
+  std::vector<std::vector<double> > m_phase;    //!< Per array pair phase in radians.
+  Time m_computeTime;                           //!< Compute time per group of the last evaluation.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (HybridDigitalPrecoding);
+
+TypeId
+HybridDigitalPrecoding::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HybridDigitalPrecoding")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<HybridDigitalPrecoding> ()
+    .AddAttribute ("SubcarrierGroups", "The number of subcarrier groups over which the precoder is computed.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&HybridDigitalPrecoding::m_groups),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DelaySpread", "The maximum residual delay of the effective channel of an array pair.",
+                   TimeValue (NanoSeconds (5)),
+                   MakeTimeAccessor (&HybridDigitalPrecoding::m_delaySpread),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+HybridDigitalPrecoding::HybridDigitalPrecoding ()
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+HybridDigitalPrecoding::~HybridDigitalPrecoding ()
+{
+}
+
+void
+HybridDigitalPrecoding::DoDispose (void)
+{
+  m_random = 0;
+  Object::DoDispose ();
+}
+
+int64_t
+HybridDigitalPrecoding::AssignStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  return 1;
+}
+
+void
+HybridDigitalPrecoding::SetSyntheticChannel (const std::vector<std::vector<double> > &snr)
+{
+  NS_ABORT_MSG_IF (snr.empty () || (snr.size () > SMALL_MATRIX_MAX_SIZE)
+                   || (snr.front ().size () > SMALL_MATRIX_MAX_SIZE), "Unsupported number of antenna arrays");
+  m_snr = snr;
+  m_delay.assign (snr.size (), std::vector<double> (snr.front ().size ()));
+  m_phase.assign (snr.size (), std::vector<double> (snr.front ().size ()));
+  for (uint8_t i = 0; i < snr.size (); i++)
+    {
+      for (uint8_t j = 0; j < snr.front ().size (); j++)
+        {
+          m_delay[i][j] = m_random->GetValue (0, m_delaySpread.GetSeconds ());
+          m_phase[i][j] = m_random->GetValue (0, 2 * M_PI);
+        }
+    }
+}
+
+SmallMatrix
+HybridDigitalPrecoding::GetGroupChannel (uint32_t group) const
+{
+  /* Center frequency of the group relative to the carrier, SC chip rate of 1.76 GHz */
+  double frequency = ((group + 0.5) / m_groups - 0.5) * 1.76e9;
+  SmallMatrix h;
+  h.rows = m_snr.size ();
+  h.cols = m_snr.front ().size ();
+  for (uint8_t i = 0; i < h.rows; i++)
+    {
+      for (uint8_t j = 0; j < h.cols; j++)
+        {
+          h.m[i][j] = std::polar (std::sqrt (m_snr[i][j]), m_phase[i][j] - 2 * M_PI * frequency * m_delay[i][j]);
+        }
+    }
+  return h;
+}
+
+StreamRateList
+HybridDigitalPrecoding::Evaluate (DigitalPrecoder precoder)
+{
+  NS_ABORT_MSG_IF (m_snr.empty (), "The synthetic channel has not been set");
+  uint8_t rows = m_snr.size ();
+  uint8_t cols = m_snr.front ().size ();
+  uint8_t streams = std::min (rows, cols);
+  std::vector<double> capacity (streams, 0);
+  double sinr[SMALL_MATRIX_MAX_SIZE];
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t group = 0; group < m_groups; group++)
+    {
+      SmallMatrix h = GetGroupChannel (group);
+      if (precoder == DIGITAL_PRECODER_NONE)
+        {
+          /* Stream i is sent on Tx array i and received on Rx array i */
+          for (uint8_t i = 0; i < streams; i++)
+            {
+              double interference = 0;
+              for (uint8_t j = 0; j < cols; j++)
+                {
+                  if (j != i)
+                    {
+                      interference += std::norm (h.m[i][j]);
+                    }
+                }
+              sinr[i] = std::norm (h.m[i][i]) / (1 + interference);
+            }
+        }
+      else if (precoder == DIGITAL_PRECODER_SVD)
+        {
+          /* The squared singular values of H are the eigenvalues of H^H H */
+          SmallMatrixHermitianEigenvalues (SmallMatrixGram (h), sinr);
+        }
+      else
+        {
+          SmallMatrix inverse;
+          if (SmallMatrixInverse (SmallMatrixGram (h), inverse))
+            {
+              for (uint8_t i = 0; i < streams; i++)
+                {
+                  sinr[i] = 1 / std::max (inverse.m[i][i].real (), 1e-30);
+                }
+            }
+          else
+            {
+              std::fill (sinr, sinr + streams, 0);
+            }
+        }
+      for (uint8_t i = 0; i < streams; i++)
+        {
+          capacity[i] += std::log2 (1 + sinr[i]);
+        }
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  m_computeTime = Seconds (elapsed.count () / m_groups);
+
+  StreamRateList list;
+  for (uint8_t i = 0; i < streams; i++)
+    {
+      list.push_back (SelectStreamMcs (std::pow (2, capacity[i] / m_groups) - 1));
+    }
+  return list;
+}
+
+Time
+HybridDigitalPrecoding::GetComputeTimePerGroup (void) const
+{
+  return m_computeTime;
+}
+
+} // namespace ns3
+
+#endif // HYBRID_DIGITAL_PRECODING_H
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef MULTI_FIDELITY_SWEEP_H
+#define MULTI_FIDELITY_SWEEP_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Analytic DMG MAC Throughput
+ ********************************************************/
+
+/* Approximate IEEE 802.11ad timing, enough to rank design points */
+#define DMG_SIFS                    3.0     //!< SIFS in microseconds.
+#define DMG_SLOT                    5.0     //!< Slot time in microseconds.
+#define DMG_CW_MIN                  15      //!< Minimum contention window.
+#define DMG_SC_PREAMBLE_HEADER      2.473   //!< SC PHY STF, CEF and header in microseconds.
+#define DMG_CTRL_PREAMBLE_HEADER    4.291   //!< Control PHY STF, CEF and header in microseconds.
+#define DMG_CTRL_RATE               27.5    //!< Control PHY rate in Mbps.
+#define DMG_PPDU_MAX_TIME           2000.0  //!< aPPDUMaxTime in microseconds.
+
+/**
+ * Estimate the saturation throughput of a single DMG link in a CBAP using an
+ * analytic model of one EDCA transmission cycle: AIFS, mean backoff, the data
+ * PPDU, SIFS and the (Block) Ack sent with the Control PHY. The link is assumed
+ * error free and collision free.
+ * \param mode The data mode.
+ * \param payloadSize The application payload size in bytes.
+ * \param msduAggSize The maximum A-MSDU size in bytes, zero disables A-MSDU.
+ * \param mpduAggSize The maximum A-MPDU size in bytes, zero disables A-MPDU.
+ * \return The application throughput in Mbps.
+ */
+double
+AnalyticDmgThroughput (WifiMode mode, uint32_t payloadSize, uint32_t msduAggSize, uint32_t mpduAggSize)
+{
+  /* UDP, IP and LLC/SNAP headers */
+  uint32_t msduSize = payloadSize + 8 + 20 + 8;
+  /* A-MSDU subframes are padded to 4 bytes, except the last one which we do not bother with */
+  uint32_t msdusPerMpdu = 1;
+  uint32_t mpduBody = msduSize;
+  if (msduAggSize > 0)
+    {
+      uint32_t subframe = ((14 + msduSize + 3) / 4) * 4;
+      msdusPerMpdu = std::max<uint32_t> (1, msduAggSize / subframe);
+      mpduBody = msdusPerMpdu * subframe;
+    }
+  /* QoS Data header and FCS */
+  uint32_t mpduSize = mpduBody + 26 + 4;
+  double phyRate = mode.GetPhyRate () / 1e6;
+  uint32_t mpdusPerPpdu = 1;
+  uint32_t psduSize = mpduSize;
+  if (mpduAggSize > 0)
+    {
+      uint32_t subframe = ((4 + mpduSize + 3) / 4) * 4;
+      uint32_t maxInTime = (DMG_PPDU_MAX_TIME - DMG_SC_PREAMBLE_HEADER) * phyRate / 8 / subframe;
+      mpdusPerPpdu = std::max<uint32_t> (1, std::min (mpduAggSize / subframe, maxInTime));
+      psduSize = mpdusPerPpdu * subframe;
+    }
+
+  double aifs = DMG_SIFS + 2 * DMG_SLOT;
+  double backoff = DMG_SLOT * DMG_CW_MIN / 2.0;
+  double data = DMG_SC_PREAMBLE_HEADER + psduSize * 8 / phyRate;
+  /* Compressed BlockAck is 32 bytes, Ack is 14 bytes */
+  double ack = DMG_CTRL_PREAMBLE_HEADER + ((mpduAggSize > 0) ? 32 : 14) * 8 / DMG_CTRL_RATE;
+  double cycle = aifs + backoff + data + DMG_SIFS + ack;
+  return mpdusPerPpdu * msdusPerMpdu * payloadSize * 8 / cycle;
+}
+
+/********************************************************
+ *              Multi-Fidelity Design-Space Sweep
+ ********************************************************/
+
+/**
+ * Bookkeeping of a multi-fidelity sweep. Every design point is first evaluated
+ * with a cheap abstraction (an analytic model or a short simulation). The points
+ * are ranked on this low fidelity metric, and only the top fraction, plus the
+ * points whose metric lies within a margin of the cut-off value (the decision
+ * boundary), are evaluated with the full simulation.
+ */
+class MultiFidelitySweep
+{
+public:
+  MultiFidelitySweep ();
+
+  /**
+   * Add a design point.
+   * \param name The name of the design point.
+   * \return The index of the design point.
+   */
+  uint32_t AddPoint (std::string name);
+  /**
+   * \return The number of design points.
+   */
+  uint32_t GetNPoints (void) const;
+  /**
+   * \param index The index of the design point.
+   * \return The name of the design point.
+   */
+  std::string GetName (uint32_t index) const;
+  /**
+   * Record the low fidelity metric of a design point, the higher the better.
+   * \param index The index of the design point.
+   * \param metric The metric.
+   * \param wallTime The wall clock time spent to evaluate it in seconds.
+   */
+  void SetLowFidelity (uint32_t index, double metric, double wallTime);
+  /**
+   * Record the full fidelity metric of a design point.
+   * \param index The index of the design point.
+   * \param metric The metric.
+   * \param wallTime The wall clock time spent to evaluate it in seconds.
+   */
+  void SetHighFidelity (uint32_t index, double metric, double wallTime);
+  /**
+   * Rank the design points and select the ones to evaluate with the full simulation.
+   * \param topFraction The fraction of the best points to select.
+   * \param boundaryMargin The relative margin below the cut-off value within which points are also selected.
+   * \return The indices of the selected design points, best first.
+   */
+  std::vector<uint32_t> Select (double topFraction, double boundaryMargin);
+  /**
+   * Print the two fidelities side by side.
+   * \param os The output stream.
+   * \param csv Whether to print in CSV format.
+   */
+  void Print (std::ostream &os, bool csv) const;
+
+private:
+  struct DesignPoint {
+    std::string name;                   //!< Name of the design point.
+    double lowFidelity;                 //!< Low fidelity metric.
+    double highFidelity;                //!< Full fidelity metric.
+    bool evaluated;                     //!< Whether the full simulation has been run.
+    uint32_t rank;                      //!< Rank on the low fidelity metric.
+  };
+
+  std::vector<DesignPoint> m_points;    //!< List of design points.
+  std::vector<uint32_t> m_order;        //!< Indices of the points, best low fidelity metric first.
+  double m_lowWallTime;                 //!< Total wall clock time of the low fidelity pass.
+  double m_highWallTime;                //!< Total wall clock time of the full fidelity pass.
+
+};
+
+MultiFidelitySweep::MultiFidelitySweep ()
+  : m_lowWallTime (0),
+    m_highWallTime (0)
+{
+}
+
+uint32_t
+MultiFidelitySweep::AddPoint (std::string name)
+{
+  DesignPoint point;
+  point.name = name;
+  point.lowFidelity = 0;
+  point.highFidelity = 0;
+  point.evaluated = false;
+  point.rank = 0;
+  m_points.push_back (point);
+  return m_points.size () - 1;
+}
+
+uint32_t
+MultiFidelitySweep::GetNPoints (void) const
+{
+  return m_points.size ();
+}
+
+std::string
+MultiFidelitySweep::GetName (uint32_t index) const
+{
+  return m_points.at (index).name;
+}
+
+void
+MultiFidelitySweep::SetLowFidelity (uint32_t index, double metric, double wallTime)
+{
+  m_points.at (index).lowFidelity = metric;
+  m_lowWallTime += wallTime;
+}
+
+void
+MultiFidelitySweep::SetHighFidelity (uint32_t index, double metric, double wallTime)
+{
+  m_points.at (index).highFidelity = metric;
+  m_points.at (index).evaluated = true;
+  m_highWallTime += wallTime;
+}
+
+std::vector<uint32_t>
+MultiFidelitySweep::Select (double topFraction, double boundaryMargin)
+{
+  NS_ABORT_MSG_IF (m_points.empty (), "There are no design points");
+  NS_ABORT_MSG_IF ((topFraction <= 0) || (topFraction > 1), "The top fraction must be in (0,1]");
+  std::vector<std::pair<double, uint32_t> > ranked;
+  for (uint32_t i = 0; i < m_points.size (); i++)
+    {
+      ranked.push_back (std::make_pair (-m_points[i].lowFidelity, i));
+    }
+  /* Ties keep the order of the sweep */
+  std::sort (ranked.begin (), ranked.end ());
+  m_order.clear ();
+  for (uint32_t i = 0; i < ranked.size (); i++)
+    {
+      m_order.push_back (ranked[i].second);
+      m_points[ranked[i].second].rank = i + 1;
+    }
+
+  uint32_t top = std::ceil (topFraction * m_points.size ());
+  double cutoff = m_points[m_order[top - 1]].lowFidelity;
+  std::vector<uint32_t> selected (m_order.begin (), m_order.begin () + top);
+  for (uint32_t i = top; i < m_order.size (); i++)
+    {
+      if (m_points[m_order[i]].lowFidelity >= cutoff * (1 - boundaryMargin))
+        {
+          selected.push_back (m_order[i]);
+        }
+    }
+  return selected;
+}
+
+void
+MultiFidelitySweep::Print (std::ostream &os, bool csv) const
+{
+  if (csv)
+    {
+      os << "RANK,POINT,LOW_FIDELITY,FULL_FIDELITY" << std::endl;
+    }
+  else
+    {
+      os << std::left << std::setw (8) << "Rank"
+         << std::left << std::setw (32) << "Design Point"
+         << std::left << std::setw (12) << "Low"
+         << std::left << std::setw (12) << "Full"
+         << std::left << std::setw (12) << "Error [%]" << std::endl;
+    }
+  for (std::vector<uint32_t>::const_iterator it = m_order.begin (); it != m_order.end (); it++)
+    {
+      const DesignPoint &point = m_points[*it];
+      std::ostringstream full, error;
+      if (point.evaluated)
+        {
+          full << point.highFidelity;
+          if (point.highFidelity > 0)
+            {
+              error << std::fixed << std::setprecision (1)
+                    << 100 * (point.lowFidelity - point.highFidelity) / point.highFidelity;
+            }
+          else
+            {
+              error << "-";
+            }
+        }
+      else
+        {
+          full << "-";
+          error << "-";
+        }
+      if (csv)
+        {
+          os << point.rank << "," << point.name << "," << point.lowFidelity << "," << full.str () << std::endl;
+        }
+      else
+        {
+          os << std::left << std::setw (8) << point.rank
+             << std::left << std::setw (32) << point.name
+             << std::left << std::setw (12) << point.lowFidelity
+             << std::left << std::setw (12) << full.str ()
+             << std::left << std::setw (12) << error.str () << std::endl;
+        }
+    }
+  if (!csv)
+    {
+      uint32_t evaluated = 0;
+      for (std::vector<DesignPoint>::const_iterator it = m_points.begin (); it != m_points.end (); it++)
+        {
+          evaluated += it->evaluated;
+        }
+      os << "Design points = " << m_points.size () << ", fully simulated = " << evaluated << std::endl;
+      os << "Low fidelity wall clock time = " << m_lowWallTime << " s" << std::endl;
+      os << "Full fidelity wall clock time = " << m_highWallTime << " s" << std::endl;
+    }
+}
+
+} // namespace ns3
+
+#endif // MULTI_FIDELITY_SWEEP_H
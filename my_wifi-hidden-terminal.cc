@@ -23,9 +23,10 @@
  *
  * This example illustrates the use of
  *  - Wifi in ad-hoc mode
- *  - Matrix propagation loss model
+ *  - Dense matrix propagation loss model
  *  - Use of OnOffApplication to generate CBR stream
  *  - IP flow monitor
+ *  - Analytic CSMA/CA saturation model, validated against the simulation
  */
 
 #include "ns3/command-line.h"
@@ -44,6 +45,9 @@
 #include "ns3/on-off-helper.h"
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/ipv4-flow-classifier.h"
+#include "dense-matrix-propagation-loss-model.h"
+#include "csma-saturation-model.h"
+#include <chrono>
 
 using namespace ns3;
 
@@ -64,8 +68,8 @@ void experiment (bool enableCtsRts, std::string wifiManager)
       nodes.Get (i)->AggregateObject (CreateObject<ConstantPositionMobilityModel> ());
     }
 
-  // 3. Create propagation loss matrix
-  Ptr<MatrixPropagationLossModel> lossModel = CreateObject<MatrixPropagationLossModel> ();
+  // 3. Create propagation loss matrix, SetLoss registers the nodes with the model
+  Ptr<DenseMatrixPropagationLossModel> lossModel = CreateObject<DenseMatrixPropagationLossModel> ();
   lossModel->SetDefaultLoss (200); // set default loss to 200 dB (no link)
   lossModel->SetLoss (nodes.Get (0)->GetObject<MobilityModel> (), nodes.Get (1)->GetObject<MobilityModel> (), 50); // set symmetric loss 0 <-> 1 to 50 dB
   lossModel->SetLoss (nodes.Get (2)->GetObject<MobilityModel> (), nodes.Get (1)->GetObject<MobilityModel> (), 50); // set symmetric loss 2 <-> 1 to 50 dB
@@ -140,15 +144,24 @@ void experiment (bool enableCtsRts, std::string wifiManager)
   echoClientHelper.SetAttribute ("StartTime", TimeValue (Seconds (0.006)));
   pingApps.Add (echoClientHelper.Install (nodes.Get (2)));
 
-  // 8. Install FlowMonitor on all nodes
+  // 8. Predict the throughput of both flows with the analytic model
+  std::chrono::steady_clock::time_point modelStart = std::chrono::steady_clock::now ();
+  Ptr<CsmaSaturationModel> model = CreateObject<CsmaSaturationModel> ();
+  model->Setup (lossModel, devices);
+  model->AddFlow (0, 1, 1400, 3000000);
+  model->AddFlow (2, 1, 1400, 3001100);
+  std::vector<double> prediction = model->Solve ();
+  std::chrono::duration<double, std::milli> modelTime = std::chrono::steady_clock::now () - modelStart;
+
+  // 9. Install FlowMonitor on all nodes
   FlowMonitorHelper flowmon;
   Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
 
-  // 9. Run simulation for 10 seconds
+  // 10. Run simulation for 10 seconds
   Simulator::Stop (Seconds (10));
   Simulator::Run ();
 
-  // 10. Print per flow statistics
+  // 11. Print per flow statistics
   monitor->CheckForLostPackets ();
   Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
   FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
@@ -170,10 +183,13 @@ void experiment (bool enableCtsRts, std::string wifiManager)
           std::cout << "  Rx Packets: " << i->second.rxPackets << "\n";
           std::cout << "  Rx Bytes:   " << i->second.rxBytes << "\n";
           std::cout << "  Throughput: " << i->second.rxBytes * 8.0 / 9.0 / 1000 / 1000  << " Mbps\n";
+          // flow 1 is sent by node 0 and flow 2 by node 2, in the order they were given to the model
+          std::cout << "  Model:      " << prediction[i->first - 3] << " Mbps\n";
         }
     }
+  std::cout << "Model solved in " << modelTime.count () << " ms (" << model->GetNIterations () << " iterations)\n";
 
-  // 11. Cleanup
+  // 12. Cleanup
   Simulator::Destroy ();
 }
 
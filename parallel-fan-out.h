@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef PARALLEL_FAN_OUT_H
+#define PARALLEL_FAN_OUT_H
+
+#include "ns3/assert.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *               Parallel Receiver Fan-Out
+ ********************************************************/
+
+/**
+ * Persistent pool of worker threads used to compute independent per-receiver
+ * quantities (e.g. the beamformed received PSD of each PHY) inside a single
+ * simulator event. Run blocks until all the jobs have completed, and job i
+ * must only write to the slot of receiver i. The caller then schedules the
+ * receptions sequentially in receiver order, so the simulation results do not
+ * depend on the number of threads.
+ *
+ * Jobs run outside of the simulator thread: they must not schedule events,
+ * draw random numbers, fire traces or modify shared objects.
+ */
+class ParallelFanOut
+{
+public:
+  /**
+   * \param threads The number of threads including the caller. Zero selects the number of hardware threads.
+   * \param threshold The minimum number of jobs for which the work is distributed over the pool.
+   */
+  ParallelFanOut (uint32_t threads = 0, uint32_t threshold = 8);
+  ~ParallelFanOut ();
+
+  /**
+   * Execute job (i) for i in [0, jobs). Below the threshold, the jobs run
+   * sequentially in the calling thread.
+   * \param jobs The number of jobs.
+   * \param job The job to execute.
+   */
+  void Run (uint32_t jobs, const std::function<void (uint32_t)> &job);
+  /**
+   * \return The number of threads, including the caller.
+   */
+  uint32_t GetNThreads (void) const;
+
+private:
+  void WorkerLoop (void);
+  void Work (void);
+
+  uint32_t m_threshold;                               //!< Minimum number of jobs to use the pool.
+  std::vector<std::thread> m_workers;                 //!< Worker threads.
+  std::mutex m_mutex;                                 //!< Protect the fields below.
+  std::condition_variable m_start;                    //!< Signal a new batch of jobs to the workers.
+  std::condition_variable m_done;                     //!< Signal the completion of a batch to the caller.
+  uint64_t m_generation;                              //!< Batch counter.
+  uint32_t m_pending;                                 //!< Number of workers still busy with the current batch.
+  bool m_stop;                                        //!< Flag to terminate the workers.
+  const std::function<void (uint32_t)> *m_job;        //!< The job of the current batch.
+  uint32_t m_jobs;                                    //!< The number of jobs of the current batch.
+  std::atomic<uint32_t> m_next;                       //!< The next job to execute.
+
+};
+
+ParallelFanOut::ParallelFanOut (uint32_t threads, uint32_t threshold)
+  : m_threshold (threshold),
+    m_generation (0),
+    m_pending (0),
+    m_stop (false),
+    m_job (0),
+    m_jobs (0),
+    m_next (0)
+{
+  if (threads == 0)
+    {
+      threads = std::max<uint32_t> (1, std::thread::hardware_concurrency ());
+    }
+  for (uint32_t i = 1; i < threads; i++)
+    {
+      m_workers.push_back (std::thread (&ParallelFanOut::WorkerLoop, this));
+    }
+}
+
+ParallelFanOut::~ParallelFanOut ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_start.notify_all ();
+  for (std::vector<std::thread>::iterator it = m_workers.begin (); it != m_workers.end (); it++)
+    {
+      it->join ();
+    }
+}
+
+void
+ParallelFanOut::Run (uint32_t jobs, const std::function<void (uint32_t)> &job)
+{
+  if (m_workers.empty () || (jobs < m_threshold))
+    {
+      for (uint32_t i = 0; i < jobs; i++)
+        {
+          job (i);
+        }
+      return;
+    }
+
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    NS_ASSERT_MSG (m_job == 0, "ParallelFanOut::Run is not reentrant");
+    m_job = &job;
+    m_jobs = jobs;
+    m_next = 0;
+    m_pending = m_workers.size ();
+    m_generation++;
+  }
+  m_start.notify_all ();
+  /* The caller takes part in the work */
+  Work ();
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_done.wait (lock, [this] () { return m_pending == 0; });
+  m_job = 0;
+}
+
+uint32_t
+ParallelFanOut::GetNThreads (void) const
+{
+  return m_workers.size () + 1;
+}
+
+void
+ParallelFanOut::WorkerLoop (void)
+{
+  uint64_t generation = 0;
+  while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        m_start.wait (lock, [this, generation] () { return m_stop || (m_generation != generation); });
+        if (m_stop)
+          {
+            return;
+          }
+        generation = m_generation;
+      }
+      Work ();
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        if (--m_pending == 0)
+          {
+            m_done.notify_one ();
+          }
+      }
+    }
+}
+
+void
+ParallelFanOut::Work (void)
+{
+  uint32_t i;
+  while ((i = m_next.fetch_add (1)) < m_jobs)
+    {
+      (*m_job) (i);
+    }
+}
+
+} // namespace ns3
+
+#endif // PARALLEL_FAN_OUT_H
@@ -0,0 +1,519 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef QD_CHANNEL_TRACE_H
+#define QD_CHANNEL_TRACE_H
+
+#include "ns3/core-module.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Q-D Channel Trace Utilities
+ ********************************************************/
+
+/**
+ * Parameters of a single ray (multipath component) of a Q-D realization.
+ */
+struct QdRay {
+  double delay;               //!< Propagation delay in seconds.
+  double pathGain;            //!< Path gain in dB.
+  double phase;               //!< Phase in radians.
+  double aodElevation;        //!< Angle of departure elevation in degrees.
+  double aodAzimuth;          //!< Angle of departure azimuth in degrees.
+  double aoaElevation;        //!< Angle of arrival elevation in degrees.
+  double aoaAzimuth;          //!< Angle of arrival azimuth in degrees.
+};
+
+typedef std::vector<QdRay> QdRealization;           //!< Rays of one Tx/Rx pair at one trace index.
+typedef std::vector<QdRealization> QdTrace;         //!< Realizations of one Tx/Rx pair ordered by trace index.
+
+/**
+ * \param folder The Q-D model folder (the one given to QdPropagationEngine::QDModelFolder).
+ * \param src The ID of the transmitting node.
+ * \param dst The ID of the receiving node.
+ * \return The path of the Q-D file describing the channel between the two nodes.
+ */
+std::string
+GetQdTraceFileName (std::string folder, uint16_t src, uint16_t dst)
+{
+  return folder + "QdFiles/Tx" + std::to_string (src) + "Rx" + std::to_string (dst) + ".txt";
+}
+
+/**
+ * Read a Q-D file. For each trace index, the file contains the number of rays
+ * followed (if non-zero) by seven comma-separated lines holding the delays,
+ * path gains, phases, AoD elevations, AoD azimuths, AoA elevations and AoA
+ * azimuths of the rays.
+ * \param fileName The path to the Q-D file.
+ * \param trace The realizations of every trace index.
+ * \return True if the file exists.
+ */
+bool
+ReadQdTraceFile (std::string fileName, QdTrace &trace)
+{
+  std::ifstream file (fileName.c_str ());
+  if (!file.good ())
+    {
+      return false;
+    }
+  trace.clear ();
+  std::string line;
+  while (std::getline (file, line))
+    {
+      if (line.empty ())
+        {
+          continue;
+        }
+      uint32_t numberOfRays = std::stoul (line);
+      QdRealization realization (numberOfRays);
+      for (uint8_t parameter = 0; (parameter < 7) && (numberOfRays > 0); parameter++)
+        {
+          if (!std::getline (file, line))
+            {
+              NS_FATAL_ERROR ("Truncated Q-D file " << fileName);
+            }
+          std::istringstream iss (line);
+          std::string value;
+          for (uint32_t ray = 0; ray < numberOfRays; ray++)
+            {
+              if (!std::getline (iss, value, ','))
+                {
+                  NS_FATAL_ERROR ("Malformed Q-D file " << fileName << ": expected " << numberOfRays << " values");
+                }
+              double *field[7] = {&realization[ray].delay, &realization[ray].pathGain, &realization[ray].phase,
+                                  &realization[ray].aodElevation, &realization[ray].aodAzimuth,
+                                  &realization[ray].aoaElevation, &realization[ray].aoaAzimuth};
+              *field[parameter] = std::stod (value);
+            }
+        }
+      trace.push_back (realization);
+    }
+  return true;
+}
+
+/**
+ * Write a Q-D file in the format read by ReadQdTraceFile.
+ * \param fileName The path to the Q-D file.
+ * \param trace The realizations of every trace index.
+ */
+void
+WriteQdTraceFile (std::string fileName, const QdTrace &trace)
+{
+  std::ofstream file (fileName.c_str ());
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("Cannot create Q-D file " << fileName);
+    }
+  file << std::setprecision (12);
+  for (QdTrace::const_iterator it = trace.begin (); it != trace.end (); it++)
+    {
+      file << it->size () << std::endl;
+      if (it->empty ())
+        {
+          continue;
+        }
+      for (uint8_t parameter = 0; parameter < 7; parameter++)
+        {
+          for (uint32_t ray = 0; ray < it->size (); ray++)
+            {
+              const QdRay &r = (*it)[ray];
+              const double field[7] = {r.delay, r.pathGain, r.phase, r.aodElevation, r.aodAzimuth,
+                                       r.aoaElevation, r.aoaAzimuth};
+              file << (ray == 0 ? "" : ",") << field[parameter];
+            }
+          file << std::endl;
+        }
+    }
+  file.close ();
+}
+
+/****** Temporal Interpolation ******/
+
+/**
+ * Interpolate an angle in degrees along the shortest arc.
+ */
+double
+InterpolateAngle (double a, double b, double alpha)
+{
+  double difference = std::remainder (b - a, 360.0);
+  return std::remainder (a + alpha * difference, 360.0);
+}
+
+/**
+ * Interpolate the ray parameters between two consecutive trace indices.
+ * Rays are matched by their order in the realization, which the Q-D
+ * generator keeps stable between trace indices (direct path first, then
+ * reflections by increasing order). Delays and angles are interpolated
+ * linearly and path gains linearly in dB. The phase is rotated according to
+ * the Doppler shift implied by the delay change, from both ends:
+ * phaseA(t) = phase(t0) - 2 pi fc (delay(t) - delay(t0)) and phaseB(t) the
+ * same from t1. The two are blended over the shortest arc, so the phase
+ * starts at phase(t0) and ends at phase(t1) without a jump at the original
+ * trace indices. Rays which exist in only one of the two realizations are
+ * taken from the closest one.
+ * \param a The realization at the first trace index.
+ * \param b The realization at the next trace index.
+ * \param alpha The position between the two trace indices in [0, 1].
+ * \param frequency The carrier frequency in Hz.
+ * \return The interpolated realization.
+ */
+QdRealization
+InterpolateQdRealization (const QdRealization &a, const QdRealization &b, double alpha, double frequency)
+{
+  const QdRealization &closest = (alpha < 0.5) ? a : b;
+  size_t matched = std::min (a.size (), b.size ());
+  QdRealization realization;
+  realization.reserve (closest.size ());
+  for (size_t i = 0; i < closest.size (); i++)
+    {
+      if (i >= matched)
+        {
+          realization.push_back (closest[i]);
+          continue;
+        }
+      QdRay ray;
+      ray.delay = a[i].delay + alpha * (b[i].delay - a[i].delay);
+      ray.pathGain = a[i].pathGain + alpha * (b[i].pathGain - a[i].pathGain);
+      double phaseA = a[i].phase - 2 * M_PI * frequency * (ray.delay - a[i].delay);
+      double phaseB = b[i].phase - 2 * M_PI * frequency * (ray.delay - b[i].delay);
+      ray.phase = std::remainder (phaseA + alpha * std::remainder (phaseB - phaseA, 2 * M_PI), 2 * M_PI);
+      ray.aodElevation = a[i].aodElevation + alpha * (b[i].aodElevation - a[i].aodElevation);
+      ray.aodAzimuth = InterpolateAngle (a[i].aodAzimuth, b[i].aodAzimuth, alpha);
+      ray.aoaElevation = a[i].aoaElevation + alpha * (b[i].aoaElevation - a[i].aoaElevation);
+      ray.aoaAzimuth = InterpolateAngle (a[i].aoaAzimuth, b[i].aoaAzimuth, alpha);
+      realization.push_back (ray);
+    }
+  return realization;
+}
+
+/**
+ * Lookup-time interpolation of the Q-D traces of a scenario. Only the coarse
+ * files emitted by the Q-D generator are stored and parsed: the file of a
+ * Tx/Rx pair is read on the first lookup of the pair, and a lookup between two
+ * trace indices interpolates the two enclosing realizations. Lookups past the
+ * last trace index return the last realization.
+ */
+class QdTraceLoader : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  QdTraceLoader ();
+  virtual ~QdTraceLoader ();
+
+  /**
+   * \param src The ID of the transmitting node.
+   * \param dst The ID of the receiving node.
+   * \return True if the Q-D folder holds a file for the pair.
+   */
+  bool HasTrace (uint16_t src, uint16_t dst);
+  /**
+   * \param src The ID of the transmitting node.
+   * \param dst The ID of the receiving node.
+   * \return The number of trace indices in the file of the pair.
+   */
+  uint32_t GetNTraceIndices (uint16_t src, uint16_t dst);
+  /**
+   * Get the rays of a Tx/Rx pair at a given time.
+   * \param src The ID of the transmitting node.
+   * \param dst The ID of the receiving node.
+   * \param time The time since the start of the trace.
+   * \return The rays interpolated between the two enclosing trace indices.
+   */
+  QdRealization GetRealization (uint16_t src, uint16_t dst, Time time);
+  /**
+   * \return The number of trace indices parsed over all the pairs loaded so far.
+   */
+  uint64_t GetNParsedIndices (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \return The coarse trace of a pair, read on the first call. The trace is empty if the file does not exist.
+   */
+  const QdTrace &GetTrace (uint16_t src, uint16_t dst);
+
+  std::string m_folder;                                           //!< Q-D model folder.
+  Time m_interval;                                                //!< Time between two trace indices of the files.
+  double m_frequency;                                             //!< Carrier frequency in Hz.
+  bool m_interpolate;                                             //!< Flag to indicate if lookups are interpolated.
+  std::map<std::pair<uint16_t, uint16_t>, QdTrace> m_traces;      //!< Coarse trace of each Tx/Rx pair.
+  uint64_t m_parsedIndices;                                       //!< Number of trace indices parsed.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (QdTraceLoader);
+
+TypeId
+QdTraceLoader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QdTraceLoader")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<QdTraceLoader> ()
+    .AddAttribute ("QDModelFolder", "The Q-D model folder holding the QdFiles sub-folder.",
+                   StringValue ("DmgFiles/QdChannel/L-ShapedRoom/"),
+                   MakeStringAccessor (&QdTraceLoader::m_folder),
+                   MakeStringChecker ())
+    .AddAttribute ("Interval", "The time between two consecutive trace indices of the Q-D files.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&QdTraceLoader::m_interval),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("Frequency", "The carrier frequency in Hz, used to rotate the interpolated phases.",
+                   DoubleValue (60.48e9),
+                   MakeDoubleAccessor (&QdTraceLoader::m_frequency),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Interpolate", "Interpolate between trace indices, otherwise hold the last trace index.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QdTraceLoader::m_interpolate),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+QdTraceLoader::QdTraceLoader ()
+  : m_parsedIndices (0)
+{
+}
+
+QdTraceLoader::~QdTraceLoader ()
+{
+}
+
+void
+QdTraceLoader::DoDispose (void)
+{
+  m_traces.clear ();
+  Object::DoDispose ();
+}
+
+const QdTrace &
+QdTraceLoader::GetTrace (uint16_t src, uint16_t dst)
+{
+  std::pair<uint16_t, uint16_t> key = std::make_pair (src, dst);
+  std::map<std::pair<uint16_t, uint16_t>, QdTrace>::iterator it = m_traces.find (key);
+  if (it == m_traces.end ())
+    {
+      it = m_traces.insert (std::make_pair (key, QdTrace ())).first;
+      ReadQdTraceFile (GetQdTraceFileName (m_folder, src, dst), it->second);
+      m_parsedIndices += it->second.size ();
+    }
+  return it->second;
+}
+
+bool
+QdTraceLoader::HasTrace (uint16_t src, uint16_t dst)
+{
+  return !GetTrace (src, dst).empty ();
+}
+
+uint32_t
+QdTraceLoader::GetNTraceIndices (uint16_t src, uint16_t dst)
+{
+  return GetTrace (src, dst).size ();
+}
+
+QdRealization
+QdTraceLoader::GetRealization (uint16_t src, uint16_t dst, Time time)
+{
+  NS_ABORT_MSG_IF (time.IsStrictlyNegative (), "Negative Q-D lookup time");
+  const QdTrace &trace = GetTrace (src, dst);
+  NS_ABORT_MSG_IF (trace.empty (), "No Q-D file for Tx" << src << "Rx" << dst << " in " << m_folder);
+  int64_t index = time.GetNanoSeconds () / m_interval.GetNanoSeconds ();
+  if (index + 1 >= int64_t (trace.size ()))
+    {
+      return trace.back ();
+    }
+  double alpha = double (time.GetNanoSeconds () - index * m_interval.GetNanoSeconds ()) / m_interval.GetNanoSeconds ();
+  if (!m_interpolate || (alpha == 0))
+    {
+      return trace[index];
+    }
+  return InterpolateQdRealization (trace[index], trace[index + 1], alpha, m_frequency);
+}
+
+uint64_t
+QdTraceLoader::GetNParsedIndices (void) const
+{
+  return m_parsedIndices;
+}
+
+/****** Ray Pruning ******/
+
+/**
+ * Policy used to discard weak rays from a Q-D realization.
+ */
+enum QdRayPruningPolicy {
+  PRUNE_NONE = 0,             //!< Keep all the rays.
+  PRUNE_DYNAMIC_RANGE,        //!< Keep the rays within a given range (dB) of the strongest ray.
+  PRUNE_TOP_K,                //!< Keep the K strongest rays.
+};
+
+/**
+ * Discard the weak rays of a single realization. Each realization selects
+ * its own rays, so realizations pruned one by one must not be interpolated,
+ * use PruneQdTrace for whole traces.
+ * \param realization The realization to prune.
+ * \param policy The pruning policy.
+ * \param value The dynamic range in dB for PRUNE_DYNAMIC_RANGE, or K for PRUNE_TOP_K.
+ * \return The pruned realization.
+ */
+QdRealization
+PruneQdRealization (const QdRealization &realization, QdRayPruningPolicy policy, double value)
+{
+  if ((policy == PRUNE_NONE) || realization.empty ())
+    {
+      return realization;
+    }
+  double threshold;
+  if (policy == PRUNE_DYNAMIC_RANGE)
+    {
+      double strongest = -std::numeric_limits<double>::max ();
+      for (QdRealization::const_iterator it = realization.begin (); it != realization.end (); it++)
+        {
+          strongest = std::max (strongest, it->pathGain);
+        }
+      threshold = strongest - value;
+    }
+  else
+    {
+      size_t k = static_cast<size_t> (value);
+      if (k >= realization.size ())
+        {
+          return realization;
+        }
+      if (k == 0)
+        {
+          return QdRealization ();
+        }
+      std::vector<double> gains;
+      gains.reserve (realization.size ());
+      for (QdRealization::const_iterator it = realization.begin (); it != realization.end (); it++)
+        {
+          gains.push_back (it->pathGain);
+        }
+      std::nth_element (gains.begin (), gains.begin () + (k - 1), gains.end (), std::greater<double> ());
+      threshold = gains[k - 1];
+    }
+
+  /* With PRUNE_TOP_K, rays tied with the K-th strongest one are kept only until K rays are selected */
+  size_t ties = realization.size ();
+  if (policy == PRUNE_TOP_K)
+    {
+      size_t stronger = 0;
+      for (QdRealization::const_iterator it = realization.begin (); it != realization.end (); it++)
+        {
+          stronger += (it->pathGain > threshold);
+        }
+      ties = static_cast<size_t> (value) - stronger;
+    }
+  QdRealization pruned;
+  for (QdRealization::const_iterator it = realization.begin (); it != realization.end (); it++)
+    {
+      if (it->pathGain > threshold)
+        {
+          pruned.push_back (*it);
+        }
+      else if ((it->pathGain == threshold) && (ties > 0))
+        {
+          pruned.push_back (*it);
+          ties--;
+        }
+    }
+  return pruned;
+}
+
+/**
+ * Apply a pruning policy to a whole trace. The interpolation matches the rays
+ * of two trace indices by their position in the realization, so the same ray
+ * positions are kept at every trace index:
+ * - PRUNE_DYNAMIC_RANGE keeps a ray if it is within the dynamic range of the
+ *   strongest ray at one trace index at least.
+ * - PRUNE_TOP_K keeps the K rays with the largest path gain over the trace,
+ *   a trace index may therefore hold fewer than its K strongest rays.
+ * \param trace The trace to prune.
+ * \param policy The pruning policy.
+ * \param value The dynamic range in dB for PRUNE_DYNAMIC_RANGE, or K for PRUNE_TOP_K.
+ * \return The pruned trace.
+ */
+QdTrace
+PruneQdTrace (const QdTrace &trace, QdRayPruningPolicy policy, double value)
+{
+  if (policy == PRUNE_NONE)
+    {
+      return trace;
+    }
+
+  /* Strongest path gain of every ray position over the trace */
+  std::vector<double> strongest;
+  std::vector<bool> keep;
+  for (QdTrace::const_iterator it = trace.begin (); it != trace.end (); it++)
+    {
+      if (it->size () > strongest.size ())
+        {
+          strongest.resize (it->size (), -std::numeric_limits<double>::max ());
+          keep.resize (it->size (), false);
+        }
+      double threshold = -std::numeric_limits<double>::max ();
+      for (size_t ray = 0; ray < it->size (); ray++)
+        {
+          strongest[ray] = std::max (strongest[ray], (*it)[ray].pathGain);
+          threshold = std::max (threshold, (*it)[ray].pathGain);
+        }
+      threshold -= value;
+      for (size_t ray = 0; (policy == PRUNE_DYNAMIC_RANGE) && (ray < it->size ()); ray++)
+        {
+          keep[ray] = keep[ray] || ((*it)[ray].pathGain >= threshold);
+        }
+    }
+  if (policy == PRUNE_TOP_K)
+    {
+      std::vector<std::pair<double, size_t> > ranking;
+      for (size_t ray = 0; ray < strongest.size (); ray++)
+        {
+          ranking.push_back (std::make_pair (strongest[ray], ray));
+        }
+      size_t k = std::min (ranking.size (), static_cast<size_t> (value));
+      std::partial_sort (ranking.begin (), ranking.begin () + k, ranking.end (),
+                         std::greater<std::pair<double, size_t> > ());
+      for (size_t i = 0; i < k; i++)
+        {
+          keep[ranking[i].second] = true;
+        }
+    }
+
+  QdTrace output;
+  output.reserve (trace.size ());
+  for (QdTrace::const_iterator it = trace.begin (); it != trace.end (); it++)
+    {
+      QdRealization pruned;
+      for (size_t ray = 0; ray < it->size (); ray++)
+        {
+          if (keep[ray])
+            {
+              pruned.push_back ((*it)[ray]);
+            }
+        }
+      output.push_back (pruned);
+    }
+  return output;
+}
+
+} // namespace ns3
+
+#endif // QD_CHANNEL_TRACE_H
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef SEQUENCE_TRACKER_H
+#define SEQUENCE_TRACKER_H
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Sliding Sequence Window
+ ********************************************************/
+
+#define SEQUENCE_BURST_BINS 8   //!< Burst length bins: 1, 2, 3-4, 5-8, ..., 65+.
+
+/**
+ * Loss and reordering statistics of a flow.
+ */
+struct SequenceStatistics {
+  uint64_t received;                          //!< Number of distinct packets received.
+  uint64_t lost;                              //!< Number of packets never received within the window.
+  uint64_t duplicates;                        //!< Number of duplicate packets.
+  uint64_t reordered;                         //!< Number of packets received after a higher sequence number.
+  uint64_t late;                              //!< Number of packets received after leaving the window.
+  uint64_t maxReorderingDepth;                //!< Largest distance to the highest sequence number received.
+  uint64_t lossBursts;                        //!< Number of loss bursts.
+  uint64_t maxBurstLength;                    //!< Longest loss burst.
+  uint64_t burstHistogram[SEQUENCE_BURST_BINS]; //!< Number of loss bursts per length bin.
+};
+
+/**
+ * Constant memory tracker of the sequence numbers received by a flow. A bitmap
+ * of WindowSize bits marks the packets received in the window that follows the
+ * oldest undecided sequence number. When a sequence number beyond the window is
+ * received, the window slides and every packet leaving it without having been
+ * received is declared lost. Losses are therefore decided in sequence order,
+ * which gives the length of every loss burst without storing them. A packet
+ * arriving after its sequence number left the window is counted as late.
+ */
+class SequenceWindow
+{
+public:
+  /**
+   * Create a sequence window.
+   * \param windowSize The number of sequence numbers in the window, rounded up to a multiple of 64.
+   */
+  SequenceWindow (uint32_t windowSize = 1024);
+
+  /**
+   * Record the reception of a packet.
+   * \param sequence The sequence number of the packet.
+   */
+  void Receive (uint32_t sequence);
+  /**
+   * Compute the statistics as if the flow ended now, i.e. the packets in the
+   * window and not received yet are counted as lost.
+   * \return The statistics of the flow.
+   */
+  SequenceStatistics GetStatistics (void) const;
+
+private:
+  bool IsReceived (uint64_t sequence) const;
+  void SetReceived (uint64_t sequence, bool received);
+  /**
+   * Decide the sequence numbers below a given one, they leave the window.
+   * \param sequence The new oldest undecided sequence number.
+   */
+  void Slide (uint64_t sequence);
+  void EndBurst (void);
+
+  std::vector<uint64_t> m_bitmap;             //!< Reception bitmap of the window.
+  uint64_t m_windowSize;                      //!< Number of sequence numbers in the window.
+  uint64_t m_head;                            //!< Oldest undecided sequence number.
+  uint64_t m_highest;                         //!< Highest sequence number received.
+  bool m_started;                             //!< Whether a packet has been received.
+  uint64_t m_currentBurst;                    //!< Length of the ongoing loss burst.
+  SequenceStatistics m_stats;                 //!< Statistics of the decided sequence numbers.
+
+};
+
+SequenceWindow::SequenceWindow (uint32_t windowSize)
+  : m_bitmap ((windowSize + 63) / 64, 0),
+    m_windowSize (m_bitmap.size () * 64),
+    m_head (0),
+    m_highest (0),
+    m_started (false),
+    m_currentBurst (0)
+{
+  NS_ABORT_MSG_IF (windowSize == 0, "The sequence window cannot be empty");
+  std::memset (&m_stats, 0, sizeof (m_stats));
+}
+
+bool
+SequenceWindow::IsReceived (uint64_t sequence) const
+{
+  uint64_t bit = sequence % m_windowSize;
+  return (m_bitmap[bit / 64] >> (bit % 64)) & 1;
+}
+
+void
+SequenceWindow::SetReceived (uint64_t sequence, bool received)
+{
+  uint64_t bit = sequence % m_windowSize;
+  if (received)
+    {
+      m_bitmap[bit / 64] |= (uint64_t (1) << (bit % 64));
+    }
+  else
+    {
+      m_bitmap[bit / 64] &= ~(uint64_t (1) << (bit % 64));
+    }
+}
+
+void
+SequenceWindow::EndBurst (void)
+{
+  if (m_currentBurst == 0)
+    {
+      return;
+    }
+  m_stats.lossBursts++;
+  m_stats.maxBurstLength = std::max (m_stats.maxBurstLength, m_currentBurst);
+  uint32_t bin = 0;
+  while ((bin < SEQUENCE_BURST_BINS - 1) && ((uint64_t (1) << bin) < m_currentBurst))
+    {
+      bin++;
+    }
+  m_stats.burstHistogram[bin]++;
+  m_currentBurst = 0;
+}
+
+void
+SequenceWindow::Slide (uint64_t sequence)
+{
+  /* Beyond one window, none of the sequence numbers can have been received */
+  if (sequence > m_head + m_windowSize)
+    {
+      uint64_t skipped = sequence - m_head - m_windowSize;
+      Slide (m_head + m_windowSize);
+      m_stats.lost += skipped;
+      m_currentBurst += skipped;
+      m_head = sequence;
+      return;
+    }
+  for (; m_head < sequence; m_head++)
+    {
+      if (IsReceived (m_head))
+        {
+          SetReceived (m_head, false);
+          EndBurst ();
+        }
+      else
+        {
+          m_stats.lost++;
+          m_currentBurst++;
+        }
+    }
+}
+
+void
+SequenceWindow::Receive (uint32_t sequence)
+{
+  if (sequence < m_head)
+    {
+      m_stats.late++;
+      return;
+    }
+  if (sequence >= m_head + m_windowSize)
+    {
+      Slide (uint64_t (sequence) - m_windowSize + 1);
+    }
+  if (IsReceived (sequence))
+    {
+      m_stats.duplicates++;
+      return;
+    }
+  SetReceived (sequence, true);
+  m_stats.received++;
+  if (m_started && (sequence < m_highest))
+    {
+      m_stats.reordered++;
+      m_stats.maxReorderingDepth = std::max<uint64_t> (m_stats.maxReorderingDepth, m_highest - sequence);
+    }
+  if (!m_started || (sequence > m_highest))
+    {
+      m_highest = sequence;
+      m_started = true;
+    }
+}
+
+SequenceStatistics
+SequenceWindow::GetStatistics (void) const
+{
+  if (!m_started)
+    {
+      return m_stats;
+    }
+  SequenceWindow window = *this;
+  window.Slide (m_highest + 1);
+  window.EndBurst ();
+  return window.m_stats;
+}
+
+/********************************************************
+ *              Sequence Monitor
+ ********************************************************/
+
+/**
+ * Loss, duplicate, reordering and loss burst statistics of the flows received
+ * by a set of PacketSinks, in constant memory per flow. It replaces the per
+ * packet state of FlowMonitor for long runs.
+ *
+ * The sequence number travels in the payload: the sources and the sinks are
+ * switched to the SeqTsSizeHeader, which the source writes at the head of each
+ * packet before handing it to its socket, and the monitor listens to the
+ * RxWithSeqTsSize trace source of the sinks. A flow is identified by the socket
+ * address of its source, and flow identifiers are given in order of first
+ * reception.
+ */
+class SequenceMonitor : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  SequenceMonitor ();
+  virtual ~SequenceMonitor ();
+
+  /**
+   * Number the packets sent by a source application.
+   * \param app The source, it must support the EnableSeqTsSizeHeader attribute (e.g. OnOffApplication).
+   */
+  void InstallSource (Ptr<Application> app);
+  /**
+   * Monitor the packets received by a sink.
+   * \param sink The packet sink.
+   */
+  void Install (Ptr<PacketSink> sink);
+  /**
+   * \return The number of packets sent by the sources.
+   */
+  uint64_t GetTotalTxPackets (void) const;
+  /**
+   * \param flowId The identifier of the flow.
+   * \return The statistics of the flow.
+   */
+  SequenceStatistics GetStatistics (uint32_t flowId) const;
+  /**
+   * Print the statistics of all the flows.
+   * \param os The output stream.
+   */
+  void Print (std::ostream &os) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void PacketSent (Ptr<const Packet> packet);
+  void PacketReceived (Ptr<const Packet> packet, const Address &from, const Address &to,
+                       const SeqTsSizeHeader &header);
+
+  uint32_t m_windowSize;                          //!< Sequence window size of every flow.
+  std::map<Address, uint32_t> m_flowIds;          //!< Flow identifier of each source address.
+  std::map<uint32_t, Address> m_sources;          //!< Source address of each flow.
+  std::map<uint32_t, SequenceWindow> m_flows;     //!< Sequence window of each flow.
+  uint64_t m_txPackets;                           //!< Number of packets sent by the sources.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (SequenceMonitor);
+
+TypeId
+SequenceMonitor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SequenceMonitor")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<SequenceMonitor> ()
+    .AddAttribute ("WindowSize", "The number of sequence numbers tracked per flow, larger reordering is counted as loss.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&SequenceMonitor::m_windowSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+SequenceMonitor::SequenceMonitor ()
+  : m_txPackets (0)
+{
+}
+
+SequenceMonitor::~SequenceMonitor ()
+{
+}
+
+void
+SequenceMonitor::DoDispose (void)
+{
+  m_flowIds.clear ();
+  m_sources.clear ();
+  m_flows.clear ();
+  Object::DoDispose ();
+}
+
+void
+SequenceMonitor::InstallSource (Ptr<Application> app)
+{
+  bool enabled = app->SetAttributeFailSafe ("EnableSeqTsSizeHeader", BooleanValue (true));
+  NS_ABORT_MSG_IF (!enabled, "The application cannot carry a SeqTsSizeHeader");
+  bool connected = app->TraceConnectWithoutContext ("Tx", MakeCallback (&SequenceMonitor::PacketSent, this));
+  NS_ABORT_MSG_IF (!connected, "The application does not provide a Tx trace source");
+}
+
+void
+SequenceMonitor::Install (Ptr<PacketSink> sink)
+{
+  sink->SetAttribute ("EnableSeqTsSizeHeader", BooleanValue (true));
+  sink->TraceConnectWithoutContext ("RxWithSeqTsSize", MakeCallback (&SequenceMonitor::PacketReceived, this));
+}
+
+uint64_t
+SequenceMonitor::GetTotalTxPackets (void) const
+{
+  return m_txPackets;
+}
+
+void
+SequenceMonitor::PacketSent (Ptr<const Packet> packet)
+{
+  m_txPackets++;
+}
+
+void
+SequenceMonitor::PacketReceived (Ptr<const Packet> packet, const Address &from, const Address &to,
+                                 const SeqTsSizeHeader &header)
+{
+  std::map<Address, uint32_t>::iterator flow = m_flowIds.find (from);
+  if (flow == m_flowIds.end ())
+    {
+      uint32_t flowId = m_flowIds.size ();
+      flow = m_flowIds.insert (std::make_pair (from, flowId)).first;
+      m_sources[flowId] = from;
+      m_flows.insert (std::make_pair (flowId, SequenceWindow (m_windowSize)));
+    }
+  m_flows.find (flow->second)->second.Receive (header.GetSeq ());
+}
+
+SequenceStatistics
+SequenceMonitor::GetStatistics (uint32_t flowId) const
+{
+  std::map<uint32_t, SequenceWindow>::const_iterator it = m_flows.find (flowId);
+  NS_ABORT_MSG_IF (it == m_flows.end (), "No packet received for flow " << flowId);
+  return it->second.GetStatistics ();
+}
+
+void
+SequenceMonitor::Print (std::ostream &os) const
+{
+  for (std::map<uint32_t, SequenceWindow>::const_iterator it = m_flows.begin (); it != m_flows.end (); it++)
+    {
+      SequenceStatistics stats = it->second.GetStatistics ();
+      uint64_t total = stats.received + stats.lost;
+      os << "Flow " << it->first;
+      Address source = m_sources.find (it->first)->second;
+      if (InetSocketAddress::IsMatchingType (source))
+        {
+          InetSocketAddress address = InetSocketAddress::ConvertFrom (source);
+          os << " (" << address.GetIpv4 () << ":" << address.GetPort () << ")";
+        }
+      os << std::endl;
+      os << "  Rx Packets:      " << stats.received << std::endl;
+      os << "  Lost Packets:    " << stats.lost << " (" << ((total > 0) ? 100.0 * stats.lost / total : 0) << "%)" << std::endl;
+      os << "  Duplicates:      " << stats.duplicates << std::endl;
+      os << "  Late Packets:    " << stats.late << std::endl;
+      os << "  Reordered:       " << stats.reordered << ", max depth " << stats.maxReorderingDepth << std::endl;
+      os << "  Loss Bursts:     " << stats.lossBursts << ", longest " << stats.maxBurstLength << std::endl;
+      os << "  Burst Lengths:  ";
+      for (uint32_t bin = 0; bin < SEQUENCE_BURST_BINS; bin++)
+        {
+          uint64_t upper = uint64_t (1) << bin;
+          if (bin == SEQUENCE_BURST_BINS - 1)
+            {
+              os << " " << (upper / 2 + 1) << "+:";
+            }
+          else if (bin < 2)
+            {
+              os << " " << upper << ":";
+            }
+          else
+            {
+              os << " " << (upper / 2 + 1) << "-" << upper << ":";
+            }
+          os << stats.burstHistogram[bin];
+        }
+      os << std::endl;
+    }
+}
+
+} // namespace ns3
+
+#endif // SEQUENCE_TRACKER_H
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2015-2021 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef SU_MIMO_INCREMENTAL_TRAINING_H
+#define SU_MIMO_INCREMENTAL_TRAINING_H
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+/********************************************************
+ *              Incremental SU-MIMO Retraining
+ ********************************************************/
+
+typedef MIMO_ANTENNA_COMBINATIONS_LIST::value_type MimoCombination;      //!< One Tx sector per Tx/Rx antenna pair.
+typedef MimoCombination::value_type MimoFeedbackConfiguration;           //!< (Tx antenna, Rx antenna, Tx sector).
+
+/**
+ * Candidate selection for the MIMO phase of SU-MIMO BFT retraining.
+ *
+ * A full training tests the K best combinations found over the whole SISO
+ * feedback. When the link is retrained and the channel barely changed, only the
+ * TopCandidates combinations of the last training and their angular neighbours
+ * (each Tx sector moved to the adjacent sector of the codebook) are tested
+ * again, so the candidates follow a slowly moving channel. If the SISO SNR of
+ * the best combination of the last full training dropped by more than
+ * SnrDropThreshold since that training, or if none of the previous candidates
+ * and their neighbours is usable, the selection falls back to a full search. The reference is only taken on full searches, so small drops cannot
+ * add up over incremental searches without ever triggering a full search.
+ */
+class SuMimoIncrementalTraining : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  SuMimoIncrementalTraining ();
+  virtual ~SuMimoIncrementalTraining ();
+
+  /**
+   * Select the candidates to test in the MIMO phase.
+   * \param wifiMac The MAC of the initiator of the SU-MIMO BFT.
+   * \param kBest The number of candidates of a full search.
+   * \param nTxAntennas The number of Tx antennas.
+   * \param nRxAntennas The number of Rx antennas.
+   * \param feedbackMap The SISO phase feedback.
+   * \return The list of candidates to test in the MIMO phase.
+   */
+  MIMO_ANTENNA_COMBINATIONS_LIST SelectCandidates (Ptr<DmgWifiMac> wifiMac, uint32_t kBest,
+                                                   uint8_t nTxAntennas, uint8_t nRxAntennas,
+                                                   MIMO_FEEDBACK_MAP feedbackMap);
+  /**
+   * \return The number of full searches.
+   */
+  uint32_t GetNFullSearches (void) const;
+  /**
+   * \return The number of incremental searches.
+   */
+  uint32_t GetNIncrementalSearches (void) const;
+  /**
+   * \return The total number of candidates tested in the MIMO phase.
+   */
+  uint64_t GetNCandidates (void) const;
+
+private:
+  /**
+   * Compute the metric of a combination, i.e. the minimum SISO SNR of its streams.
+   * \param combination The combination.
+   * \param feedbackMap The SISO phase feedback.
+   * \return The metric (linear) or zero if one of its configurations is not in the feedback.
+   */
+  double GetMetric (const MimoCombination &combination, const MIMO_FEEDBACK_MAP &feedbackMap) const;
+
+  uint32_t m_topCandidates;                     //!< Number of candidates kept from the last full search.
+  double m_snrDropThreshold;                    //!< SNR drop (dB) triggering a full search.
+  MIMO_ANTENNA_COMBINATIONS_LIST m_previous;    //!< Top candidates of the last search.
+  MimoCombination m_reference;                  //!< Best candidate of the last full search.
+  double m_referenceMetric;                     //!< Metric of the best candidate when it was found.
+  uint32_t m_fullSearches;                      //!< Number of full searches.
+  uint32_t m_incrementalSearches;               //!< Number of incremental searches.
+  uint64_t m_candidates;                        //!< Total number of candidates tested.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (SuMimoIncrementalTraining);
+
+TypeId
+SuMimoIncrementalTraining::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SuMimoIncrementalTraining")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<SuMimoIncrementalTraining> ()
+    .AddAttribute ("TopCandidates", "The number of candidates of the last full search that are retrained.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&SuMimoIncrementalTraining::m_topCandidates),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SnrDropThreshold", "The SNR drop in dB of the best candidate that triggers a full search.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&SuMimoIncrementalTraining::m_snrDropThreshold),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+SuMimoIncrementalTraining::SuMimoIncrementalTraining ()
+  : m_referenceMetric (0),
+    m_fullSearches (0),
+    m_incrementalSearches (0),
+    m_candidates (0)
+{
+}
+
+SuMimoIncrementalTraining::~SuMimoIncrementalTraining ()
+{
+}
+
+double
+SuMimoIncrementalTraining::GetMetric (const MimoCombination &combination, const MIMO_FEEDBACK_MAP &feedbackMap) const
+{
+  double metric = 0;
+  for (MimoCombination::const_iterator it = combination.begin (); it != combination.end (); it++)
+    {
+      MIMO_FEEDBACK_MAP::const_iterator snr = feedbackMap.find (*it);
+      if (snr == feedbackMap.end ())
+        {
+          return 0;
+        }
+      metric = (it == combination.begin ()) ? snr->second : std::min (metric, snr->second);
+    }
+  return metric;
+}
+
+MIMO_ANTENNA_COMBINATIONS_LIST
+SuMimoIncrementalTraining::SelectCandidates (Ptr<DmgWifiMac> wifiMac, uint32_t kBest,
+                                             uint8_t nTxAntennas, uint8_t nRxAntennas,
+                                             MIMO_FEEDBACK_MAP feedbackMap)
+{
+  MIMO_ANTENNA_COMBINATIONS_LIST candidates;
+  bool fullSearch = m_previous.empty ();
+  if (!fullSearch)
+    {
+      double metric = GetMetric (m_reference, feedbackMap);
+      fullSearch = (metric == 0) || (RatioToDb (m_referenceMetric) - RatioToDb (metric) > m_snrDropThreshold);
+    }
+
+  if (!fullSearch)
+    {
+      /* Previous top candidates and their angular neighbours, one stream moved at a time */
+      std::vector<std::pair<double, MimoCombination> > ranked;
+      for (MIMO_ANTENNA_COMBINATIONS_LIST::const_iterator it = m_previous.begin (); it != m_previous.end (); it++)
+        {
+          std::vector<MimoCombination> neighbours (1, *it);
+          for (uint32_t stream = 0; stream < it->size (); stream++)
+            {
+              for (int8_t step = -1; step <= 1; step += 2)
+                {
+                  MimoCombination neighbour = *it;
+                  std::get<2> (neighbour[stream]) += step;
+                  neighbours.push_back (neighbour);
+                }
+            }
+          for (std::vector<MimoCombination>::const_iterator neighbour = neighbours.begin (); neighbour != neighbours.end (); neighbour++)
+            {
+              double metric = GetMetric (*neighbour, feedbackMap);
+              if (metric > 0)
+                {
+                  ranked.push_back (std::make_pair (metric, *neighbour));
+                }
+            }
+        }
+      std::sort (ranked.begin (), ranked.end ());
+      ranked.erase (std::unique (ranked.begin (), ranked.end ()), ranked.end ());
+      for (std::vector<std::pair<double, MimoCombination> >::reverse_iterator it = ranked.rbegin (); it != ranked.rend (); it++)
+        {
+          candidates.push_back (it->second);
+        }
+      /* If none of the previous candidates is usable any more, search the whole feedback */
+      fullSearch = candidates.empty ();
+      if (!fullSearch)
+        {
+          m_incrementalSearches++;
+        }
+    }
+
+  if (fullSearch)
+    {
+      candidates = wifiMac->FindKBestCombinations (kBest, nTxAntennas, nRxAntennas, feedbackMap);
+      if (!candidates.empty ())
+        {
+          m_reference = candidates.front ();
+          m_referenceMetric = GetMetric (m_reference, feedbackMap);
+        }
+      m_fullSearches++;
+    }
+
+  /* The next incremental search starts from the best candidates of this one */
+  m_previous.assign (candidates.begin (), candidates.begin () + std::min<size_t> (m_topCandidates, candidates.size ()));
+  m_candidates += candidates.size ();
+  return candidates;
+}
+
+uint32_t
+SuMimoIncrementalTraining::GetNFullSearches (void) const
+{
+  return m_fullSearches;
+}
+
+uint32_t
+SuMimoIncrementalTraining::GetNIncrementalSearches (void) const
+{
+  return m_incrementalSearches;
+}
+
+uint64_t
+SuMimoIncrementalTraining::GetNCandidates (void) const
+{
+  return m_candidates;
+}
+
+} // namespace ns3
+
+#endif // SU_MIMO_INCREMENTAL_TRAINING_H
@@ -0,0 +1,871 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef TRACE_REPLAY_APPLICATION_H
+#define TRACE_REPLAY_APPLICATION_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace ns3 {
+
+/********************************************************
+ *              Binary Traffic Trace File
+ ********************************************************/
+
+/**
+ * One packet of a traffic trace. The records of a frame are consecutive and
+ * share the same frame identifier, frame identifiers increase along the trace.
+ */
+struct TraceReplayRecord {
+  uint64_t interArrival;      //!< Time since the previous packet in nanoseconds.
+  uint32_t size;              //!< Packet size in bytes, including the TraceReplayHeader.
+  uint32_t frameId;           //!< Identifier of the frame the packet belongs to.
+};
+
+/**
+ * Header of a binary traffic trace file, followed by the records.
+ */
+struct TraceReplayFileHeader {
+  char magic[8];              //!< "DMGTRACE".
+  uint32_t version;           //!< Format version.
+  uint32_t recordSize;        //!< Size of one record in bytes.
+  uint64_t records;           //!< Number of records.
+};
+
+#define TRACE_REPLAY_MAGIC    "DMGTRACE"
+#define TRACE_REPLAY_VERSION  1
+
+/**
+ * Read-only view of a binary traffic trace file. The file is memory mapped, so
+ * traces of millions of records are neither parsed nor copied: the pages are
+ * loaded by the kernel as the replay walks through them.
+ */
+class TraceReplayFile : public SimpleRefCount<TraceReplayFile>
+{
+public:
+  /**
+   * Map a trace file.
+   * \param fileName The path to the binary trace file.
+   */
+  TraceReplayFile (std::string fileName);
+  ~TraceReplayFile ();
+
+  /**
+   * \return The number of records.
+   */
+  uint64_t GetNRecords (void) const;
+  /**
+   * \param index The index of the record.
+   * \return The record.
+   */
+  const TraceReplayRecord &GetRecord (uint64_t index) const;
+
+private:
+  void *m_mapping;                      //!< Start of the mapping.
+  size_t m_length;                      //!< Length of the mapping.
+  const TraceReplayRecord *m_records;   //!< First record.
+  uint64_t m_nRecords;                  //!< Number of records.
+
+};
+
+TraceReplayFile::TraceReplayFile (std::string fileName)
+{
+  int fd = open (fileName.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, "Traffic trace file " << fileName << " not found");
+  struct stat info;
+  NS_ABORT_MSG_IF (fstat (fd, &info) != 0, "Cannot stat traffic trace file " << fileName);
+  m_length = info.st_size;
+  NS_ABORT_MSG_IF (m_length < sizeof (TraceReplayFileHeader), "Truncated traffic trace file " << fileName);
+  m_mapping = mmap (0, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (m_mapping == MAP_FAILED, "Cannot map traffic trace file " << fileName);
+  /* The trace is replayed from the first to the last record */
+  madvise (m_mapping, m_length, MADV_SEQUENTIAL);
+
+  const TraceReplayFileHeader *header = static_cast<const TraceReplayFileHeader *> (m_mapping);
+  NS_ABORT_MSG_IF (std::memcmp (header->magic, TRACE_REPLAY_MAGIC, sizeof (header->magic)) != 0,
+                   fileName << " is not a traffic trace file");
+  NS_ABORT_MSG_IF (header->version != TRACE_REPLAY_VERSION, "Unsupported traffic trace version " << header->version);
+  NS_ABORT_MSG_IF (header->recordSize != sizeof (TraceReplayRecord), "Wrong traffic trace record size");
+  m_nRecords = header->records;
+  NS_ABORT_MSG_IF (sizeof (TraceReplayFileHeader) + m_nRecords * sizeof (TraceReplayRecord) > m_length,
+                   "Truncated traffic trace file " << fileName);
+  NS_ABORT_MSG_IF (m_nRecords == 0, "Empty traffic trace file " << fileName);
+  m_records = reinterpret_cast<const TraceReplayRecord *> (static_cast<const char *> (m_mapping)
+                                                            + sizeof (TraceReplayFileHeader));
+}
+
+TraceReplayFile::~TraceReplayFile ()
+{
+  munmap (m_mapping, m_length);
+}
+
+uint64_t
+TraceReplayFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+const TraceReplayRecord &
+TraceReplayFile::GetRecord (uint64_t index) const
+{
+  return m_records[index];
+}
+
+/**
+ * Sequential writer of binary traffic trace files.
+ */
+class TraceReplayFileWriter
+{
+public:
+  /**
+   * Create a trace file.
+   * \param fileName The path to the binary trace file.
+   */
+  TraceReplayFileWriter (std::string fileName);
+  ~TraceReplayFileWriter ();
+
+  /**
+   * Append a packet to the trace.
+   * \param interArrival The time since the previous packet.
+   * \param size The packet size in bytes.
+   * \param frameId The identifier of the frame the packet belongs to.
+   */
+  void Add (Time interArrival, uint32_t size, uint32_t frameId);
+  /**
+   * Write the number of records and close the file.
+   */
+  void Close (void);
+
+private:
+  std::ofstream m_file;                 //!< Trace file.
+  TraceReplayFileHeader m_header;       //!< Header of the trace file.
+
+};
+
+TraceReplayFileWriter::TraceReplayFileWriter (std::string fileName)
+{
+  m_file.open (fileName.c_str (), std::ofstream::out | std::ofstream::binary);
+  NS_ABORT_MSG_IF (!m_file.good (), "Cannot create traffic trace file " << fileName);
+  std::memcpy (m_header.magic, TRACE_REPLAY_MAGIC, sizeof (m_header.magic));
+  m_header.version = TRACE_REPLAY_VERSION;
+  m_header.recordSize = sizeof (TraceReplayRecord);
+  m_header.records = 0;
+  m_file.write (reinterpret_cast<const char *> (&m_header), sizeof (m_header));
+}
+
+TraceReplayFileWriter::~TraceReplayFileWriter ()
+{
+  if (m_file.is_open ())
+    {
+      Close ();
+    }
+}
+
+void
+TraceReplayFileWriter::Add (Time interArrival, uint32_t size, uint32_t frameId)
+{
+  TraceReplayRecord record;
+  record.interArrival = interArrival.GetNanoSeconds ();
+  record.size = size;
+  record.frameId = frameId;
+  m_file.write (reinterpret_cast<const char *> (&record), sizeof (record));
+  m_header.records++;
+}
+
+void
+TraceReplayFileWriter::Close (void)
+{
+  m_file.seekp (0);
+  m_file.write (reinterpret_cast<const char *> (&m_header), sizeof (m_header));
+  m_file.close ();
+}
+
+/********************************************************
+ *              Trace Replay Header
+ ********************************************************/
+
+/**
+ * Header carried by every packet of a replayed trace so that the sink can
+ * rebuild the frames and account for their deadline.
+ */
+class TraceReplayHeader : public Header
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TraceReplayHeader ();
+
+  /**
+   * Set the frame the packet belongs to.
+   * \param frameId The identifier of the frame.
+   * \param packets The number of packets of the frame.
+   * \param generation The nominal generation time of the frame.
+   */
+  void SetFrame (uint32_t frameId, uint16_t packets, Time generation);
+  /**
+   * \param index The index of the packet in the frame.
+   */
+  void SetIndex (uint16_t index);
+  /**
+   * \return The identifier of the frame.
+   */
+  uint32_t GetFrameId (void) const;
+  /**
+   * \return The number of packets of the frame.
+   */
+  uint16_t GetNPackets (void) const;
+  /**
+   * \return The index of the packet in the frame.
+   */
+  uint16_t GetIndex (void) const;
+  /**
+   * \return The nominal generation time of the frame.
+   */
+  Time GetGeneration (void) const;
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint32_t m_frameId;         //!< Identifier of the frame.
+  uint16_t m_packets;         //!< Number of packets of the frame.
+  uint16_t m_index;           //!< Index of the packet in the frame.
+  uint64_t m_generation;      //!< Nominal generation time of the frame in nanoseconds.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TraceReplayHeader);
+
+TypeId
+TraceReplayHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceReplayHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TraceReplayHeader> ()
+  ;
+  return tid;
+}
+
+TraceReplayHeader::TraceReplayHeader ()
+  : m_frameId (0),
+    m_packets (0),
+    m_index (0),
+    m_generation (0)
+{
+}
+
+void
+TraceReplayHeader::SetFrame (uint32_t frameId, uint16_t packets, Time generation)
+{
+  m_frameId = frameId;
+  m_packets = packets;
+  m_generation = generation.GetNanoSeconds ();
+}
+
+void
+TraceReplayHeader::SetIndex (uint16_t index)
+{
+  m_index = index;
+}
+
+uint32_t
+TraceReplayHeader::GetFrameId (void) const
+{
+  return m_frameId;
+}
+
+uint16_t
+TraceReplayHeader::GetNPackets (void) const
+{
+  return m_packets;
+}
+
+uint16_t
+TraceReplayHeader::GetIndex (void) const
+{
+  return m_index;
+}
+
+Time
+TraceReplayHeader::GetGeneration (void) const
+{
+  return NanoSeconds (m_generation);
+}
+
+TypeId
+TraceReplayHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TraceReplayHeader::Print (std::ostream &os) const
+{
+  os << "frame=" << m_frameId << " packet=" << m_index << "/" << m_packets
+     << " generation=" << NanoSeconds (m_generation).GetSeconds ();
+}
+
+uint32_t
+TraceReplayHeader::GetSerializedSize (void) const
+{
+  return 16;
+}
+
+void
+TraceReplayHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_frameId);
+  start.WriteHtonU16 (m_packets);
+  start.WriteHtonU16 (m_index);
+  start.WriteHtonU64 (m_generation);
+}
+
+uint32_t
+TraceReplayHeader::Deserialize (Buffer::Iterator start)
+{
+  m_frameId = start.ReadNtohU32 ();
+  m_packets = start.ReadNtohU16 ();
+  m_index = start.ReadNtohU16 ();
+  m_generation = start.ReadNtohU64 ();
+  return GetSerializedSize ();
+}
+
+/********************************************************
+ *              Trace Replay Application
+ ********************************************************/
+
+/**
+ * Application replaying a binary traffic trace (packet sizes, inter-arrival
+ * times and frame boundaries), e.g. a VR or video stream.
+ *
+ * A simulator event is not scheduled per packet: each timer expiration sends
+ * every packet due within BatchWindow, which for frame based traffic sends a
+ * whole frame burst in one event. With a zero BatchWindow only the packets due
+ * at exactly the same time are batched and the trace timing is kept intact.
+ */
+class TraceReplayApplication : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TraceReplayApplication ();
+  virtual ~TraceReplayApplication ();
+
+  /**
+   * \return The number of frames sent.
+   */
+  uint64_t GetTotalTxFrames (void) const;
+  /**
+   * \return The number of packets sent.
+   */
+  uint64_t GetTotalTxPackets (void) const;
+  /**
+   * \return The number of bytes sent.
+   */
+  uint64_t GetTotalTxBytes (void) const;
+  /**
+   * \return The number of packets the socket refused.
+   */
+  uint64_t GetTotalDroppedPackets (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * Send all the packets due within the batch window and schedule the next batch.
+   */
+  void SendBatch (void);
+  /**
+   * Send the current record.
+   */
+  void SendRecord (void);
+  /**
+   * Move to the next record, wrapping around the trace in loop mode.
+   * \return False if the end of the trace is reached.
+   */
+  bool Advance (void);
+
+  std::string m_fileName;               //!< Path to the trace file.
+  Address m_peer;                       //!< Remote address.
+  TypeId m_tid;                         //!< Type of the socket factory.
+  Time m_batchWindow;                   //!< Packets due within this window are sent in the same event.
+  bool m_loop;                          //!< Whether to restart the trace when it ends.
+  Ptr<TraceReplayFile> m_trace;         //!< Memory mapped trace.
+  Ptr<Socket> m_socket;                 //!< Socket to send the packets.
+  EventId m_sendEvent;                  //!< Next batch.
+  uint64_t m_next;                      //!< Index of the next record.
+  Time m_nextTime;                      //!< Departure time of the next record.
+  uint32_t m_frameOffset;               //!< Offset added to the frame identifiers in loop mode.
+  TraceReplayHeader m_frame;            //!< Header of the current frame.
+  bool m_newFrame;                      //!< Whether the next record starts a new frame.
+  uint64_t m_frames;                    //!< Number of frames sent.
+  uint64_t m_packets;                   //!< Number of packets sent.
+  uint64_t m_bytes;                     //!< Number of bytes sent.
+  uint64_t m_dropped;                   //!< Number of packets refused by the socket.
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TraceReplayApplication);
+
+TypeId
+TraceReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceReplayApplication")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TraceReplayApplication> ()
+    .AddAttribute ("TraceFile", "The path to the binary traffic trace file.",
+                   StringValue (""),
+                   MakeStringAccessor (&TraceReplayApplication::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Remote", "The address of the destination.",
+                   AddressValue (),
+                   MakeAddressAccessor (&TraceReplayApplication::m_peer),
+                   MakeAddressChecker ())
+    .AddAttribute ("Protocol", "The type of protocol to use.",
+                   TypeIdValue (UdpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&TraceReplayApplication::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("BatchWindow", "Packets due within this window are sent by the same timer event.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TraceReplayApplication::m_batchWindow),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("Loop", "Whether to restart the trace from the beginning when it ends.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TraceReplayApplication::m_loop),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Tx", "A new packet is sent.",
+                     MakeTraceSourceAccessor (&TraceReplayApplication::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+TraceReplayApplication::TraceReplayApplication ()
+  : m_next (0),
+    m_frameOffset (0),
+    m_newFrame (true),
+    m_frames (0),
+    m_packets (0),
+    m_bytes (0),
+    m_dropped (0)
+{
+}
+
+TraceReplayApplication::~TraceReplayApplication ()
+{
+}
+
+void
+TraceReplayApplication::DoDispose (void)
+{
+  m_socket = 0;
+  m_trace = 0;
+  Application::DoDispose ();
+}
+
+void
+TraceReplayApplication::StartApplication (void)
+{
+  if (!m_trace)
+    {
+      m_trace = Create<TraceReplayFile> (m_fileName);
+    }
+  if (!m_socket)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), m_tid);
+      if (Inet6SocketAddress::IsMatchingType (m_peer))
+        {
+          m_socket->Bind6 ();
+        }
+      else
+        {
+          m_socket->Bind ();
+        }
+      m_socket->Connect (m_peer);
+      m_socket->ShutdownRecv ();
+    }
+  m_nextTime = Simulator::Now () + NanoSeconds (m_trace->GetRecord (m_next).interArrival);
+  m_sendEvent = Simulator::Schedule (m_nextTime - Simulator::Now (), &TraceReplayApplication::SendBatch, this);
+}
+
+void
+TraceReplayApplication::StopApplication (void)
+{
+  Simulator::Cancel (m_sendEvent);
+  if (m_socket)
+    {
+      m_socket->Close ();
+    }
+}
+
+void
+TraceReplayApplication::SendBatch (void)
+{
+  Time limit = Simulator::Now () + m_batchWindow;
+  do
+    {
+      SendRecord ();
+      if (!Advance ())
+        {
+          return;
+        }
+    }
+  while (m_nextTime <= limit);
+  m_sendEvent = Simulator::Schedule (m_nextTime - Simulator::Now (), &TraceReplayApplication::SendBatch, this);
+}
+
+void
+TraceReplayApplication::SendRecord (void)
+{
+  const TraceReplayRecord &record = m_trace->GetRecord (m_next);
+  if (m_newFrame)
+    {
+      /* Count the packets of the frame, they are consecutive in the trace */
+      uint64_t last = m_next;
+      while ((last + 1 < m_trace->GetNRecords ()) && (m_trace->GetRecord (last + 1).frameId == record.frameId))
+        {
+          last++;
+        }
+      NS_ABORT_MSG_IF (last - m_next >= 65535, "Frame " << record.frameId << " has too many packets");
+      m_frame.SetFrame (m_frameOffset + record.frameId, last - m_next + 1, m_nextTime);
+      m_frame.SetIndex (0);
+      m_newFrame = false;
+      m_frames++;
+    }
+  else
+    {
+      m_frame.SetIndex (m_frame.GetIndex () + 1);
+    }
+
+  uint32_t size = std::max (record.size, m_frame.GetSerializedSize ());
+  Ptr<Packet> packet = Create<Packet> (size - m_frame.GetSerializedSize ());
+  packet->AddHeader (m_frame);
+  m_txTrace (packet);
+  if (m_socket->Send (packet) >= 0)
+    {
+      m_packets++;
+      m_bytes += size;
+    }
+  else
+    {
+      m_dropped++;
+    }
+}
+
+bool
+TraceReplayApplication::Advance (void)
+{
+  uint32_t frameId = m_trace->GetRecord (m_next).frameId;
+  m_next++;
+  if (m_next == m_trace->GetNRecords ())
+    {
+      if (!m_loop)
+        {
+          return false;
+        }
+      m_next = 0;
+      m_frameOffset += frameId + 1;
+    }
+  m_newFrame = (m_next == 0) || (m_trace->GetRecord (m_next).frameId != frameId);
+  m_nextTime += NanoSeconds (m_trace->GetRecord (m_next).interArrival);
+  return true;
+}
+
+uint64_t
+TraceReplayApplication::GetTotalTxFrames (void) const
+{
+  return m_frames;
+}
+
+uint64_t
+TraceReplayApplication::GetTotalTxPackets (void) const
+{
+  return m_packets;
+}
+
+uint64_t
+TraceReplayApplication::GetTotalTxBytes (void) const
+{
+  return m_bytes;
+}
+
+uint64_t
+TraceReplayApplication::GetTotalDroppedPackets (void) const
+{
+  return m_dropped;
+}
+
+/********************************************************
+ *              Trace Replay Sink
+ ********************************************************/
+
+/**
+ * Sink of a TraceReplayApplication with per-frame deadline accounting. A frame
+ * is delivered once all its packets are received: on time if this happens within
+ * Deadline of its nominal generation, late otherwise. A frame still incomplete
+ * LossTimeout after its generation is lost; the frames of which no packet is
+ * received are the difference between the frames sent and the frames accounted
+ * here, see GetTotalLostFrames.
+ */
+class TraceReplaySink : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TraceReplaySink ();
+  virtual ~TraceReplaySink ();
+
+  /**
+   * \return The number of bytes received.
+   */
+  uint64_t GetTotalRx (void) const;
+  /**
+   * \return The number of frames delivered before their deadline.
+   */
+  uint64_t GetTotalOnTimeFrames (void) const;
+  /**
+   * \return The number of frames delivered after their deadline.
+   */
+  uint64_t GetTotalLateFrames (void) const;
+  /**
+   * \param sentFrames The number of frames sent by the source.
+   * \return The number of frames not (completely) delivered.
+   */
+  uint64_t GetTotalLostFrames (uint64_t sentFrames) const;
+  /**
+   * \return The average latency of the delivered frames.
+   */
+  Time GetAverageFrameLatency (void) const;
+
+  /**
+   * TracedCallback signature for frame delivery events.
+   *
+   * \param frameId The identifier of the frame.
+   * \param latency The time between the generation and the delivery of the frame.
+   * \param onTime Whether the frame is delivered before its deadline.
+   */
+  typedef void (* FrameCallback)(uint32_t frameId, Time latency, bool onTime);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  struct FrameState {
+    uint16_t received;                  //!< Number of packets received.
+    uint16_t packets;                   //!< Number of packets of the frame.
+    Time generation;                    //!< Nominal generation time.
+  };
+
+  void HandleRead (Ptr<Socket> socket);
+  /**
+   * Discard the incomplete frames generated more than LossTimeout ago.
+   */
+  void PurgeFrames (void);
+
+  Address m_local;                      //!< Local address to bind to.
+  TypeId m_tid;                         //!< Type of the socket factory.
+  Time m_deadline;                      //!< Frame deadline.
+  Time m_lossTimeout;                   //!< Time after which an incomplete frame is lost.
+  Ptr<Socket> m_socket;                 //!< Listening socket.
+  std::map<uint32_t, FrameState> m_pending; //!< Incomplete frames.
+  uint64_t m_bytes;                     //!< Number of bytes received.
+  uint64_t m_onTime;                    //!< Number of frames delivered on time.
+  uint64_t m_late;                      //!< Number of frames delivered late.
+  Time m_totalLatency;                  //!< Sum of the latencies of the delivered frames.
+  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+  TracedCallback<uint32_t, Time, bool> m_frameTrace;
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TraceReplaySink);
+
+TypeId
+TraceReplaySink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceReplaySink")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TraceReplaySink> ()
+    .AddAttribute ("Local", "The address on which to bind the socket.",
+                   AddressValue (),
+                   MakeAddressAccessor (&TraceReplaySink::m_local),
+                   MakeAddressChecker ())
+    .AddAttribute ("Protocol", "The type of protocol to use.",
+                   TypeIdValue (UdpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&TraceReplaySink::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("Deadline", "The maximum latency of a frame delivered on time.",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&TraceReplaySink::m_deadline),
+                   MakeTimeChecker ())
+    .AddAttribute ("LossTimeout", "The time after its generation at which an incomplete frame is lost.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&TraceReplaySink::m_lossTimeout),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Rx", "A packet has been received.",
+                     MakeTraceSourceAccessor (&TraceReplaySink::m_rxTrace),
+                     "ns3::Packet::AddressTracedCallback")
+    .AddTraceSource ("Frame", "A frame has been completely received.",
+                     MakeTraceSourceAccessor (&TraceReplaySink::m_frameTrace),
+                     "ns3::TraceReplaySink::FrameCallback")
+  ;
+  return tid;
+}
+
+TraceReplaySink::TraceReplaySink ()
+  : m_bytes (0),
+    m_onTime (0),
+    m_late (0)
+{
+}
+
+TraceReplaySink::~TraceReplaySink ()
+{
+}
+
+void
+TraceReplaySink::DoDispose (void)
+{
+  m_socket = 0;
+  m_pending.clear ();
+  Application::DoDispose ();
+}
+
+void
+TraceReplaySink::StartApplication (void)
+{
+  if (!m_socket)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), m_tid);
+      NS_ABORT_MSG_IF (m_socket->Bind (m_local) == -1, "Failed to bind the trace replay sink socket");
+    }
+  m_socket->SetRecvCallback (MakeCallback (&TraceReplaySink::HandleRead, this));
+}
+
+void
+TraceReplaySink::StopApplication (void)
+{
+  if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+}
+
+void
+TraceReplaySink::HandleRead (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      if (packet->GetSize () == 0)
+        {
+          break;
+        }
+      m_bytes += packet->GetSize ();
+      m_rxTrace (packet, from);
+
+      TraceReplayHeader header;
+      packet->PeekHeader (header);
+      std::map<uint32_t, FrameState>::iterator it = m_pending.find (header.GetFrameId ());
+      if (it == m_pending.end ())
+        {
+          FrameState state;
+          state.received = 0;
+          state.packets = header.GetNPackets ();
+          state.generation = header.GetGeneration ();
+          it = m_pending.insert (std::make_pair (header.GetFrameId (), state)).first;
+        }
+      it->second.received++;
+      if (it->second.received == it->second.packets)
+        {
+          Time latency = Simulator::Now () - it->second.generation;
+          bool onTime = (latency <= m_deadline);
+          if (onTime)
+            {
+              m_onTime++;
+            }
+          else
+            {
+              m_late++;
+            }
+          m_totalLatency += latency;
+          m_frameTrace (it->first, latency, onTime);
+          m_pending.erase (it);
+        }
+    }
+  PurgeFrames ();
+}
+
+void
+TraceReplaySink::PurgeFrames (void)
+{
+  /* Frame identifiers and generation times increase together, the oldest frames come first */
+  Time now = Simulator::Now ();
+  while (!m_pending.empty () && (now - m_pending.begin ()->second.generation > m_lossTimeout))
+    {
+      m_pending.erase (m_pending.begin ());
+    }
+}
+
+uint64_t
+TraceReplaySink::GetTotalRx (void) const
+{
+  return m_bytes;
+}
+
+uint64_t
+TraceReplaySink::GetTotalOnTimeFrames (void) const
+{
+  return m_onTime;
+}
+
+uint64_t
+TraceReplaySink::GetTotalLateFrames (void) const
+{
+  return m_late;
+}
+
+uint64_t
+TraceReplaySink::GetTotalLostFrames (uint64_t sentFrames) const
+{
+  return sentFrames - m_onTime - m_late;
+}
+
+Time
+TraceReplaySink::GetAverageFrameLatency (void) const
+{
+  uint64_t delivered = m_onTime + m_late;
+  return (delivered == 0) ? Seconds (0) : NanoSeconds (m_totalLatency.GetNanoSeconds () / delivered);
+}
+
+} // namespace ns3
+
+#endif // TRACE_REPLAY_APPLICATION_H
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2015-2020 IMDEA Networks Institute
+ * Author: Hany Assasa <hany.assasa@gmail.com>
+ */
+
+#ifndef WIFI_FRAME_DESCRIPTOR_H
+#define WIFI_FRAME_DESCRIPTOR_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+#define WIFI_FRAME_TYPE_CONTROL     1       //!< Type field of control frames.
+#define WIFI_FRAME_TYPE_DATA        2       //!< Type field of data frames.
+#define WIFI_FRAME_TYPE_EXTENSION   3       //!< Type field of extension frames (DMG Beacon).
+#define WIFI_FRAME_SUBTYPE_CTS      12      //!< Subtype field of CTS frames.
+#define WIFI_FRAME_SUBTYPE_ACK      13      //!< Subtype field of ACK frames.
+#define WIFI_FRAME_PEEK_SIZE        16      //!< Frame Control, Duration, Address 1 and Address 2.
+#define WIFI_AMPDU_DELIMITER_SIZE   4       //!< Size of the A-MPDU subframe delimiter.
+#define WIFI_AMPDU_SIGNATURE        0x4E    //!< Delimiter Signature field, last byte of the delimiter.
+
+/**
+ * Lightweight description of an MPDU seen by the PHY layer. It is filled once
+ * per MPDU from the first bytes of the MAC header and from the TXVECTOR given
+ * by the PHY, so trace sinks can filter and count frames without deserialising
+ * a WifiMacHeader or scanning the packet tags.
+ */
+struct WifiFrameDescriptor {
+  uint8_t type;                         //!< Type field of the Frame Control.
+  uint8_t subtype;                      //!< Subtype field of the Frame Control.
+  bool isData;                          //!< Whether the frame is a data frame, as WifiMacHeader::IsData.
+  Mac48Address receiver;                //!< Address 1 of the frame.
+  Mac48Address transmitter;             //!< Address 2 of the frame, zero if the frame has none.
+  uint32_t length;                      //!< Size of the MPDU in bytes, without A-MPDU delimiter and padding.
+  bool hasPhyInfo;                      //!< Whether the mode, SNR and A-MPDU fields are valid.
+  WifiMode mode;                        //!< Mode (MCS) of the PPDU carrying the frame.
+  double snr;                           //!< SNR of the PPDU in dB, received frames only.
+  MpduType mpduType;                    //!< Position of the MPDU in the A-MPDU.
+  uint32_t mpduRefNumber;               //!< Reference number of the A-MPDU.
+  WifiPhyRxfailureReason reason;        //!< Reason of the drop, dropped frames only.
+};
+
+/**
+ * Publish the frames sent, received and dropped by a WifiPhy as
+ * WifiFrameDescriptors. The frames sent and received are taken from the
+ * monitor (sniffer) trace sources, which already carry the TXVECTOR, the
+ * A-MPDU position and the signal and noise levels. The frames dropped come
+ * from PhyRxDrop, which carries none of them, so their hasPhyInfo is false.
+ * PhyRxDrop reports a whole PSDU: an A-MPDU, recognised by the signature of
+ * its first delimiter, is split into its subframes and one descriptor is
+ * published per MPDU, so drops are counted in the same unit as Tx and RxOk.
+ *
+ * The descriptor is only built when a trace sink is connected, and with
+ * DataOnly only data frames are published.
+ */
+class WifiFrameTracer : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * TracedCallback signature for frame descriptors.
+   * \param descriptor The description of the frame.
+   */
+  typedef void (* DescriptorTracedCallback)(const WifiFrameDescriptor &descriptor);
+
+  WifiFrameTracer ();
+  virtual ~WifiFrameTracer ();
+
+  /**
+   * Connect the trace sources of a PHY.
+   * \param phy The PHY to trace.
+   */
+  void Install (Ptr<WifiPhy> phy);
+
+private:
+  void MonitorSnifferTx (Ptr<const Packet> packet, uint16_t channelFreqMhz, WifiTxVector txVector, MpduInfo aMpdu);
+  void MonitorSnifferRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, WifiTxVector txVector,
+                         MpduInfo aMpdu, SignalNoiseDbm signalNoise);
+  void PhyRxDrop (Ptr<const Packet> packet, WifiPhyRxfailureReason reason);
+  /**
+   * Publish the descriptor of a dropped MPDU.
+   * \param packet The MPDU, or the A-MPDU subframe.
+   * \param mpduType The position of the MPDU in the A-MPDU.
+   * \param reason The reason of the drop.
+   */
+  void NotifyRxDrop (Ptr<const Packet> packet, MpduType mpduType, WifiPhyRxfailureReason reason);
+
+  /**
+   * Fill the MAC fields of a descriptor from the first bytes of a frame.
+   * \param packet The MPDU, or the A-MPDU subframe.
+   * \param subframe Whether the packet starts with an A-MPDU delimiter.
+   * \param descriptor The descriptor to fill.
+   * \return False if the frame is filtered out by DataOnly.
+   */
+  bool Parse (Ptr<const Packet> packet, bool subframe, WifiFrameDescriptor &descriptor) const;
+
+  bool m_dataOnly;                      //!< Publish data frames only.
+  TracedCallback<const WifiFrameDescriptor &> m_txTrace;        //!< Frame sent.
+  TracedCallback<const WifiFrameDescriptor &> m_rxOkTrace;      //!< Frame received.
+  TracedCallback<const WifiFrameDescriptor &> m_rxDropTrace;    //!< Frame dropped.
+
+};
+
+NS_OBJECT_ENSURE_REGISTERED (WifiFrameTracer);
+
+TypeId
+WifiFrameTracer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WifiFrameTracer")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<WifiFrameTracer> ()
+    .AddAttribute ("DataOnly", "Publish data frames only.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&WifiFrameTracer::m_dataOnly),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Tx", "An MPDU is sent by the PHY.",
+                     MakeTraceSourceAccessor (&WifiFrameTracer::m_txTrace),
+                     "ns3::WifiFrameTracer::DescriptorTracedCallback")
+    .AddTraceSource ("RxOk", "An MPDU is received successfully by the PHY.",
+                     MakeTraceSourceAccessor (&WifiFrameTracer::m_rxOkTrace),
+                     "ns3::WifiFrameTracer::DescriptorTracedCallback")
+    .AddTraceSource ("RxDrop", "An MPDU is dropped by the PHY.",
+                     MakeTraceSourceAccessor (&WifiFrameTracer::m_rxDropTrace),
+                     "ns3::WifiFrameTracer::DescriptorTracedCallback")
+  ;
+  return tid;
+}
+
+WifiFrameTracer::WifiFrameTracer ()
+{
+}
+
+WifiFrameTracer::~WifiFrameTracer ()
+{
+}
+
+void
+WifiFrameTracer::Install (Ptr<WifiPhy> phy)
+{
+  phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeCallback (&WifiFrameTracer::MonitorSnifferTx, this));
+  phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeCallback (&WifiFrameTracer::MonitorSnifferRx, this));
+  phy->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&WifiFrameTracer::PhyRxDrop, this));
+}
+
+bool
+WifiFrameTracer::Parse (Ptr<const Packet> packet, bool subframe, WifiFrameDescriptor &descriptor) const
+{
+  uint8_t buffer[WIFI_AMPDU_DELIMITER_SIZE + WIFI_FRAME_PEEK_SIZE];
+  uint32_t offset = (subframe ? WIFI_AMPDU_DELIMITER_SIZE : 0);
+  uint32_t size = packet->CopyData (buffer, offset + WIFI_FRAME_PEEK_SIZE);
+  NS_ABORT_MSG_IF (size < offset + 2, "The frame is too short to hold a Frame Control field");
+
+  /* Frame Control: Protocol Version (2 bits), Type (2 bits), Subtype (4 bits) */
+  descriptor.type = (buffer[offset] >> 2) & 0x3;
+  descriptor.subtype = (buffer[offset] >> 4) & 0xf;
+  descriptor.isData = (descriptor.type == WIFI_FRAME_TYPE_DATA);
+  if (m_dataOnly && !descriptor.isData)
+    {
+      return false;
+    }
+
+  if (subframe)
+    {
+      /* The delimiter holds the MPDU length in its 14 least significant bits */
+      descriptor.length = (buffer[0] | (buffer[1] << 8)) & 0x3fff;
+    }
+  else
+    {
+      descriptor.length = packet->GetSize ();
+    }
+
+  descriptor.receiver = Mac48Address ();
+  descriptor.transmitter = Mac48Address ();
+  if (size >= offset + 10)
+    {
+      descriptor.receiver.CopyFrom (buffer + offset + 4);
+    }
+  bool hasTransmitter = !((descriptor.type == WIFI_FRAME_TYPE_CONTROL)
+                          && ((descriptor.subtype == WIFI_FRAME_SUBTYPE_CTS)
+                              || (descriptor.subtype == WIFI_FRAME_SUBTYPE_ACK)))
+                        && (descriptor.type != WIFI_FRAME_TYPE_EXTENSION);
+  if (hasTransmitter && (size >= offset + WIFI_FRAME_PEEK_SIZE))
+    {
+      descriptor.transmitter.CopyFrom (buffer + offset + 10);
+    }
+  return true;
+}
+
+void
+WifiFrameTracer::MonitorSnifferTx (Ptr<const Packet> packet, uint16_t, WifiTxVector txVector, MpduInfo aMpdu)
+{
+  if (m_txTrace.IsEmpty ())
+    {
+      return;
+    }
+  WifiFrameDescriptor descriptor;
+  if (!Parse (packet, aMpdu.type != NORMAL_MPDU, descriptor))
+    {
+      return;
+    }
+  descriptor.hasPhyInfo = true;
+  descriptor.mode = txVector.GetMode ();
+  descriptor.snr = std::numeric_limits<double>::quiet_NaN ();
+  descriptor.mpduType = aMpdu.type;
+  descriptor.mpduRefNumber = aMpdu.mpduRefNumber;
+  descriptor.reason = UNKNOWN;
+  m_txTrace (descriptor);
+}
+
+void
+WifiFrameTracer::MonitorSnifferRx (Ptr<const Packet> packet, uint16_t, WifiTxVector txVector,
+                                   MpduInfo aMpdu, SignalNoiseDbm signalNoise)
+{
+  if (m_rxOkTrace.IsEmpty ())
+    {
+      return;
+    }
+  WifiFrameDescriptor descriptor;
+  if (!Parse (packet, aMpdu.type != NORMAL_MPDU, descriptor))
+    {
+      return;
+    }
+  descriptor.hasPhyInfo = true;
+  descriptor.mode = txVector.GetMode ();
+  descriptor.snr = signalNoise.signal - signalNoise.noise;
+  descriptor.mpduType = aMpdu.type;
+  descriptor.mpduRefNumber = aMpdu.mpduRefNumber;
+  descriptor.reason = UNKNOWN;
+  m_rxOkTrace (descriptor);
+}
+
+void
+WifiFrameTracer::PhyRxDrop (Ptr<const Packet> packet, WifiPhyRxfailureReason reason)
+{
+  if (m_rxDropTrace.IsEmpty ())
+    {
+      return;
+    }
+  uint8_t delimiter[WIFI_AMPDU_DELIMITER_SIZE];
+  uint32_t size = packet->GetSize ();
+  if ((packet->CopyData (delimiter, WIFI_AMPDU_DELIMITER_SIZE) < WIFI_AMPDU_DELIMITER_SIZE)
+      || (delimiter[3] != WIFI_AMPDU_SIGNATURE)
+      || ((delimiter[0] | (delimiter[1] << 8)) & 0x3fff) + WIFI_AMPDU_DELIMITER_SIZE > size)
+    {
+      NotifyRxDrop (packet, NORMAL_MPDU, reason);
+      return;
+    }
+
+  /* Walk the A-MPDU subframes: delimiter, MPDU and padding to a multiple of 4 bytes */
+  uint32_t offset = 0;
+  bool first = true;
+  while (offset + WIFI_AMPDU_DELIMITER_SIZE <= size)
+    {
+      Ptr<Packet> subframe = packet->CreateFragment (offset, size - offset);
+      subframe->CopyData (delimiter, WIFI_AMPDU_DELIMITER_SIZE);
+      if (delimiter[3] != WIFI_AMPDU_SIGNATURE)
+        {
+          break;
+        }
+      uint32_t length = (delimiter[0] | (delimiter[1] << 8)) & 0x3fff;
+      uint32_t next = offset + WIFI_AMPDU_DELIMITER_SIZE + length;
+      next += (WIFI_AMPDU_DELIMITER_SIZE - next % WIFI_AMPDU_DELIMITER_SIZE) % WIFI_AMPDU_DELIMITER_SIZE;
+      if (length > 0)
+        {
+          /* Zero-length delimiters only pad the A-MPDU */
+          bool last = (next + WIFI_AMPDU_DELIMITER_SIZE > size);
+          MpduType mpduType = first ? (last ? SINGLE_MPDU : FIRST_MPDU_IN_AGGREGATE)
+                                    : (last ? LAST_MPDU_IN_AGGREGATE : MIDDLE_MPDU_IN_AGGREGATE);
+          NotifyRxDrop (subframe, mpduType, reason);
+          first = false;
+        }
+      offset = next;
+    }
+}
+
+void
+WifiFrameTracer::NotifyRxDrop (Ptr<const Packet> packet, MpduType mpduType, WifiPhyRxfailureReason reason)
+{
+  WifiFrameDescriptor descriptor;
+  if (!Parse (packet, mpduType != NORMAL_MPDU, descriptor))
+    {
+      return;
+    }
+  descriptor.hasPhyInfo = false;
+  descriptor.snr = std::numeric_limits<double>::quiet_NaN ();
+  descriptor.mpduType = mpduType;
+  descriptor.mpduRefNumber = 0;
+  descriptor.reason = reason;
+  m_rxDropTrace (descriptor);
+}
+
+} // namespace ns3
+
+#endif // WIFI_FRAME_DESCRIPTOR_H